@@ -133,6 +133,7 @@ list (APPEND PUBLIC_HEADER_FILES
              opm/models/discretization/common/fvbaselinearizer.hh
              opm/models/discretization/common/tpfalinearizer.hh
              opm/models/discretization/common/restrictprolong.hh
+             opm/models/discretization/common/reorderingelementmapper.hh
              opm/models/discretization/common/fvbasediscretization.hh
              opm/models/discretization/common/fvbasediscretizationfemadapt.hh
              opm/models/discretization/common/fvbasegradientcalculator.hh
@@ -202,9 +203,13 @@ list (APPEND PUBLIC_HEADER_FILES
              opm/models/nonlinear/nullconvergencewriter.hh
              opm/models/nonlinear/newtonmethod.hh
              opm/models/nonlinear/newtonmethodproperties.hh
+             opm/models/nonlinear/nlddnewtonmethod.hh
+             opm/models/nonlinear/sequentialimplicitnewtonmethod.hh
+             opm/models/nonlinear/reorderingtransportsolver.hh
              opm/models/parallel/mpiutil.hh
              opm/models/parallel/tasklets.hh
              opm/models/parallel/threadmanager.hh
+             opm/models/parallel/cputopology.hh
              opm/models/parallel/gridcommhandles.hh
              opm/models/parallel/mpibuffer.hh
              opm/models/parallel/threadedentityiterator.hh
@@ -237,10 +242,16 @@ list (APPEND PUBLIC_HEADER_FILES
              opm/models/utils/simulator.hh
              opm/models/utils/quadraturegeometries.hh
              opm/models/utils/alignedallocator.hh
+             opm/models/utils/firsttouchallocator.hh
+             opm/models/utils/stronglyconnectedcomponents.hh
              opm/models/utils/timer.hh
              opm/models/utils/signum.hh
              opm/models/utils/genericguard.hh
              opm/models/utils/basicproperties.hh
+             opm/simulators/linalg/blockilu0.hh
+             opm/simulators/linalg/cprpreconditioner.hh
+             opm/simulators/linalg/cprpressurevaridx.hh
+             opm/simulators/linalg/explicitcellcondenser.hh
              opm/simulators/linalg/ilufirstelement.hh
              opm/simulators/linalg/parallelistlbackend.hh
              opm/simulators/linalg/weightedresidreductioncriterion.hh
@@ -248,12 +259,15 @@ list (APPEND PUBLIC_HEADER_FILES
              opm/simulators/linalg/linalgproperties.hh
              opm/simulators/linalg/linearsolverreport.hh
              opm/simulators/linalg/istlsparsematrixadapter.hh
+             opm/simulators/linalg/matrixfreetpfaoperator.hh
+             opm/simulators/linalg/sparsitypattern.hh
              opm/simulators/linalg/istlpreconditionerwrappers.hh
              opm/simulators/linalg/residreductioncriterion.hh
              opm/simulators/linalg/overlappingbcrsmatrix.hh
              opm/simulators/linalg/blacklist.hh
              opm/simulators/linalg/parallelbasebackend.hh
              opm/simulators/linalg/overlappingblockvector.hh
+             opm/simulators/linalg/sharedmemoryexchange.hh
              opm/simulators/linalg/parallelbicgstabbackend.hh
              opm/simulators/linalg/nullborderlistmanager.hh
              opm/simulators/linalg/overlappingoperator.hh
@@ -261,6 +275,7 @@ list (APPEND PUBLIC_HEADER_FILES
              opm/simulators/linalg/combinedcriterion.hh
              opm/simulators/linalg/bicgstabsolver.hh
              opm/simulators/linalg/globalindices.hh
+             opm/simulators/linalg/neighborexchange.hh
              opm/simulators/linalg/superlubackend.hh
              opm/simulators/linalg/matrixblock.hh
              opm/simulators/linalg/istlsolverwrappers.hh
@@ -22,16 +22,28 @@
 */
 
 #include <dune/common/version.hh>
-#include <dune/common/fvector.hh>
-#include <dune/common/fmatrix.hh>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include <algorithm>
+#include <cassert>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <fstream>
-#include <iomanip>
-#include <memory>
+#include <iostream>
 #include <stdexcept>
-#include <sstream>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace Ewoms {
@@ -39,8 +51,14 @@ namespace Ewoms {
  * \brief Reads in mesh files in the ART format.
  *
  * This file format is used to specify grids with fractures.
+ *
+ * The input file is mapped into memory and each of its sections is split into
+ * chunks of lines which are parsed by the OpenMP threads in parallel. Only the
+ * vertex coordinates and the edges are kept in memory, since the vertex
+ * section of the DGF file requires to know all fracture edges and the elements
+ * are specified in terms of edges. The elements are converted and written
+ * block by block.
  */
-
  struct Art2DGF
  {
     /*!
@@ -50,168 +68,79 @@ namespace Ewoms {
                          std::ostream& dgfFile,
                          const unsigned precision = 16 )
     {
-        using Scalar = double;
-        using GlobalPosition = Dune::FieldVector< Scalar, 2 >;
-        enum ParseMode { Vertex, Edge, Element, Finished };
-        std::vector< std::pair<GlobalPosition, unsigned> > vertexPos;
-        std::vector<std::pair<unsigned, unsigned> > edges;
-        std::vector<std::pair<unsigned, unsigned> > fractureEdges;
-        std::vector<std::vector<unsigned> > elements;
-        std::ifstream inStream(artFileName);
-        if (!inStream.is_open()) {
-            throw std::runtime_error("File '"+artFileName
-                                     +"' does not exist or is not readable");
-        }
-        std::string curLine;
-        ParseMode curParseMode = Vertex;
-        while (inStream) {
-            std::getline(inStream, curLine);
-
-            // remove comments
-            auto commentPos = curLine.find("%");
-            if (commentPos != curLine.npos) {
-                curLine = curLine.substr(0, commentPos);
-            }
-
-            // remove leading whitespace
-            unsigned numLeadingSpaces = 0;
-            while (curLine.size() > numLeadingSpaces
-                   && std::isspace(curLine[numLeadingSpaces]))
-                ++numLeadingSpaces;
-            curLine = curLine.substr(numLeadingSpaces,
-                                     curLine.size() - numLeadingSpaces);
-
-            // remove trailing whitespace
-            unsigned numTrailingSpaces = 0;
-            while (curLine.size() > numTrailingSpaces
-                   && std::isspace(curLine[curLine.size() - numTrailingSpaces]))
-                ++numTrailingSpaces;
-            curLine = curLine.substr(0, curLine.size() - numTrailingSpaces);
-
-            // a section of the file is finished, go to the next one
-            if (curLine == "$") {
-                if (curParseMode == Vertex)
-                    curParseMode = Edge;
-                else if (curParseMode == Edge)
-                    curParseMode = Element;
-                else if (curParseMode == Element)
-                    curParseMode = Finished;
-                continue;
-            }
-
-            // skip empty lines
-            if (curLine.empty())
-                continue;
-
-            if (curParseMode == Vertex) {
-                GlobalPosition coord;
-                std::istringstream iss(curLine);
-                // parse only the first two numbers as the vertex
-                // coordinate. the last number is the Z coordinate
-                // which we ignore (so far)
-                iss >> coord[0] >> coord[1];
-                vertexPos.push_back( std::make_pair( coord, 0 ) );
-            }
-            else if (curParseMode == Edge) {
-                // read an edge and update the fracture mapper
-
-                // read the data attached to the edge
-                std::istringstream iss(curLine);
-                int dataVal;
-                std::string tmp;
-                iss >> dataVal;
-                iss >> tmp;
-                assert(tmp == ":");
-
-                // read the vertex indices of an edge
-                std::vector<unsigned int> vertIndices;
-                while (iss) {
-                    unsigned int tmp2;
-                    iss >> tmp2;
-                    if (!iss)
-                        break;
-                    vertIndices.push_back(tmp2);
-                    assert(tmp2 < vertexPos.size());
-                }
-
-                // an edge always has two indices!
-                assert(vertIndices.size() == 2);
+        MappedFile artFile(artFileName);
+        const char* fileBegin = artFile.data();
+        const char* fileEnd = fileBegin + artFile.size();
 
-                std::pair<unsigned, unsigned> edge(vertIndices[0], vertIndices[1]);
-                edges.push_back(edge);
-
-                // add the edge to the fracture mapper if it is a fracture
-                if (dataVal < 0) {
-                    fractureEdges.push_back(edge);
-                    vertexPos[ edge.first  ].second = 1;
-                    vertexPos[ edge.second ].second = 1;
+        // find the sections of the file, they are separated by lines which
+        // only contain a '$'
+        enum ParseMode { Vertex, Edge, Element, Finished };
+        std::pair<const char*, const char*> sections[Finished + 1];
+        {
+            unsigned sectionIdx = 0;
+            const char* sectionBegin = fileBegin;
+            const char* pos = fileBegin;
+            while (sectionIdx < Finished) {
+                pos = static_cast<const char*>(std::memchr(pos, '$', static_cast<std::size_t>(fileEnd - pos)));
+                if (!pos)
+                    break;
+
+                const char* lineBegin = lineBegin_(fileBegin, pos);
+                const char* lineEnd = lineEnd_(pos, fileEnd);
+                const auto [contentBegin, contentEnd] = stripLine_(lineBegin, lineEnd);
+                if (contentEnd - contentBegin == 1 && *contentBegin == '$') {
+                    sections[sectionIdx++] = {sectionBegin, lineBegin};
+                    sectionBegin = lineEnd;
                 }
+                pos = lineEnd;
             }
-            else if (curParseMode == Element) {
-                // skip the data attached to an element
-                std::istringstream iss(curLine);
-                int dataVal;
-                std::string tmp;
-                iss >> dataVal;
-                iss >> tmp;
-                assert(tmp == ":");
-
-                // read the edge indices of an element
-                std::vector<unsigned> edgeIndices;
-                while (iss) {
-                    unsigned tmp2;
-                    iss >> tmp2;
-                    if (!iss)
-                        break;
-                    edgeIndices.push_back(tmp2);
-                    assert(tmp2 < edges.size());
-                }
-
-                // so far, we only support triangles
-                assert(edgeIndices.size() == 3);
-
-                // extract the vertex indices of the element
-                std::vector<unsigned> vertIndices;
-                for (unsigned i = 0; i < 3; ++i) {
-                    bool haveFirstVertex = false;
-                    for (unsigned j = 0; j < vertIndices.size(); ++j) {
-                        assert(edgeIndices[i] < edges.size());
-                        if (vertIndices[j] == edges[edgeIndices[i]].first) {
-                            haveFirstVertex = true;
-                            break;
-                        }
-                    }
-                    if (!haveFirstVertex)
-                        vertIndices.push_back(edges[edgeIndices[i]].first);
-
-                    bool haveSecondVertex = false;
-                    for (unsigned j = 0; j < vertIndices.size(); ++j) {
-                        assert(edgeIndices[i] < edges.size());
-                        if (vertIndices[j] == edges[edgeIndices[i]].second) {
-                            haveSecondVertex = true;
-                            break;
-                        }
-                    }
-                    if (!haveSecondVertex)
-                        vertIndices.push_back(edges[edgeIndices[i]].second);
-                }
-
-                // check whether the element's vertices are given in
-                // mathematically positive direction. if not, swap the
-                // first two.
-                Dune::FieldMatrix<Scalar, 2, 2> mat;
-                mat[0] = vertexPos[vertIndices[1]].first;
-                mat[0] -= vertexPos[vertIndices[0]].first;
-                mat[1] = vertexPos[vertIndices[2]].first;
-                mat[1] -= vertexPos[vertIndices[0]].first;
-                assert(std::abs(mat.determinant()) > 1e-50);
-                if (mat.determinant() < 0)
-                    std::swap(vertIndices[2], vertIndices[1]);
-
-                elements.push_back( vertIndices );
+            for (; sectionIdx <= Finished; ++sectionIdx) {
+                sections[sectionIdx] = {sectionBegin, fileEnd};
+                sectionBegin = fileEnd;
             }
-            else if (curParseMode == Finished) {
-                assert(curLine.size() == 0);
+        }
+
+        // parse the vertex coordinates. only the first two numbers are used, the
+        // last number is the Z coordinate which we ignore (so far)
+        std::vector<double> vertexPos;
+        parseSection_(sections[Vertex], /*numValues=*/2, vertexPos,
+                      [](const char* lineBegin, const char* lineEnd, double* values)
+                      {
+                          LineBuffer buf(lineBegin, lineEnd);
+                          char* pos = buf.str();
+                          values[0] = std::strtod(pos, &pos);
+                          values[1] = std::strtod(pos, &pos);
+                      });
+        const std::size_t numVertices = vertexPos.size()/2;
+
+        // parse the edges. the data attached to the edge is negative for
+        // fractures, so it is stored alongside the vertex indices
+        std::vector<long> edges;
+        parseSection_(sections[Edge], /*numValues=*/3, edges,
+                      [numVertices](const char* lineBegin, const char* lineEnd, long* values)
+                      {
+                          const char* pos = lineBegin;
+                          values[2] = parseInt_(pos, lineEnd);
+                          skipColon_(pos, lineEnd);
+                          values[0] = parseInt_(pos, lineEnd);
+                          values[1] = parseInt_(pos, lineEnd);
+
+                          // an edge always has two indices!
+                          assert(!hasMoreNumbers_(pos, lineEnd));
+                          assert(static_cast<std::size_t>(values[0]) < numVertices);
+                          assert(static_cast<std::size_t>(values[1]) < numVertices);
+                          (void) numVertices;
+                      });
+        const std::size_t numEdges = edges.size()/3;
+
+        // mark the fracture vertices
+        std::vector<char> isFractureVertex(numVertices, 0);
+        bool hasFractures = false;
+        for (std::size_t edgeIdx = 0; edgeIdx < numEdges; ++edgeIdx) {
+            if (edges[3*edgeIdx + 2] < 0) {
+                hasFractures = true;
+                isFractureVertex[static_cast<std::size_t>(edges[3*edgeIdx + 0])] = 1;
+                isFractureVertex[static_cast<std::size_t>(edges[3*edgeIdx + 1])] = 1;
             }
         }
 
@@ -223,35 +152,33 @@ namespace Ewoms {
                 << "#" << std::endl << std::endl;
 
         dgfFile << "Vertex" << std::endl;
-        const bool hasFractures = fractureEdges.size() > 0;
         if( hasFractures )
         {
             dgfFile << "parameters 1" << std::endl;
         }
-        dgfFile << std::scientific;
-        dgfFile.precision( precision );
-        const size_t vxSize = vertexPos.size();
-        for( size_t i=0; i<vxSize; ++i)
-        {
-            dgfFile << vertexPos[ i ].first;
-            if( hasFractures )
-            {
-                dgfFile << " " << vertexPos[ i ].second;
-            }
-            dgfFile << std::endl;
-        }
+        writeParallel_(dgfFile, numVertices,
+                       [&](std::size_t vertexIdx, std::string& out)
+                       {
+                           char buf[128];
+                           int n = std::snprintf(buf, sizeof(buf), "%.*e %.*e",
+                                                 static_cast<int>(precision), vertexPos[2*vertexIdx + 0],
+                                                 static_cast<int>(precision), vertexPos[2*vertexIdx + 1]);
+                           out.append(buf, static_cast<std::size_t>(n));
+                           if (hasFractures) {
+                               out += ' ';
+                               out += isFractureVertex[vertexIdx] ? '1' : '0';
+                           }
+                           out += '\n';
+                       });
 
         dgfFile << "#" << std::endl << std::endl;
 
         dgfFile << "Simplex" << std::endl;
-        const size_t elSize = elements.size();
-        for( size_t i=0; i<elSize; ++i )
-        {
-            const size_t elVx = elements[ i ].size();
-            for( size_t j=0; j<elVx; ++j )
-                dgfFile << elements[ i ][ j ] << " ";
-            dgfFile << std::endl;
-        }
+        writeLinesParallel_(dgfFile, sections[Element],
+                            [&](const char* lineBegin, const char* lineEnd, std::string& out)
+                            {
+                                appendElement_(out, lineBegin, lineEnd, vertexPos, edges);
+                            });
 
         dgfFile << "#" << std::endl << std::endl;
         dgfFile << "BoundaryDomain" << std::endl;
@@ -259,6 +186,325 @@ namespace Ewoms {
         dgfFile << "#" << std::endl << std::endl;
         dgfFile << "#" << std::endl;
     }
+
+private:
+    // a read-only memory mapping of a file
+    class MappedFile
+    {
+    public:
+        explicit MappedFile(const std::string& fileName)
+        {
+            int fd = ::open(fileName.c_str(), O_RDONLY);
+            struct stat st;
+            if (fd < 0 || ::fstat(fd, &st) != 0) {
+                if (fd >= 0)
+                    ::close(fd);
+                throw std::runtime_error("File '"+fileName
+                                         +"' does not exist or is not readable");
+            }
+
+            size_ = static_cast<std::size_t>(st.st_size);
+            if (size_ > 0) {
+                void* p = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, /*offset=*/0);
+                if (p == MAP_FAILED) {
+                    ::close(fd);
+                    throw std::runtime_error("Could not map file '"+fileName+"' into memory");
+                }
+                ::madvise(p, size_, MADV_SEQUENTIAL);
+                data_ = static_cast<const char*>(p);
+            }
+            ::close(fd);
+        }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        ~MappedFile()
+        {
+            if (data_)
+                ::munmap(const_cast<char*>(data_), size_);
+        }
+
+        const char* data() const
+        { return data_ ? data_ : ""; }
+
+        std::size_t size() const
+        { return size_; }
+
+    private:
+        const char* data_ = nullptr;
+        std::size_t size_ = 0;
+    };
+
+    // a null terminated copy of a line, required by strtod()
+    class LineBuffer
+    {
+    public:
+        LineBuffer(const char* begin, const char* end)
+        {
+            const std::size_t n = static_cast<std::size_t>(end - begin);
+            if (n < sizeof(fixed_)) {
+                std::memcpy(fixed_, begin, n);
+                fixed_[n] = '\0';
+                str_ = fixed_;
+            }
+            else {
+                dynamic_.assign(begin, end);
+                str_ = &dynamic_[0];
+            }
+        }
+
+        char* str()
+        { return str_; }
+
+    private:
+        char fixed_[256];
+        std::string dynamic_;
+        char* str_;
+    };
+
+    static const char* lineBegin_(const char* fileBegin, const char* pos)
+    {
+        while (pos > fileBegin && pos[-1] != '\n')
+            --pos;
+        return pos;
+    }
+
+    static const char* lineEnd_(const char* pos, const char* fileEnd)
+    {
+        const char* nl = static_cast<const char*>(std::memchr(pos, '\n', static_cast<std::size_t>(fileEnd - pos)));
+        return nl ? nl + 1 : fileEnd;
+    }
+
+    // remove comments as well as leading and trailing whitespace
+    static std::pair<const char*, const char*> stripLine_(const char* begin, const char* end)
+    {
+        const char* commentPos = static_cast<const char*>(std::memchr(begin, '%', static_cast<std::size_t>(end - begin)));
+        if (commentPos)
+            end = commentPos;
+        while (begin < end && std::isspace(static_cast<unsigned char>(*begin)))
+            ++begin;
+        while (end > begin && std::isspace(static_cast<unsigned char>(end[-1])))
+            --end;
+        return {begin, end};
+    }
+
+    // split a range of lines into chunks which start at the beginning of a line
+    static std::vector<const char*> splitChunks_(const char* begin, const char* end, std::size_t numChunks)
+    {
+        std::vector<const char*> bounds{begin};
+        const std::size_t size = static_cast<std::size_t>(end - begin);
+        for (std::size_t i = 1; i < numChunks; ++i) {
+            const char* pos = begin + size*i/numChunks;
+            pos = std::max(pos, bounds.back());
+            bounds.push_back(pos > begin ? lineEnd_(pos - 1, end) : begin);
+        }
+        bounds.push_back(end);
+        return bounds;
+    }
+
+    static std::size_t numThreads_()
+    {
+#ifdef _OPENMP
+        return static_cast<std::size_t>(omp_get_max_threads());
+#else
+        return 1;
+#endif
+    }
+
+    // call a functor for each non-empty line of a range
+    template <class Fn>
+    static void forEachLine_(const char* begin, const char* end, Fn fn)
+    {
+        while (begin < end) {
+            const char* next = lineEnd_(begin, end);
+            const auto [contentBegin, contentEnd] = stripLine_(begin, next);
+            if (contentBegin != contentEnd)
+                fn(contentBegin, contentEnd);
+            begin = next;
+        }
+    }
+
+    // parse a section which has a fixed number of values per line into a flat
+    // array. the lines are first counted to determine where each chunk
+    // stores its values.
+    template <class T, class ParseLine>
+    static void parseSection_(const std::pair<const char*, const char*>& section,
+                              std::size_t numValues,
+                              std::vector<T>& values,
+                              ParseLine parseLine)
+    {
+        const auto bounds = splitChunks_(section.first, section.second, 4*numThreads_());
+        const long numChunks = static_cast<long>(bounds.size()) - 1;
+
+        std::vector<std::size_t> chunkOffset(bounds.size(), 0);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+        for (long chunkIdx = 0; chunkIdx < numChunks; ++chunkIdx) {
+            std::size_t n = 0;
+            forEachLine_(bounds[chunkIdx], bounds[chunkIdx + 1],
+                         [&n](const char*, const char*) { ++n; });
+            chunkOffset[chunkIdx + 1] = n;
+        }
+        for (long chunkIdx = 0; chunkIdx < numChunks; ++chunkIdx)
+            chunkOffset[chunkIdx + 1] += chunkOffset[chunkIdx];
+
+        values.resize(chunkOffset.back()*numValues);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+        for (long chunkIdx = 0; chunkIdx < numChunks; ++chunkIdx) {
+            T* dest = values.data() + chunkOffset[chunkIdx]*numValues;
+            forEachLine_(bounds[chunkIdx], bounds[chunkIdx + 1],
+                         [&dest, numValues, &parseLine](const char* lineBegin, const char* lineEnd)
+                         {
+                             parseLine(lineBegin, lineEnd, dest);
+                             dest += numValues;
+                         });
+        }
+    }
+
+    // format n entries in parallel and write them in blocks, so that only one
+    // block of the output needs to be kept in memory at a time
+    template <class Format>
+    static void writeParallel_(std::ostream& os, std::size_t n, Format format)
+    {
+        const std::size_t numChunks = 4*numThreads_();
+        const std::size_t blockSize = 1 << 20;
+        std::vector<std::string> out(numChunks);
+        for (std::size_t blockBegin = 0; blockBegin < n; blockBegin += blockSize) {
+            const std::size_t blockEnd = std::min(n, blockBegin + blockSize);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static, 1)
+#endif
+            for (long chunkIdx = 0; chunkIdx < static_cast<long>(numChunks); ++chunkIdx) {
+                const std::size_t m = blockEnd - blockBegin;
+                const std::size_t b = blockBegin + m*static_cast<std::size_t>(chunkIdx)/numChunks;
+                const std::size_t e = blockBegin + m*static_cast<std::size_t>(chunkIdx + 1)/numChunks;
+                out[chunkIdx].clear();
+                for (std::size_t i = b; i < e; ++i)
+                    format(i, out[chunkIdx]);
+            }
+            for (const auto& s : out)
+                os.write(s.data(), static_cast<std::streamsize>(s.size()));
+        }
+    }
+
+    // convert the lines of a section in parallel and write them in blocks
+    template <class Format>
+    static void writeLinesParallel_(std::ostream& os,
+                                    const std::pair<const char*, const char*>& section,
+                                    Format format)
+    {
+        const std::size_t blockSize = 64 << 20;
+        const std::size_t numChunks = 4*numThreads_();
+        std::vector<std::string> out(numChunks);
+        const char* blockBegin = section.first;
+        while (blockBegin < section.second) {
+            const char* blockEnd = section.second;
+            if (static_cast<std::size_t>(blockEnd - blockBegin) > blockSize)
+                blockEnd = lineEnd_(blockBegin + blockSize, section.second);
+
+            const auto bounds = splitChunks_(blockBegin, blockEnd, numChunks);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+            for (long chunkIdx = 0; chunkIdx < static_cast<long>(numChunks); ++chunkIdx) {
+                out[chunkIdx].clear();
+                forEachLine_(bounds[chunkIdx], bounds[chunkIdx + 1],
+                             [&out, chunkIdx, &format](const char* lineBegin, const char* lineEnd)
+                             { format(lineBegin, lineEnd, out[chunkIdx]); });
+            }
+            for (const auto& s : out)
+                os.write(s.data(), static_cast<std::streamsize>(s.size()));
+
+            blockBegin = blockEnd;
+        }
+    }
+
+    static long parseInt_(const char*& pos, const char* end)
+    {
+        while (pos < end && std::isspace(static_cast<unsigned char>(*pos)))
+            ++pos;
+        bool negative = false;
+        if (pos < end && (*pos == '-' || *pos == '+')) {
+            negative = *pos == '-';
+            ++pos;
+        }
+        long value = 0;
+        while (pos < end && *pos >= '0' && *pos <= '9')
+            value = 10*value + (*pos++ - '0');
+        return negative ? -value : value;
+    }
+
+    static void skipColon_(const char*& pos, const char* end)
+    {
+        while (pos < end && std::isspace(static_cast<unsigned char>(*pos)))
+            ++pos;
+        assert(pos < end && *pos == ':');
+        ++pos;
+    }
+
+    static bool hasMoreNumbers_(const char* pos, const char* end)
+    {
+        while (pos < end && std::isspace(static_cast<unsigned char>(*pos)))
+            ++pos;
+        return pos < end;
+    }
+
+    // convert an element given by its edges to a DGF simplex given by its
+    // vertices
+    static void appendElement_(std::string& out,
+                               const char* lineBegin,
+                               const char* lineEnd,
+                               const std::vector<double>& vertexPos,
+                               const std::vector<long>& edges)
+    {
+        // skip the data attached to an element
+        const char* pos = lineBegin;
+        parseInt_(pos, lineEnd);
+        skipColon_(pos, lineEnd);
+
+        // read the edge indices of an element. so far, we only support triangles
+        long edgeIndices[3];
+        for (unsigned i = 0; i < 3; ++i) {
+            edgeIndices[i] = parseInt_(pos, lineEnd);
+            assert(static_cast<std::size_t>(edgeIndices[i]) < edges.size()/3);
+        }
+        assert(!hasMoreNumbers_(pos, lineEnd));
+
+        // extract the vertex indices of the element
+        long vertIndices[3];
+        unsigned numVertices = 0;
+        for (unsigned i = 0; i < 3; ++i) {
+            for (unsigned k = 0; k < 2; ++k) {
+                const long vertexIdx = edges[3*static_cast<std::size_t>(edgeIndices[i]) + k];
+                if (std::find(vertIndices, vertIndices + numVertices, vertexIdx) == vertIndices + numVertices) {
+                    assert(numVertices < 3);
+                    vertIndices[numVertices++] = vertexIdx;
+                }
+            }
+        }
+        assert(numVertices == 3);
+
+        // check whether the element's vertices are given in
+        // mathematically positive direction. if not, swap the
+        // first two.
+        const double* x0 = &vertexPos[2*static_cast<std::size_t>(vertIndices[0])];
+        const double* x1 = &vertexPos[2*static_cast<std::size_t>(vertIndices[1])];
+        const double* x2 = &vertexPos[2*static_cast<std::size_t>(vertIndices[2])];
+        const double det =
+            (x1[0] - x0[0])*(x2[1] - x0[1]) - (x1[1] - x0[1])*(x2[0] - x0[0]);
+        assert(std::abs(det) > 1e-50);
+        if (det < 0)
+            std::swap(vertIndices[2], vertIndices[1]);
+
+        char buf[96];
+        const int n = std::snprintf(buf, sizeof(buf), "%ld %ld %ld \n",
+                                    vertIndices[0], vertIndices[1], vertIndices[2]);
+        out.append(buf, static_cast<std::size_t>(n));
+    }
  };
 
 } // namespace Ewoms
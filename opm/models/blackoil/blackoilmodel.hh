@@ -58,8 +58,15 @@
 
 #include <opm/material/fluidsystems/BlackOilFluidSystem.hpp>
 
+#include <opm/models/utils/timer.hh>
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
 #include <sstream>
 #include <string>
+#include <tuple>
+#include <vector>
 
 namespace Opm {
 template <class TypeTag>
@@ -288,6 +295,9 @@ private:
     using Simulator = GetPropType<TypeTag, Properties::Simulator>;
     using Discretization = GetPropType<TypeTag, Properties::Discretization>;
     using ElementContext = GetPropType<TypeTag, Properties::ElementContext>;
+    using GridView = GetPropType<TypeTag, Properties::GridView>;
+    using Element = typename GridView::template Codim<0>::Entity;
+    using ElementSeed = typename Element::EntitySeed;
 
     enum { numPhases = getPropValue<TypeTag, Properties::NumPhases>() };
     enum { numComponents = FluidSystem::numComponents };
@@ -577,6 +587,83 @@ public:
         this->solution(/*timeIdx=*/1) = this->solution(/*timeIdx=*/0);
     }
 
+    using ParentType::invalidateAndUpdateIntensiveQuantities;
+
+    /*!
+     * \brief Recompute the intensive quantities of all degrees of freedom and store
+     *        them in the cache.
+     *
+     * For cell-centered discretizations, the cells are visited sorted by their PVT
+     * and saturation function regions, i.e., consecutive updates interpolate in the
+     * same tables. Within a region, the cells are visited in the order of their
+     * indices and the threads process batches of cells of the same region.
+     *
+     * \param timeIdx The index used by the time discretization.
+     */
+    void invalidateAndUpdateIntensiveQuantities(unsigned timeIdx) const
+    {
+        intensiveQuantitiesTimer_.start();
+
+        if (regionOrderSequenceNumber_ != this->simulator_.vanguard().gridSequenceNumber())
+            createRegionOrder_();
+
+        if (regionOrderSeeds_.empty()) {
+            // not a cell-centered discretization
+            ParentType::invalidateAndUpdateIntensiveQuantities(timeIdx);
+            numIntensiveQuantityUpdates_ += this->numGridDof();
+        }
+        else {
+            this->invalidateIntensiveQuantitiesCache(timeIdx);
+            updateIntensiveQuantitiesInRegionOrder_(timeIdx);
+        }
+
+        intensiveQuantitiesTimer_.stop();
+    }
+
+    /*!
+     * \brief Compute the intensive quantities of the degrees of freedom for which the
+     *        cache does not contain up-to-date ones.
+     *
+     * Like invalidateAndUpdateIntensiveQuantities(), this visits the cells sorted by
+     * their regions, but cells which exhibit valid cache entries are skipped.
+     *
+     * \param timeIdx The index used by the time discretization.
+     * \return The number of degrees of freedom whose intensive quantities were updated
+     */
+    std::size_t updateInvalidIntensiveQuantities(unsigned timeIdx) const
+    {
+        intensiveQuantitiesTimer_.start();
+
+        if (regionOrderSequenceNumber_ != this->simulator_.vanguard().gridSequenceNumber())
+            createRegionOrder_();
+
+        std::size_t numUpdates;
+        if (regionOrderSeeds_.empty()) {
+            // not a cell-centered discretization
+            numUpdates = ParentType::updateInvalidIntensiveQuantities(timeIdx);
+            numIntensiveQuantityUpdates_ += numUpdates;
+        }
+        else
+            numUpdates = updateIntensiveQuantitiesInRegionOrder_(timeIdx);
+
+        intensiveQuantitiesTimer_.stop();
+        return numUpdates;
+    }
+
+    /*!
+     * \brief Returns the timer which measures the time spent in
+     *        invalidateAndUpdateIntensiveQuantities() and updateInvalidIntensiveQuantities().
+     */
+    const Timer& intensiveQuantitiesTimer() const
+    { return intensiveQuantitiesTimer_; }
+
+    /*!
+     * \brief Returns the number of intensive quantities which have been computed by
+     *        invalidateAndUpdateIntensiveQuantities() and updateInvalidIntensiveQuantities().
+     */
+    std::size_t numIntensiveQuantityUpdates() const
+    { return numIntensiveQuantityUpdates_; }
+
 /*
     // hack: this interferes with the static polymorphism trick
 protected:
@@ -609,6 +696,107 @@ protected:
     }
 
 private:
+    // update the cache entries of the cells which are not valid in the region order
+    // and return the number of updated cells
+    std::size_t updateIntensiveQuantitiesInRegionOrder_(unsigned timeIdx) const
+    {
+        const auto& grid = this->gridView().grid();
+        const long numBatches = static_cast<long>(regionBatchStart_.size()) - 1;
+        std::size_t numUpdates = 0;
+        std::exception_ptr exceptionPtr = nullptr;
+#ifdef _OPENMP
+#pragma omp parallel reduction(+:numUpdates)
+#endif
+        {
+            ElementContext elemCtx(this->simulator_);
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+            for (long batchIdx = 0; batchIdx < numBatches; ++batchIdx) {
+                try {
+                    const unsigned end = regionBatchStart_[batchIdx + 1];
+                    for (unsigned i = regionBatchStart_[batchIdx]; i < end; ++i) {
+                        if (this->cachedIntensiveQuantities(regionOrderCells_[i], timeIdx))
+                            continue;
+
+                        const auto elem = grid.entity(regionOrderSeeds_[i]);
+                        elemCtx.updatePrimaryStencil(elem);
+                        elemCtx.updatePrimaryIntensiveQuantities(timeIdx);
+                        ++numUpdates;
+                    }
+                }
+                catch (...) {
+                    // exceptions must not leave the parallel region, rethrow one of
+                    // them afterwards
+#ifdef _OPENMP
+#pragma omp critical(BlackOilModel_exception)
+#endif
+                    exceptionPtr = std::current_exception();
+                }
+            }
+        }
+
+        numIntensiveQuantityUpdates_ += numUpdates;
+        if (exceptionPtr) {
+            intensiveQuantitiesTimer_.stop();
+            std::rethrow_exception(exceptionPtr);
+        }
+
+        return numUpdates;
+    }
+
+    // determine the order in which the intensive quantities of the cells are updated
+    // and split it into batches of cells of the same region
+    void createRegionOrder_() const
+    {
+        regionOrderSeeds_.clear();
+        regionOrderCells_.clear();
+        regionBatchStart_.assign(1, 0);
+        regionOrderSequenceNumber_ = this->simulator_.vanguard().gridSequenceNumber();
+
+        // (PVT region, saturation region, cell index, element index)
+        std::vector<std::tuple<unsigned, unsigned, unsigned, unsigned>> keys;
+        std::vector<ElementSeed> seeds;
+        ElementContext elemCtx(this->simulator_);
+        const auto& problem = this->simulator_.problem();
+        for (const auto& elem : elements(this->gridView())) {
+            elemCtx.updatePrimaryStencil(elem);
+            if (elemCtx.numPrimaryDof(/*timeIdx=*/0) != 1)
+                return;
+
+            keys.emplace_back(problem.pvtRegionIndex(elemCtx, /*dofIdx=*/0, /*timeIdx=*/0),
+                              problem.satnumRegionIndex(elemCtx, /*dofIdx=*/0, /*timeIdx=*/0),
+                              elemCtx.globalSpaceIndex(/*dofIdx=*/0, /*timeIdx=*/0),
+                              static_cast<unsigned>(seeds.size()));
+            seeds.push_back(elem.seed());
+        }
+        std::sort(keys.begin(), keys.end());
+
+        regionOrderSeeds_.reserve(seeds.size());
+        regionOrderCells_.reserve(seeds.size());
+        for (std::size_t i = 0; i < keys.size(); ++i) {
+            const bool newRegion = i > 0 &&
+                (std::get<0>(keys[i]) != std::get<0>(keys[i - 1]) ||
+                 std::get<1>(keys[i]) != std::get<1>(keys[i - 1]));
+            if (newRegion || i - regionBatchStart_.back() == regionBatchSize_)
+                regionBatchStart_.push_back(static_cast<unsigned>(i));
+            regionOrderSeeds_.push_back(seeds[std::get<3>(keys[i])]);
+            regionOrderCells_.push_back(std::get<2>(keys[i]));
+        }
+        if (!keys.empty())
+            regionBatchStart_.push_back(static_cast<unsigned>(keys.size()));
+    }
+
+    // the maximum number of cells which are updated by a thread in one go
+    static constexpr std::size_t regionBatchSize_ = 256;
+
+    mutable std::vector<ElementSeed> regionOrderSeeds_;
+    mutable std::vector<unsigned> regionOrderCells_;
+    mutable std::vector<unsigned> regionBatchStart_;
+    mutable int regionOrderSequenceNumber_ = -1;
+
+    mutable Timer intensiveQuantitiesTimer_;
+    mutable std::size_t numIntensiveQuantityUpdates_ = 0;
 
     std::vector<Scalar> eqWeights_;
     Implementation& asImp_()
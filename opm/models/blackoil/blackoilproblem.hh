@@ -32,6 +32,8 @@
 
 #include <opm/models/common/multiphasebaseproblem.hh>
 
+#include <iostream>
+
 namespace Opm {
 
 /*!
@@ -179,6 +181,27 @@ public:
                                     unsigned) const
     { return 1.0; }
 
+    /*!
+     * \brief Called after the simulation has been run sucessfully.
+     *
+     * In addition to the timing of the base class, this reports the throughput of
+     * the updates of the intensive quantities of the cells. If the intensive
+     * quantities are cached, the invalid ones are updated once per Newton iteration.
+     */
+    void finalize()
+    {
+        ParentType::finalize();
+
+        const auto& model = this->model();
+        const auto& comm = this->gridView().comm();
+        const double numUpdates = comm.sum(static_cast<double>(model.numIntensiveQuantityUpdates()));
+        const double updateTime = comm.max(model.intensiveQuantitiesTimer().realTimeElapsed());
+        if (comm.rank() == 0 && numUpdates > 0 && updateTime > 0.0)
+            std::cout << "Intensive quantities: " << numUpdates << " cell updates in "
+                      << updateTime << " seconds, " << numUpdates/updateTime << " cells/s\n"
+                      << std::flush;
+    }
+
 private:
     //! Returns the implementation of the problem (i.e. static polymorphism)
     Implementation& asImp_()
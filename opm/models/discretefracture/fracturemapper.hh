@@ -30,39 +30,32 @@
 #include <opm/models/utils/propertysystem.hh>
 
 #include <algorithm>
-#include <set>
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+#include <vector>
 
 namespace Opm {
 
 /*!
  * \ingroup DiscreteFractureModel
  * \brief Stores the topology of fractures.
+ *
+ * The fracture edges are first collected using addFractureEdge(). finalize()
+ * then converts them into a flat table which stores the fracture neighbors of
+ * each vertex, so that isFractureVertex() is a single array access and
+ * isFractureEdge() only needs to look at the few fracture edges adjacent to a
+ * vertex.
  */
 template <class TypeTag>
 class FractureMapper
 {
-    struct FractureEdge
-    {
-        FractureEdge(unsigned edgeVertex1Idx, unsigned edgeVertex2Idx)
-            : i_(std::min(edgeVertex1Idx, edgeVertex2Idx)),
-              j_(std::max(edgeVertex1Idx, edgeVertex2Idx))
-        {}
-
-        bool operator<(const FractureEdge& e) const
-        { return i_ < e.i_ || (i_ == e.i_ && j_ < e.j_); }
-
-        bool operator==(const FractureEdge& e) const
-        { return i_ == e.i_ && j_ == e.j_; }
-
-        unsigned i_;
-        unsigned j_;
-    };
-
 public:
     /*!
      * \brief Constructor
      */
     FractureMapper()
+        : neighborOffsets_(1, 0)
     {}
 
     /*!
@@ -73,9 +66,70 @@ public:
      */
     void addFractureEdge(unsigned vertexIdx1, unsigned vertexIdx2)
     {
-        fractureEdges_.insert(FractureEdge(vertexIdx1, vertexIdx2));
-        fractureVertices_.insert(vertexIdx1);
-        fractureVertices_.insert(vertexIdx2);
+        const unsigned maxIdx = std::max(vertexIdx1, vertexIdx2);
+        if (isFractureVertex_.size() <= maxIdx)
+            isFractureVertex_.resize(maxIdx + 1, 0);
+        isFractureVertex_[vertexIdx1] = 1;
+        isFractureVertex_[vertexIdx2] = 1;
+
+        edges_.emplace_back(vertexIdx1, vertexIdx2);
+        finalized_ = false;
+    }
+
+    /*!
+     * \brief Build the lookup table for the fracture edges.
+     *
+     * This must be called after the last fracture edge has been added and
+     * before isFractureEdge() is called. If more fracture edges are added
+     * afterwards, calling finalize() again merges them into the existing table.
+     */
+    void finalize()
+    {
+        if (finalized_)
+            return;
+
+        // add the edges of the existing table so that they are not lost
+        const std::size_t numOldVertices = neighborOffsets_.size() - 1;
+        for (std::size_t vertexIdx = 0; vertexIdx < numOldVertices; ++vertexIdx)
+            for (unsigned k = neighborOffsets_[vertexIdx]; k < neighborOffsets_[vertexIdx + 1]; ++k)
+                if (vertexIdx < neighbors_[k])
+                    edges_.emplace_back(static_cast<unsigned>(vertexIdx), neighbors_[k]);
+
+        const std::size_t numVertices = isFractureVertex_.size();
+        neighborOffsets_.assign(numVertices + 1, 0);
+        for (const auto& [i, j] : edges_) {
+            ++neighborOffsets_[i + 1];
+            ++neighborOffsets_[j + 1];
+        }
+        for (std::size_t vertexIdx = 0; vertexIdx < numVertices; ++vertexIdx)
+            neighborOffsets_[vertexIdx + 1] += neighborOffsets_[vertexIdx];
+
+        neighbors_.resize(neighborOffsets_.back());
+        std::vector<unsigned> cursor(neighborOffsets_.begin(), neighborOffsets_.end() - 1);
+        for (const auto& [i, j] : edges_) {
+            neighbors_[cursor[i]++] = j;
+            neighbors_[cursor[j]++] = i;
+        }
+
+        // the same edge may have been added multiple times by the elements which
+        // share it
+        std::size_t pos = 0;
+        for (std::size_t vertexIdx = 0; vertexIdx < numVertices; ++vertexIdx) {
+            auto begin = neighbors_.begin() + neighborOffsets_[vertexIdx];
+            auto end = neighbors_.begin() + neighborOffsets_[vertexIdx + 1];
+            std::sort(begin, end);
+            end = std::unique(begin, end);
+
+            neighborOffsets_[vertexIdx] = static_cast<unsigned>(pos);
+            pos = static_cast<std::size_t>(std::copy(begin, end, neighbors_.begin() + pos) - neighbors_.begin());
+        }
+        neighborOffsets_[numVertices] = static_cast<unsigned>(pos);
+        neighbors_.resize(pos);
+        neighbors_.shrink_to_fit();
+
+        edges_.clear();
+        edges_.shrink_to_fit();
+        finalized_ = true;
     }
 
     /*!
@@ -84,7 +138,7 @@ public:
      * \param vertexIdx The index of the vertex.
      */
     bool isFractureVertex(unsigned vertexIdx) const
-    { return fractureVertices_.count(vertexIdx) > 0; }
+    { return vertexIdx < isFractureVertex_.size() && isFractureVertex_[vertexIdx]; }
 
     /*!
      * \brief Returns true iff a fracture is associated with a given edge.
@@ -94,13 +148,27 @@ public:
      */
     bool isFractureEdge(unsigned vertex1Idx, unsigned vertex2Idx) const
     {
-        FractureEdge tmp(vertex1Idx, vertex2Idx);
-        return fractureEdges_.count(tmp) > 0;
+        if (!finalized_)
+            throw std::logic_error("FractureMapper::finalize() must be called after "
+                                   "adding fracture edges and before querying them");
+        if (!isFractureVertex(vertex1Idx) || !isFractureVertex(vertex2Idx)
+            || vertex1Idx + 1 >= neighborOffsets_.size())
+            return false;
+
+        const unsigned* it = neighbors_.data() + neighborOffsets_[vertex1Idx];
+        const unsigned* endIt = neighbors_.data() + neighborOffsets_[vertex1Idx + 1];
+        for (; it != endIt; ++it)
+            if (*it == vertex2Idx)
+                return true;
+        return false;
     }
 
 private:
-    std::set<FractureEdge> fractureEdges_;
-    std::set<unsigned> fractureVertices_;
+    std::vector<char> isFractureVertex_;
+    std::vector<unsigned> neighborOffsets_;
+    std::vector<unsigned> neighbors_;
+    std::vector<std::pair<unsigned, unsigned> > edges_;
+    bool finalized_ = true;
 };
 
 } // namespace Opm
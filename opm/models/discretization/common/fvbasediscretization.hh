@@ -50,7 +50,7 @@
 #include <opm/models/parallel/threadmanager.hh>
 #include <opm/simulators/linalg/nullborderlistmanager.hh>
 #include <opm/models/utils/simulator.hh>
-#include <opm/models/utils/alignedallocator.hh>
+#include <opm/models/utils/firsttouchallocator.hh>
 #include <opm/models/utils/timer.hh>
 #include <opm/models/utils/timerguard.hh>
 #include <opm/models/io/vtkprimaryvarsmodule.hh>
@@ -215,6 +215,8 @@ struct ThreadManager<TypeTag, TTag::FvBaseDiscretization> { using type = ::Opm::
 template<class TypeTag>
 struct ThreadsPerProcess<TypeTag, TTag::FvBaseDiscretization> { static constexpr int value = 1; };
 template<class TypeTag>
+struct ThreadPinning<TypeTag, TTag::FvBaseDiscretization> { static constexpr auto value = "none"; };
+template<class TypeTag>
 struct UseLinearizationLock<TypeTag, TTag::FvBaseDiscretization> { static constexpr bool value = true; };
 
 /*!
@@ -276,6 +278,14 @@ struct EnableConstraints<TypeTag, TTag::FvBaseDiscretization> { static constexpr
 template<class TypeTag>
 struct EnableIntensiveQuantityCache<TypeTag, TTag::FvBaseDiscretization> { static constexpr bool value = false; };
 
+// copy the cached intensive quantities to the element contexts by default
+template<class TypeTag>
+struct ReferenceCachedIntensiveQuantities<TypeTag, TTag::FvBaseDiscretization> { static constexpr bool value = false; };
+
+// keep the ordering of the grid if the elements are renumbered by the element mapper
+template<class TypeTag>
+struct CellOrdering<TypeTag, TTag::FvBaseDiscretization> { static constexpr auto value = "natural"; };
+
 // do not use thermodynamic hints by default. If you enable this, make sure to also
 // enable the intensive quantity cache above to avoid getting an exception...
 template<class TypeTag>
@@ -383,7 +393,7 @@ class FvBaseDiscretization
         historySize = getPropValue<TypeTag, Properties::TimeDiscHistorySize>(),
     };
 
-    using IntensiveQuantitiesVector = std::vector<IntensiveQuantities, aligned_allocator<IntensiveQuantities, alignof(IntensiveQuantities)> >;
+    using IntensiveQuantitiesVector = std::vector<IntensiveQuantities, FirstTouchAllocator<IntensiveQuantities, alignof(IntensiveQuantities)> >;
 
     using Element = typename GridView::template Codim<0>::Entity;
     using ElementIterator = typename GridView::template Codim<0>::Iterator;
@@ -518,10 +528,16 @@ public:
             ("Enable thermodynamic hints");
         Parameters::registerParam<TypeTag, Properties::EnableIntensiveQuantityCache>
             ("Turn on caching of intensive quantities");
+        Parameters::registerParam<TypeTag, Properties::ReferenceCachedIntensiveQuantities>
+            ("Let the element contexts refer to the cached intensive quantities instead "
+             "of copying them");
         Parameters::registerParam<TypeTag, Properties::EnableStorageCache>
             ("Store previous storage terms and avoid re-calculating them.");
         Parameters::registerParam<TypeTag, Properties::OutputDir>
             ("The directory to which result files are written");
+        Parameters::registerParam<TypeTag, Properties::CellOrdering>
+            ("The ordering of the elements if the ReorderingElementMapper is used "
+             "(natural, rcm, hilbert or partition)");
     }
 
     /*!
@@ -797,6 +813,50 @@ public:
         }
     }
 
+    /*!
+     * \brief Compute the intensive quantities of the degrees of freedom for which the
+     *        cache does not contain up-to-date ones.
+     *
+     * In contrast to invalidateAndUpdateIntensiveQuantities(), the valid cache entries
+     * are kept.
+     *
+     * \param timeIdx The index used by the time discretization.
+     * \return The number of degrees of freedom whose intensive quantities were updated
+     */
+    std::size_t updateInvalidIntensiveQuantities(unsigned timeIdx) const
+    {
+        std::size_t numUpdates = 0;
+
+        // loop over all elements...
+        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(gridView_);
+#ifdef _OPENMP
+#pragma omp parallel reduction(+:numUpdates)
+#endif
+        {
+            ElementContext elemCtx(simulator_);
+            ElementIterator elemIt = threadedElemIt.beginParallel();
+            for (; !threadedElemIt.isFinished(elemIt); elemIt = threadedElemIt.increment()) {
+                const Element& elem = *elemIt;
+                elemCtx.updatePrimaryStencil(elem);
+
+                unsigned numInvalid = 0;
+                const std::size_t numPrimaryDof = elemCtx.numPrimaryDof(timeIdx);
+                for (unsigned dofIdx = 0; dofIdx < numPrimaryDof; ++dofIdx)
+                    if (!cachedIntensiveQuantities(elemCtx.globalSpaceIndex(dofIdx, timeIdx), timeIdx))
+                        ++numInvalid;
+
+                // the element context only computes the intensive quantities of the
+                // degrees of freedom which are not cached
+                if (numInvalid > 0) {
+                    elemCtx.updatePrimaryIntensiveQuantities(timeIdx);
+                    numUpdates += numInvalid;
+                }
+            }
+        }
+
+        return numUpdates;
+    }
+
     template <class GridViewType>
     void invalidateAndUpdateIntensiveQuantities(unsigned timeIdx, const GridViewType& gridView) const
     {
@@ -1422,7 +1482,7 @@ public:
         // previous time step so that we can start the next
         // update at a physically meaningful solution.
         solution(/*timeIdx=*/0) = solution(/*timeIdx=*/1);
-        invalidateAndUpdateIntensiveQuantities(/*timeIdx=*/0);
+        asImp_().invalidateAndUpdateIntensiveQuantities(/*timeIdx=*/0);
 
 #ifndef NDEBUG
         for (unsigned timeIdx = 0; timeIdx < historySize; ++timeIdx) {
@@ -1856,6 +1916,16 @@ public:
     bool storeIntensiveQuantities() const
     { return enableIntensiveQuantityCache_ || enableThermodynamicHints_; }
 
+    /*!
+     * \brief Returns true if the cached intensive quantities are used instead of
+     *        recomputing them
+     *
+     * If only thermodynamic hints are enabled, the intensive quantities are stored
+     * but not used by the element contexts.
+     */
+    bool enableIntensiveQuantityCache() const
+    { return enableIntensiveQuantityCache_; }
+
     const Timer& prePostProcessTimer() const
     { return prePostProcessTimer_; }
 
@@ -1976,14 +2046,16 @@ protected:
     // solution of the previous time step
     mutable IntensiveQuantitiesVector intensiveQuantityCache_[historySize];
     // while these are logically bools, concurrent writes to vector<bool> are not thread safe.
-    mutable std::vector<unsigned char> intensiveQuantityCacheUpToDate_[historySize];
+    mutable std::vector<unsigned char, FirstTouchAllocator<unsigned char>> intensiveQuantityCacheUpToDate_[historySize];
 
     mutable std::array< std::unique_ptr< DiscreteFunction >, historySize > solution_;
 
     std::list<BaseOutputModule<TypeTag>*> outputModules_;
 
     Scalar gridTotalVolume_;
-    std::vector<Scalar> dofTotalVolume_;
+    // the large per-DOF arrays are placed on the NUMA domains of the threads which
+    // work on them
+    std::vector<Scalar, FirstTouchAllocator<Scalar>> dofTotalVolume_;
     std::vector<bool> isLocalDof_;
 
     mutable GlobalEqVector storageCache_[historySize];
@@ -60,6 +60,9 @@ class FvBaseElementContext
 
     struct DofStore_ {
         IntensiveQuantities intensiveQuantities[timeDiscHistorySize];
+        // the entry of the model's cache which is used instead of the local copy of the
+        // intensive quantities, or nullptr if the local copy is up to date
+        const IntensiveQuantities* cachedIntensiveQuantities[timeDiscHistorySize] = {};
         const PrimaryVariables* priVars[timeDiscHistorySize];
         const IntensiveQuantities *thermodynamicHint[timeDiscHistorySize];
     };
@@ -96,6 +99,7 @@ public:
         // remember the simulator object
         simulatorPtr_ = &simulator;
         enableStorageCache_ = Parameters::get<TypeTag, Properties::EnableStorageCache>();
+        referenceCachedIntQuants_ = Parameters::get<TypeTag, Properties::ReferenceCachedIntensiveQuantities>();
         stashedDofIdx_ = -1;
         focusDofIdx_ = -1;
     }
@@ -414,7 +418,9 @@ public:
                                    "for the most-recent substep (i.e. time index 0) are available!");
 #endif
 
-        return dofVars_[dofIdx].intensiveQuantities[timeIdx];
+        const auto& dofVars = dofVars_[dofIdx];
+        const IntensiveQuantities* cachedIntQuants = dofVars.cachedIntensiveQuantities[timeIdx];
+        return cachedIntQuants ? *cachedIntQuants : dofVars.intensiveQuantities[timeIdx];
     }
 
     /*!
@@ -432,11 +438,20 @@ public:
     }
     /*!
      * \copydoc intensiveQuantities()
+     *
+     * If the context refers to the model's cache for the degree of freedom, the
+     * intensive quantities are copied to the context first, so modifying them does
+     * not affect the cache.
      */
     IntensiveQuantities& intensiveQuantities(unsigned dofIdx, unsigned timeIdx)
     {
         assert(dofIdx < numDof(timeIdx));
-        return dofVars_[dofIdx].intensiveQuantities[timeIdx];
+        auto& dofVars = dofVars_[dofIdx];
+        if (dofVars.cachedIntensiveQuantities[timeIdx]) {
+            dofVars.intensiveQuantities[timeIdx] = *dofVars.cachedIntensiveQuantities[timeIdx];
+            dofVars.cachedIntensiveQuantities[timeIdx] = nullptr;
+        }
+        return dofVars.intensiveQuantities[timeIdx];
     }
 
     /*!
@@ -480,8 +495,13 @@ public:
     {
         assert(dofIdx < numDof(/*timeIdx=*/0));
 
-        intensiveQuantitiesStashed_ = dofVars_[dofIdx].intensiveQuantities[/*timeIdx=*/0];
-        priVarsStashed_ = *dofVars_[dofIdx].priVars[/*timeIdx=*/0];
+        // if the intensive quantities are referenced from the cache, the reference
+        // stays valid and does not need to be copied
+        auto& dofVars = dofVars_[dofIdx];
+        cachedIntensiveQuantitiesStashed_ = dofVars.cachedIntensiveQuantities[/*timeIdx=*/0];
+        if (!cachedIntensiveQuantitiesStashed_)
+            intensiveQuantitiesStashed_ = dofVars.intensiveQuantities[/*timeIdx=*/0];
+        priVarsStashed_ = *dofVars.priVars[/*timeIdx=*/0];
         stashedDofIdx_ = static_cast<int>(dofIdx);
     }
 
@@ -492,8 +512,11 @@ public:
      */
     void restoreIntensiveQuantities(unsigned dofIdx)
     {
-        dofVars_[dofIdx].priVars[/*timeIdx=*/0] = &priVarsStashed_;
-        dofVars_[dofIdx].intensiveQuantities[/*timeIdx=*/0] = intensiveQuantitiesStashed_;
+        auto& dofVars = dofVars_[dofIdx];
+        dofVars.priVars[/*timeIdx=*/0] = &priVarsStashed_;
+        dofVars.cachedIntensiveQuantities[/*timeIdx=*/0] = cachedIntensiveQuantitiesStashed_;
+        if (!cachedIntensiveQuantitiesStashed_)
+            dofVars.intensiveQuantities[/*timeIdx=*/0] = intensiveQuantitiesStashed_;
         stashedDofIdx_ = -1;
     }
 
@@ -558,7 +581,13 @@ protected:
                 model().thermodynamicHint(globalIdx, timeIdx);
 
             const auto *cachedIntQuants = model().cachedIntensiveQuantities(globalIdx, timeIdx);
-            if (cachedIntQuants) {
+            if (cachedIntQuants && referenceCachedIntQuants_) {
+                // the entries of the cache are only written if they are invalid, so
+                // the cached object can be used directly instead of copying it
+                dofVars_[dofIdx].cachedIntensiveQuantities[timeIdx] = cachedIntQuants;
+            }
+            else if (cachedIntQuants) {
+                dofVars_[dofIdx].cachedIntensiveQuantities[timeIdx] = nullptr;
                 dofVars_[dofIdx].intensiveQuantities[timeIdx] = *cachedIntQuants;
             }
             else {
@@ -579,10 +608,12 @@ protected:
 #endif
 
         dofVars_[dofIdx].priVars[timeIdx] = &priVars;
+        dofVars_[dofIdx].cachedIntensiveQuantities[timeIdx] = nullptr;
         dofVars_[dofIdx].intensiveQuantities[timeIdx].update(/*context=*/asImp_(), dofIdx, timeIdx);
     }
 
     IntensiveQuantities intensiveQuantitiesStashed_;
+    const IntensiveQuantities* cachedIntensiveQuantitiesStashed_ = nullptr;
     PrimaryVariables priVarsStashed_;
 
     GradientCalculator gradientCalculator_;
@@ -598,6 +629,7 @@ protected:
     int stashedDofIdx_;
     int focusDofIdx_;
     bool enableStorageCache_;
+    bool referenceCachedIntQuants_;
 };
 
 } // namespace Opm
@@ -39,18 +39,22 @@
 #include <opm/models/parallel/threadmanager.hh>
 #include <opm/models/parallel/threadedentityiterator.hh>
 #include <opm/models/discretization/common/baseauxiliarymodule.hh>
+#include <opm/simulators/linalg/sparsitypattern.hh>
 
 #include <dune/common/version.hh>
 #include <dune/common/fvector.hh>
 #include <dune/common/fmatrix.hh>
 
+#include <cassert>
 #include <type_traits>
+#include <utility>
 #include <iostream>
 #include <vector>
 #include <thread>
 #include <set>
 #include <exception>   // current_exception, rethrow_exception
 #include <mutex>
+#include <stdexcept>
 
 namespace Opm {
 // forward declarations
@@ -80,6 +84,8 @@ class FvBaseLinearizer
     using DofMapper = GetPropType<TypeTag, Properties::DofMapper>;
     using ElementMapper = GetPropType<TypeTag, Properties::ElementMapper>;
     using ElementContext = GetPropType<TypeTag, Properties::ElementContext>;
+    using LocalResidual = GetPropType<TypeTag, Properties::LocalResidual>;
+    using RateVector = GetPropType<TypeTag, Properties::RateVector>;
 
     using SolutionVector = GetPropType<TypeTag, Properties::SolutionVector>;
     using GlobalEqVector = GetPropType<TypeTag, Properties::GlobalEqVector>;
@@ -95,6 +101,8 @@ class FvBaseLinearizer
 
     using Element = typename GridView::template Codim<0>::Entity;
     using ElementIterator = typename GridView::template Codim<0>::Iterator;
+    using ElementSeed = typename Element::EntitySeed;
+    using LocalEvalBlockVector = typename LocalResidual::LocalEvalBlockVector;
 
     using Vector = GlobalEqVector;
 
@@ -108,6 +116,14 @@ class FvBaseLinearizer
 
     static const bool linearizeNonLocalElements = getPropValue<TypeTag, Properties::LinearizeNonLocalElements>();
 
+    // subdomains either provide a grid view of their elements or they are given by the
+    // global indices and the element seeds of their cells
+    template <class SubDomainType, class = void>
+    struct HasGridView_ : std::false_type {};
+    template <class SubDomainType>
+    struct HasGridView_<SubDomainType, std::void_t<decltype(std::declval<const SubDomainType&>().view)> >
+        : std::true_type {};
+
     // copying the linearizer is not a good idea
     FvBaseLinearizer(const FvBaseLinearizer&);
 //! \endcond
@@ -197,52 +213,170 @@ public:
         linearizeDomain(*fullDomain_);
     }
 
+    /*!
+     * \brief Linearize the part of the non-linear system of equations that is associated
+     *        with a subdomain.
+     *
+     * The subdomain is either specified by a grid view of its elements or, for
+     * cell-centered discretizations, by the global indices ('cells') and the seeds
+     * ('elementSeeds') of its elements. In the latter case, only the residual and the
+     * rows of the Jacobian matrix of the cells are updated, the remaining rows are left
+     * untouched. Also, the linearization does not communicate with the other processes,
+     * i.e., each process may linearize its subdomains independently.
+     */
     template <class SubDomainType>
     void linearizeDomain(const SubDomainType& domain)
     {
-        OPM_TIMEBLOCK(linearizeDomain);
-        // we defer the initialization of the Jacobian matrix until here because the
-        // auxiliary modules usually assume the problem, model and grid to be fully
-        // initialized...
-        if (!jacobian_)
-            initFirstIteration_();
-
-        // Called here because it is no longer called from linearize_().
-        if (static_cast<std::size_t>(domain.view.size(0)) == model_().numTotalDof()) {
-            // We are on the full domain.
-            resetSystem_();
-        } else {
-            resetSystem_(domain);
+        if constexpr (!HasGridView_<SubDomainType>::value) {
+            linearizeCells_(domain);
         }
+        else {
+            OPM_TIMEBLOCK(linearizeDomain);
+            // we defer the initialization of the Jacobian matrix until here because the
+            // auxiliary modules usually assume the problem, model and grid to be fully
+            // initialized...
+            if (!jacobian_)
+                initFirstIteration_();
+
+            // Called here because it is no longer called from linearize_().
+            if (static_cast<std::size_t>(domain.view.size(0)) == model_().numTotalDof()) {
+                // We are on the full domain.
+                resetSystem_();
+            } else {
+                resetSystem_(domain);
+            }
 
-        int succeeded;
-        try {
-            linearize_(domain);
-            succeeded = 1;
-        }
-        catch (const std::exception& e)
-        {
-            std::cout << "rank " << simulator_().gridView().comm().rank()
-                      << " caught an exception while linearizing:" << e.what()
-                      << "\n"  << std::flush;
-            succeeded = 0;
-        }
-        catch (...)
-        {
-            std::cout << "rank " << simulator_().gridView().comm().rank()
-                      << " caught an exception while linearizing"
-                      << "\n"  << std::flush;
-            succeeded = 0;
-        }
-        succeeded = simulator_().gridView().comm().min(succeeded);
+            int succeeded;
+            try {
+                linearize_(domain);
+                succeeded = 1;
+            }
+            catch (const std::exception& e)
+            {
+                std::cout << "rank " << simulator_().gridView().comm().rank()
+                          << " caught an exception while linearizing:" << e.what()
+                          << "\n"  << std::flush;
+                succeeded = 0;
+            }
+            catch (...)
+            {
+                std::cout << "rank " << simulator_().gridView().comm().rank()
+                          << " caught an exception while linearizing"
+                          << "\n"  << std::flush;
+                succeeded = 0;
+            }
+            succeeded = simulator_().gridView().comm().min(succeeded);
 
-        if (!succeeded)
-            throw NumericalProblem("A process did not succeed in linearizing the system");
+            if (!succeeded)
+                throw NumericalProblem("A process did not succeed in linearizing the system");
+        }
     }
 
     void finalize()
     { jacobian_->finalize(); }
 
+    /*!
+     * \brief Recover the parts of the solution update which are not determined by
+     *        the linear solver.
+     *
+     * This linearizer always assembles the full system, so there is nothing to do.
+     */
+    void expandSolutionUpdate(GlobalEqVector&) const
+    { }
+
+    /*!
+     * \brief Returns true if finalize() condenses unknowns out of the linear system.
+     *
+     * This linearizer always assembles the full system.
+     */
+    bool hasCondensedUnknowns() const
+    { return false; }
+
+    /*!
+     * \brief Evaluate the residual of a single cell and its derivatives with regard
+     *        to the primary variables of the cell.
+     *
+     * This neither modifies the global residual nor the Jacobian matrix, so it may be
+     * called for different cells concurrently. The intensive quantities of the cell
+     * and its neighbors are given by intQuants(globalIdx). For each face,
+     * faceFn(neighborIdx, flux, fluxDeriv) is called with the flux out of the cell
+     * and its derivatives with regard to the primary variables of the cell. The
+     * derivatives of the neighbor's residual with regard to the cell's primary
+     * variables are the negative of the latter.
+     *
+     * This is only possible for cell-centered discretizations which use automatic
+     * differentiation, and the system must have been linearized before. The
+     * residual is evaluated by the local residual of the model using the element
+     * context of the calling thread.
+     */
+    template <class IntQuantsFn, class FaceFn>
+    void linearizeCell(unsigned globI,
+                       const IntQuantsFn& intQuants,
+                       VectorBlock& res,
+                       MatrixBlock& diag,
+                       FaceFn&& faceFn)
+    {
+        if constexpr (std::is_same_v<Evaluation, Scalar>) {
+            throw std::logic_error("Evaluating the residual of a single cell requires "
+                                   "automatic differentiation");
+        }
+        else {
+            if (globI >= cellSeeds_.size() || !isCell_[globI])
+                throw std::logic_error("Evaluating the residual of a single cell requires "
+                                       "a cell-centered discretization");
+
+            const unsigned threadId = ThreadManager::threadId();
+            ElementContext& elemCtx = *elementCtx_[threadId];
+            const auto& localResidual = model_().localResidual(threadId);
+
+            // the element must outlive its use by the context
+            const auto elem = gridView_().grid().entity(cellSeeds_[globI]);
+            elemCtx.updateStencil(elem);
+            elemCtx.updateAllIntensiveQuantities();
+            const unsigned numDof = elemCtx.numDof(/*timeIdx=*/0);
+            for (unsigned dofIdx = 0; dofIdx < numDof; ++dofIdx)
+                elemCtx.intensiveQuantities(dofIdx, /*timeIdx=*/0) =
+                    intQuants(elemCtx.globalSpaceIndex(dofIdx, /*timeIdx=*/0));
+            elemCtx.setFocusDofIndex(/*dofIdx=*/0);
+            elemCtx.updateAllExtensiveQuantities();
+
+            LocalEvalBlockVector residual(numDof);
+            localResidual.eval(residual, elemCtx);
+            for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx) {
+                res[eqIdx] = residual[0][eqIdx].value();
+                for (unsigned pvIdx = 0; pvIdx < numEq; ++pvIdx)
+                    diag[eqIdx][pvIdx] = residual[0][eqIdx].derivative(pvIdx);
+            }
+
+            // the fluxes are evaluated once more for each face because the local
+            // residual only provides their sum. like the residual, they are passed in
+            // the units of the residual of the neighbor.
+            const auto& stencil = elemCtx.stencil(/*timeIdx=*/0);
+            RateVector flux;
+            VectorBlock r;
+            MatrixBlock fluxDeriv;
+            for (unsigned scvfIdx = 0; scvfIdx < elemCtx.numInteriorFaces(/*timeIdx=*/0); ++scvfIdx) {
+                const auto& face = stencil.interiorFace(scvfIdx);
+                assert(face.interiorIndex() == 0);
+                localResidual.computeFlux(flux, elemCtx, scvfIdx, /*timeIdx=*/0);
+                const unsigned j = face.exteriorIndex();
+                Scalar alpha =
+                    elemCtx.extensiveQuantities(scvfIdx, /*timeIdx=*/0).extrusionFactor()*face.area();
+                if (getPropValue<TypeTag, Properties::UseVolumetricResidual>() &&
+                    elemCtx.dofTotalVolume(j, /*timeIdx=*/0) > 0.0)
+                    alpha /= elemCtx.dofTotalVolume(j, /*timeIdx=*/0);
+                for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx) {
+                    r[eqIdx] = flux[eqIdx].value()*alpha;
+                    for (unsigned pvIdx = 0; pvIdx < numEq; ++pvIdx)
+                        fluxDeriv[eqIdx][pvIdx] = flux[eqIdx].derivative(pvIdx)*alpha;
+                }
+                faceFn(elemCtx.globalSpaceIndex(j, /*timeIdx=*/0),
+                       static_cast<const VectorBlock&>(r),
+                       static_cast<const MatrixBlock&>(fluxDeriv));
+            }
+        }
+    }
+
     /*!
      * \brief Linearize the part of the non-linear system of equations that is associated
      *        with the spatial domain.
@@ -421,34 +555,60 @@ private:
         Stencil stencil(gridView_(), model_().dofMapper());
 
         // for the main model, find out the global indices of the neighboring degrees of
-        // freedom of each primary degree of freedom
-        sparsityPattern_.clear();
-        sparsityPattern_.resize(model.numTotalDof());
-
+        // freedom of each primary degree of freedom. to avoid updating the stencils
+        // twice, their global indices are recorded in the first pass and the column
+        // indices of the matrix are filled from these in the second one.
+        Linear::SparsityPattern sparsityPattern(model.numTotalDof());
+        std::vector<unsigned> stencilIndices;
+        std::vector<size_t> stencilOffsets(1, 0);
+        std::vector<unsigned> stencilNumPrimaryDof;
+        stencilOffsets.reserve(gridView_().size(/*codim=*/0) + 1);
+        stencilNumPrimaryDof.reserve(gridView_().size(/*codim=*/0));
+        cellSeeds_.resize(model.numTotalDof());
+        isCell_.assign(model.numTotalDof(), 0);
         for (const auto& elem : elements(gridView_())) {
             stencil.update(elem);
 
-            for (unsigned primaryDofIdx = 0; primaryDofIdx < stencil.numPrimaryDof(); ++primaryDofIdx) {
-                unsigned myIdx = stencil.globalSpaceIndex(primaryDofIdx);
-
-                for (unsigned dofIdx = 0; dofIdx < stencil.numDof(); ++dofIdx) {
-                    unsigned neighborIdx = stencil.globalSpaceIndex(dofIdx);
-                    sparsityPattern_[myIdx].insert(neighborIdx);
-                }
+            // remember the elements of cell-centered degrees of freedom for
+            // linearizeCell()
+            if (stencil.numPrimaryDof() == 1) {
+                cellSeeds_[stencil.globalSpaceIndex(/*dofIdx=*/0)] = elem.seed();
+                isCell_[stencil.globalSpaceIndex(/*dofIdx=*/0)] = 1;
             }
+
+            for (unsigned dofIdx = 0; dofIdx < stencil.numDof(); ++dofIdx)
+                stencilIndices.push_back(stencil.globalSpaceIndex(dofIdx));
+            stencilOffsets.push_back(stencilIndices.size());
+            stencilNumPrimaryDof.push_back(stencil.numPrimaryDof());
+
+            for (unsigned primaryDofIdx = 0; primaryDofIdx < stencil.numPrimaryDof(); ++primaryDofIdx)
+                sparsityPattern.addRowSize(stencil.globalSpaceIndex(primaryDofIdx), stencil.numDof());
+        }
+
+        sparsityPattern.endRowSizes();
+        for (size_t elemIdx = 0; elemIdx < stencilNumPrimaryDof.size(); ++elemIdx) {
+            const auto begin = stencilIndices.begin() + stencilOffsets[elemIdx];
+            const auto end = stencilIndices.begin() + stencilOffsets[elemIdx + 1];
+            for (unsigned primaryDofIdx = 0; primaryDofIdx < stencilNumPrimaryDof[elemIdx]; ++primaryDofIdx)
+                sparsityPattern.addIndices(*(begin + primaryDofIdx), begin, end);
         }
+        sparsityPattern.endIndices();
 
         // add the additional neighbors and degrees of freedom caused by the auxiliary
         // equations
         size_t numAuxMod = model.numAuxiliaryModules();
-        for (unsigned auxModIdx = 0; auxModIdx < numAuxMod; ++auxModIdx)
-            model.auxiliaryModule(auxModIdx)->addNeighbors(sparsityPattern_);
+        if (numAuxMod > 0) {
+            std::vector<std::set<unsigned>> auxNeighbors(model.numTotalDof());
+            for (unsigned auxModIdx = 0; auxModIdx < numAuxMod; ++auxModIdx)
+                model.auxiliaryModule(auxModIdx)->addNeighbors(auxNeighbors);
+            sparsityPattern.merge(auxNeighbors);
+        }
 
         // allocate raw matrix
         jacobian_.reset(new SparseMatrixAdapter(simulator_()));
 
         // create matrix structure based on sparsity pattern
-        jacobian_->reserve(sparsityPattern_);
+        jacobian_->reserve(sparsityPattern);
     }
 
     // reset the global linear system of equations.
@@ -505,6 +665,58 @@ private:
         }
     }
 
+    // linearize a subdomain which is given by the indices and the element seeds of its
+    // cells. with cell-centered discretizations, the residual of a cell and its
+    // derivatives with regard to the primary variables of the cells of the subdomain
+    // are completely determined by the elements of the subdomain. the elements also
+    // contribute to the rows of their neighbors, which are skipped for the cells
+    // outside of the subdomain.
+    template <class SubDomainType>
+    void linearizeCells_(const SubDomainType& domain)
+    {
+        OPM_TIMEBLOCK(linearizeCells_);
+
+        if (!jacobian_)
+            initFirstIteration_();
+
+        isDomainCell_.resize(model_().numTotalDof(), 0);
+        for (int globI : domain.cells) {
+            isDomainCell_[globI] = 1;
+            residual_[globI] = 0.0;
+            jacobian_->clearRow(globI, 0.0);
+        }
+
+        applyConstraintsToSolution_();
+
+        std::mutex exceptionLock;
+        std::exception_ptr exceptionPtr = nullptr;
+
+        const auto& grid = gridView_().grid();
+        const int numElements = domain.elementSeeds.size();
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (int elemIdx = 0; elemIdx < numElements; ++elemIdx) {
+            try {
+                // the element must outlive its use by the element context
+                const auto elem = grid.entity(domain.elementSeeds[elemIdx]);
+                linearizeElement_(elem, [this](unsigned globJ) { return isDomainCell_[globJ]; });
+            }
+            catch(...) {
+                std::lock_guard<std::mutex> take(exceptionLock);
+                exceptionPtr = std::current_exception();
+            }
+        }
+
+        for (int globI : domain.cells)
+            isDomainCell_[globI] = 0;
+
+        if (exceptionPtr)
+            std::rethrow_exception(exceptionPtr);
+
+        applyConstraintsToLinearization_();
+    }
+
     // linearize the whole or part of the system
     template <class SubDomainType>
     void linearize_(const SubDomainType& domain)
@@ -593,6 +805,12 @@ private:
     // linearize an element in the interior of the process' grid partition
     template <class ElementType>
     void linearizeElement_(const ElementType& elem)
+    { linearizeElement_(elem, [](unsigned) { return true; }); }
+
+    // linearize an element, but only update the rows of the Jacobian matrix for the
+    // degrees of freedom for which isRowUpdated(globalIdx) is true
+    template <class ElementType, class RowPredicate>
+    void linearizeElement_(const ElementType& elem, const RowPredicate& isRowUpdated)
     {
         unsigned threadId = ThreadManager::threadId();
 
@@ -616,6 +834,8 @@ private:
             // update the global Jacobian matrix
             for (unsigned dofIdx = 0; dofIdx < elementCtx->numDof(/*timeIdx=*/0); ++ dofIdx) {
                 unsigned globJ = elementCtx->globalSpaceIndex(/*spaceIdx=*/dofIdx, /*timeIdx=*/0);
+                if (!isRowUpdated(globJ))
+                    continue;
 
                 jacobian_->addToBlock(globJ, globI, localLinearizer.jacobian(dofIdx, primaryDofIdx));
             }
@@ -671,6 +891,13 @@ private:
     Simulator *simulatorPtr_;
     std::vector<ElementContext*> elementCtx_;
 
+    // the elements of the cell-centered degrees of freedom
+    std::vector<ElementSeed> cellSeeds_;
+    std::vector<char> isCell_;
+    // marks the cells of the subdomain which is currently linearized by
+    // linearizeCells_()
+    std::vector<char> isDomainCell_;
+
     // The constraint equations (only non-empty if the
     // EnableConstraints property is true)
     std::map<unsigned, Constraints> constraintsMap_;
@@ -695,8 +922,6 @@ private:
 
     std::mutex globalMatrixMutex_;
 
-    std::vector<std::set<unsigned int>> sparsityPattern_;
-
     struct FullDomain
     {
         explicit FullDomain(const GridView& v) : view (v) {}
@@ -43,6 +43,7 @@
 #include <dune/common/classname.hh>
 
 #include <cmath>
+#include <utility>
 
 namespace Opm {
 /*!
@@ -501,8 +502,10 @@ protected:
         // evaluate the volumetric terms (storage + source terms)
         size_t numPrimaryDof = elemCtx.numPrimaryDof(/*timeIdx=*/0);
         for (unsigned dofIdx=0; dofIdx < numPrimaryDof; dofIdx++) {
+            // the const accessor is used because the non-const one materializes a
+            // copy if the context refers to cached intensive quantities
             Scalar extrusionFactor =
-                elemCtx.intensiveQuantities(dofIdx, /*timeIdx=*/0).extrusionFactor();
+                std::as_const(elemCtx).intensiveQuantities(dofIdx, /*timeIdx=*/0).extrusionFactor();
             Valgrind::CheckDefined(extrusionFactor);
             assert(isfinite(extrusionFactor));
             assert(extrusionFactor > 0.0);
@@ -33,6 +33,11 @@
 #include <opm/models/nonlinear/newtonmethod.hh>
 #include <opm/models/utils/propertysystem.hh>
 
+#include <opm/common/Exceptions.hpp>
+
+#include <exception>
+#include <iostream>
+
 namespace Opm {
 
 template <class TypeTag>
@@ -147,6 +152,45 @@ protected:
         ParentType::beginIteration_();
     }
 
+    /*!
+     * \brief Linearize the global non-linear system of equations associated with the
+     *        spatial domain.
+     *
+     * If the intensive quantities are cached, the invalid ones are not computed on
+     * demand by the linearizer, but they are updated beforehand. This lets the model
+     * choose an efficient order for the updates, see e.g.
+     * BlackOilModel::updateInvalidIntensiveQuantities(). The valid cache entries are
+     * kept, i.e., the intensive quantities of all degrees of freedom are only
+     * recomputed after Model::updateFailed().
+     */
+    void linearizeDomain_()
+    {
+        if (model_().enableIntensiveQuantityCache()) {
+            const auto& comm = this->simulator_.gridView().comm();
+
+            int succeeded = 1;
+            try {
+                bool needsUpdate = false;
+                for (unsigned dofIdx = 0; dofIdx < model_().numGridDof() && !needsUpdate; ++dofIdx)
+                    needsUpdate = model_().cachedIntensiveQuantities(dofIdx, /*timeIdx=*/0) == nullptr;
+
+                if (needsUpdate)
+                    model_().updateInvalidIntensiveQuantities(/*timeIdx=*/0);
+            }
+            catch (const std::exception& e) {
+                std::cout << "rank " << comm.rank()
+                          << " caught an exception while updating the intensive quantities:"
+                          << e.what() << "\n" << std::flush;
+                succeeded = 0;
+            }
+
+            if (!comm.min(succeeded))
+                throw NumericalProblem("A process did not succeed in updating the intensive quantities");
+        }
+
+        ParentType::linearizeDomain_();
+    }
+
     /*!
      * \brief Returns a reference to the model.
      */
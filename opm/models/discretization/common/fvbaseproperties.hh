@@ -191,6 +191,10 @@ template<class TypeTag, class MyTypeTag>
 struct ThreadManager { using type = UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
 struct ThreadsPerProcess { using type = UndefinedProperty; };
+//! Specifies how the OpenMP threads are pinned to the processors ("none",
+//! "compact" or "spread")
+template<class TypeTag, class MyTypeTag>
+struct ThreadPinning { using type = UndefinedProperty; };
 
 //! use locking to prevent race conditions when linearizing the global system of
 //! equations in multi-threaded mode. (setting this property to true is always save, but
@@ -296,6 +300,17 @@ struct ContinueOnConvergenceError { using type = UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
 struct EnableIntensiveQuantityCache { using type = UndefinedProperty; };
 
+/*!
+ * \brief Specify whether element contexts refer to the cached intensive quantities
+ *        instead of copying them.
+ *
+ * This only has an effect if the intensive quantity cache is enabled. It avoids
+ * copying the intensive quantities of every degree of freedom of every stencil, at
+ * the price of one indirection per access.
+ */
+template<class TypeTag, class MyTypeTag>
+struct ReferenceCachedIntensiveQuantities { using type = UndefinedProperty; };
+
 /*!
  * \brief Specify whether the storage terms for previous solutions should be cached.
  *
@@ -336,6 +351,14 @@ struct ElementMapper { using type = UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
 struct DofMapper { using type = UndefinedProperty; };
 
+/*!
+ * \brief The ordering of the elements used by the ReorderingElementMapper.
+ *
+ * Possible values are "natural", "rcm", "hilbert" and "partition".
+ */
+template<class TypeTag, class MyTypeTag>
+struct CellOrdering { using type = UndefinedProperty; };
+
 /*!
  * \brief The history size required by the time discretization
  */
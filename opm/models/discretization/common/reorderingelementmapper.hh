@@ -0,0 +1,512 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::ReorderingElementMapper
+ */
+#ifndef EWOMS_REORDERING_ELEMENT_MAPPER_HH
+#define EWOMS_REORDERING_ELEMENT_MAPPER_HH
+
+#include "fvbaseproperties.hh"
+
+#include <opm/models/utils/parametersystem.hh>
+#include <opm/models/utils/propertysystem.hh>
+
+#include <dune/common/fvector.hh>
+#include <dune/common/version.hh>
+#include <dune/grid/common/mcmgmapper.hh>
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \ingroup FiniteVolumeDiscretizations
+ *
+ * \brief The orderings of the grid elements supported by the ReorderingElementMapper.
+ */
+enum class CellOrdering {
+    //! Use the indices of the grid's index set
+    Natural,
+
+    //! Reverse Cuthill-McKee ordering of the element connectivity graph
+    ReverseCuthillMcKee,
+
+    //! Order the elements along a Hilbert space filling curve through their centroids
+    Hilbert,
+
+    //! Group the elements into small compact partitions by recursive bisection
+    Partition
+};
+
+/*!
+ * \brief Convert the value of the CellOrdering parameter to the corresponding enum.
+ */
+inline CellOrdering cellOrderingFromString(const std::string& name)
+{
+    if (name == "natural")
+        return CellOrdering::Natural;
+    else if (name == "rcm")
+        return CellOrdering::ReverseCuthillMcKee;
+    else if (name == "hilbert")
+        return CellOrdering::Hilbert;
+    else if (name == "partition")
+        return CellOrdering::Partition;
+
+    throw std::invalid_argument("Unknown cell ordering '" + name + "'. Valid choices "
+                                "are 'natural', 'rcm', 'hilbert' and 'partition'.");
+}
+
+/*!
+ * \ingroup FiniteVolumeDiscretizations
+ *
+ * \brief An element mapper which renumbers the elements of a grid view to improve
+ *        memory locality.
+ *
+ * The indices produced by the mapper of the grid are not necessarily well suited for the
+ * data structures of the simulator: For unstructured and corner-point grids, the
+ * neighbors of an element often exhibit indices which are far away, which means that
+ * the per-DOF arrays (solution, intensive quantity cache, Jacobian matrix rows, etc.)
+ * are accessed in a cache unfriendly way during linearization and in the linear
+ * solver. Since all of these data structures are indexed using the mapper of the
+ * discretization, using this class as the ElementMapper lets them use the improved
+ * ordering without any further changes. The ordering is selected at run time via the
+ * CellOrdering parameter.
+ *
+ * To enable it for the element centered finite volume discretization, specify
+ * \code
+ * template<class TypeTag>
+ * struct ElementMapper<TypeTag, TTag::YourTypeTag>
+ * { using type = Opm::ReorderingElementMapper<TypeTag>; };
+ * \endcode
+ *
+ * The VTK output maps the data back to the natural order of the grid.
+ */
+template <class TypeTag>
+class ReorderingElementMapper
+{
+    using GridView = GetPropType<TypeTag, Properties::GridView>;
+    using NaturalMapper = Dune::MultipleCodimMultipleGeomTypeMapper<GridView>;
+    using Element = typename GridView::template Codim<0>::Entity;
+
+    enum { dimWorld = GridView::dimensionworld };
+
+    using CoordScalar = typename GridView::ctype;
+    using GlobalPosition = Dune::FieldVector<CoordScalar, dimWorld>;
+
+    // the maximum number of elements in a partition of the partition-based ordering
+    static constexpr std::size_t partitionSize_ = 128;
+
+public:
+    using Index = typename NaturalMapper::Index;
+
+    ReorderingElementMapper(const GridView& gridView, const Dune::MCMGLayout& layout)
+        : gridView_(gridView)
+        , naturalMapper_(gridView, layout)
+        , ordering_(cellOrderingFromString(Parameters::get<TypeTag, Properties::CellOrdering>()))
+    { reorder_(gridView); }
+
+    /*!
+     * \brief Map an element to its reordered index.
+     */
+    template <class EntityType>
+    Index index(const EntityType& e) const
+    {
+        static_assert(EntityType::codimension == 0,
+                      "The ReorderingElementMapper can only map elements");
+        return naturalToReordered_[naturalMapper_.index(e)];
+    }
+
+    /*!
+     * \brief Map a sub-entity of an element to its reordered index.
+     *
+     * Since only elements are mapped, the sub-entity must be the element itself.
+     */
+    Index subIndex(const Element& e, int i, unsigned codim) const
+    {
+        assert(codim == 0);
+        return naturalToReordered_[naturalMapper_.subIndex(e, i, codim)];
+    }
+
+    /*!
+     * \brief Returns the number of elements which are mapped.
+     */
+    std::size_t size() const
+    { return naturalMapper_.size(); }
+
+    /*!
+     * \brief Returns true iff the entity is covered by the mapper.
+     */
+    template <class EntityType>
+    bool contains(const EntityType& e, Index& result) const
+    {
+        if (!naturalMapper_.contains(e, result))
+            return false;
+
+        result = naturalToReordered_[result];
+        return true;
+    }
+
+    /*!
+     * \brief Returns true iff the sub-entity of an element is covered by the mapper.
+     */
+    bool contains(const Element& e, int i, int cc, Index& result) const
+    {
+        if (!naturalMapper_.contains(e, i, cc, result))
+            return false;
+
+        result = naturalToReordered_[result];
+        return true;
+    }
+
+    /*!
+     * \brief Recalculate the ordering after the grid has been changed.
+     */
+    void update(const GridView& gridView)
+    {
+        gridView_ = gridView;
+#if DUNE_VERSION_NEWER(DUNE_GRID, 2, 8)
+        naturalMapper_.update(gridView);
+#else
+        naturalMapper_.update();
+#endif
+        reorder_(gridView);
+    }
+
+#if !DUNE_VERSION_NEWER(DUNE_GRID, 2, 8)
+    /*!
+     * \brief Recalculate the ordering after the grid has been changed.
+     *
+     * This is the interface of the mappers of dune-grid before 2.8.
+     */
+    void update()
+    {
+        naturalMapper_.update();
+        reorder_(gridView_);
+    }
+#endif
+
+    /*!
+     * \brief Returns the ordering which is used by the mapper.
+     */
+    CellOrdering ordering() const
+    { return ordering_; }
+
+    /*!
+     * \brief Returns the index of an element in the ordering of the grid given its
+     *        reordered index.
+     */
+    Index naturalIndex(Index reorderedIdx) const
+    { return reorderedToNatural_[reorderedIdx]; }
+
+    /*!
+     * \brief Returns the reordered index of an element given its index in the ordering
+     *        of the grid.
+     */
+    Index reorderedIndex(Index naturalIdx) const
+    { return naturalToReordered_[naturalIdx]; }
+
+private:
+    void reorder_(const GridView& gridView)
+    {
+        const std::size_t numElements = naturalMapper_.size();
+
+        // collect the connectivity graph and the element centroids in natural order
+        std::vector<std::vector<unsigned>> neighbors(numElements);
+        std::vector<GlobalPosition> centroids(numElements);
+        for (const auto& elem : elements(gridView)) {
+            const unsigned elemIdx = naturalMapper_.index(elem);
+            centroids[elemIdx] = elem.geometry().center();
+
+            for (const auto& intersection : intersections(gridView, elem)) {
+                if (intersection.neighbor())
+                    neighbors[elemIdx].push_back(naturalMapper_.index(intersection.outside()));
+            }
+        }
+
+        std::vector<unsigned> order;
+        switch (ordering_) {
+        case CellOrdering::Natural:
+            order.resize(numElements);
+            std::iota(order.begin(), order.end(), 0);
+            break;
+        case CellOrdering::ReverseCuthillMcKee:
+            order = reverseCuthillMcKeeOrder_(neighbors);
+            break;
+        case CellOrdering::Hilbert:
+            order = hilbertOrder_(centroids);
+            break;
+        case CellOrdering::Partition:
+            order = partitionOrder_(centroids);
+            break;
+        }
+        assert(order.size() == numElements);
+
+        reorderedToNatural_.resize(numElements);
+        naturalToReordered_.resize(numElements);
+        for (std::size_t newIdx = 0; newIdx < numElements; ++newIdx) {
+            reorderedToNatural_[newIdx] = order[newIdx];
+            naturalToReordered_[order[newIdx]] = newIdx;
+        }
+    }
+
+    // the reverse Cuthill-McKee ordering: each connected component is traversed in
+    // breadth-first order starting at a pseudo-peripheral element, visiting the
+    // neighbors with low degree first. the resulting order is reversed at the end.
+    static std::vector<unsigned>
+    reverseCuthillMcKeeOrder_(const std::vector<std::vector<unsigned>>& neighbors)
+    {
+        const std::size_t numElements = neighbors.size();
+        const auto degreeLess = [&neighbors](unsigned a, unsigned b)
+        { return neighbors[a].size() < neighbors[b].size(); };
+
+        std::vector<unsigned> byDegree(numElements);
+        std::iota(byDegree.begin(), byDegree.end(), 0);
+        std::stable_sort(byDegree.begin(), byDegree.end(), degreeLess);
+
+        std::vector<unsigned> order;
+        order.reserve(numElements);
+        std::vector<bool> visited(numElements, false);
+        std::vector<int> distance(numElements, -1);
+        std::vector<unsigned> sortedNeighbors;
+        for (unsigned startIdx : byDegree) {
+            if (visited[startIdx])
+                continue;
+
+            const unsigned rootIdx = pseudoPeripheralElement_(startIdx, neighbors, distance);
+            std::size_t headIdx = order.size();
+            order.push_back(rootIdx);
+            visited[rootIdx] = true;
+            for (; headIdx < order.size(); ++headIdx) {
+                sortedNeighbors = neighbors[order[headIdx]];
+                std::stable_sort(sortedNeighbors.begin(), sortedNeighbors.end(), degreeLess);
+                for (unsigned nbIdx : sortedNeighbors) {
+                    if (visited[nbIdx])
+                        continue;
+
+                    visited[nbIdx] = true;
+                    order.push_back(nbIdx);
+                }
+            }
+        }
+
+        std::reverse(order.begin(), order.end());
+        return order;
+    }
+
+    // find an element with a large eccentricity in the connected component of an
+    // element using the heuristic of George and Liu
+    static unsigned pseudoPeripheralElement_(unsigned startIdx,
+                                             const std::vector<std::vector<unsigned>>& neighbors,
+                                             std::vector<int>& distance)
+    {
+        unsigned rootIdx = startIdx;
+        int eccentricity = -1;
+        std::vector<unsigned> queue;
+        for (unsigned sweepIdx = 0; sweepIdx < 8; ++sweepIdx) {
+            queue.assign(1, rootIdx);
+            distance[rootIdx] = 0;
+            for (std::size_t headIdx = 0; headIdx < queue.size(); ++headIdx) {
+                const unsigned curIdx = queue[headIdx];
+                for (unsigned nbIdx : neighbors[curIdx]) {
+                    if (distance[nbIdx] >= 0)
+                        continue;
+
+                    distance[nbIdx] = distance[curIdx] + 1;
+                    queue.push_back(nbIdx);
+                }
+            }
+
+            // the candidate for the next sweep is the element of the last level which
+            // exhibits the smallest degree
+            const int lastLevel = distance[queue.back()];
+            unsigned candidateIdx = queue.back();
+            for (auto it = queue.rbegin(); it != queue.rend() && distance[*it] == lastLevel; ++it)
+                if (neighbors[*it].size() < neighbors[candidateIdx].size())
+                    candidateIdx = *it;
+
+            for (unsigned idx : queue)
+                distance[idx] = -1;
+
+            if (lastLevel <= eccentricity)
+                break;
+
+            eccentricity = lastLevel;
+            rootIdx = candidateIdx;
+        }
+
+        return rootIdx;
+    }
+
+    // sort the elements along a Hilbert curve through their centroids
+    static std::vector<unsigned> hilbertOrder_(const std::vector<GlobalPosition>& centroids)
+    {
+        const std::size_t numElements = centroids.size();
+        constexpr unsigned numBits = std::min(31, 63/dimWorld);
+
+        GlobalPosition lower(std::numeric_limits<CoordScalar>::max());
+        GlobalPosition upper(std::numeric_limits<CoordScalar>::lowest());
+        for (const auto& pos : centroids) {
+            for (unsigned dimIdx = 0; dimIdx < dimWorld; ++dimIdx) {
+                lower[dimIdx] = std::min(lower[dimIdx], pos[dimIdx]);
+                upper[dimIdx] = std::max(upper[dimIdx], pos[dimIdx]);
+            }
+        }
+
+        // use the same scaling for all axes to preserve the aspect ratio of the domain
+        CoordScalar extent = 0.0;
+        for (unsigned dimIdx = 0; dimIdx < dimWorld; ++dimIdx)
+            extent = std::max(extent, upper[dimIdx] - lower[dimIdx]);
+        const CoordScalar maxCoord = static_cast<CoordScalar>((std::uint64_t(1) << numBits) - 1);
+        const CoordScalar scale = (extent > 0.0) ? maxCoord/extent : 0.0;
+
+        std::vector<std::uint64_t> keys(numElements);
+        for (std::size_t elemIdx = 0; elemIdx < numElements; ++elemIdx) {
+            std::array<std::uint32_t, dimWorld> coords;
+            for (unsigned dimIdx = 0; dimIdx < dimWorld; ++dimIdx)
+                coords[dimIdx] = static_cast<std::uint32_t>((centroids[elemIdx][dimIdx] - lower[dimIdx])*scale);
+            keys[elemIdx] = hilbertKey_(coords, numBits);
+        }
+
+        std::vector<unsigned> order(numElements);
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(),
+                         [&keys](unsigned a, unsigned b) { return keys[a] < keys[b]; });
+        return order;
+    }
+
+    // compute the position of a point on the Hilbert curve. This uses the algorithm by
+    // J. Skilling: "Programming the Hilbert curve", AIP Conf. Proc. 707, 2004.
+    static std::uint64_t hilbertKey_(std::array<std::uint32_t, dimWorld> x, unsigned numBits)
+    {
+        const std::uint32_t m = std::uint32_t(1) << (numBits - 1);
+
+        // inverse undo excess work
+        for (std::uint32_t q = m; q > 1; q >>= 1) {
+            const std::uint32_t p = q - 1;
+            for (unsigned i = 0; i < dimWorld; ++i) {
+                if (x[i] & q)
+                    x[0] ^= p;
+                else {
+                    const std::uint32_t t = (x[0] ^ x[i]) & p;
+                    x[0] ^= t;
+                    x[i] ^= t;
+                }
+            }
+        }
+
+        // gray encode
+        for (unsigned i = 1; i < dimWorld; ++i)
+            x[i] ^= x[i - 1];
+        std::uint32_t t = 0;
+        for (std::uint32_t q = m; q > 1; q >>= 1)
+            if (x[dimWorld - 1] & q)
+                t ^= q - 1;
+        for (unsigned i = 0; i < dimWorld; ++i)
+            x[i] ^= t;
+
+        // interleave the bits of the transposed key
+        std::uint64_t key = 0;
+        for (int bitIdx = static_cast<int>(numBits) - 1; bitIdx >= 0; --bitIdx)
+            for (unsigned i = 0; i < dimWorld; ++i)
+                key = (key << 1) | ((x[i] >> bitIdx) & 1);
+
+        return key;
+    }
+
+    // group the elements into compact partitions of at most partitionSize_ elements by
+    // recursively bisecting the set of centroids along its longest axis. within a
+    // partition, the natural order is kept.
+    static std::vector<unsigned> partitionOrder_(const std::vector<GlobalPosition>& centroids)
+    {
+        std::vector<unsigned> order(centroids.size());
+        std::iota(order.begin(), order.end(), 0);
+        bisect_(order.begin(), order.end(), centroids);
+        return order;
+    }
+
+    template <class Iterator>
+    static void bisect_(Iterator begin, Iterator end, const std::vector<GlobalPosition>& centroids)
+    {
+        const std::size_t n = std::distance(begin, end);
+        if (n <= partitionSize_) {
+            std::sort(begin, end);
+            return;
+        }
+
+        GlobalPosition lower(std::numeric_limits<CoordScalar>::max());
+        GlobalPosition upper(std::numeric_limits<CoordScalar>::lowest());
+        for (auto it = begin; it != end; ++it) {
+            for (unsigned dimIdx = 0; dimIdx < dimWorld; ++dimIdx) {
+                lower[dimIdx] = std::min(lower[dimIdx], centroids[*it][dimIdx]);
+                upper[dimIdx] = std::max(upper[dimIdx], centroids[*it][dimIdx]);
+            }
+        }
+
+        unsigned axisIdx = 0;
+        for (unsigned dimIdx = 1; dimIdx < dimWorld; ++dimIdx)
+            if (upper[dimIdx] - lower[dimIdx] > upper[axisIdx] - lower[axisIdx])
+                axisIdx = dimIdx;
+
+        const Iterator mid = begin + n/2;
+        std::nth_element(begin, mid, end,
+                         [&centroids, axisIdx](unsigned a, unsigned b)
+                         { return centroids[a][axisIdx] < centroids[b][axisIdx]; });
+
+        bisect_(begin, mid, centroids);
+        bisect_(mid, end, centroids);
+    }
+
+    GridView gridView_;
+    NaturalMapper naturalMapper_;
+    CellOrdering ordering_;
+
+    std::vector<Index> naturalToReordered_;
+    std::vector<Index> reorderedToNatural_;
+};
+
+/*!
+ * \brief Type trait which specifies whether an element mapper reorders the elements of
+ *        the grid.
+ */
+template <class Mapper>
+struct IsReorderingElementMapper : public std::false_type {};
+
+template <class TypeTag>
+struct IsReorderingElementMapper<ReorderingElementMapper<TypeTag>> : public std::true_type {};
+
+} // namespace Opm
+
+#endif
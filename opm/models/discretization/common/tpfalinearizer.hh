@@ -40,19 +40,33 @@
 #include <opm/input/eclipse/Schedule/BCProp.hpp>
 
 #include <opm/models/discretization/common/baseauxiliarymodule.hh>
+#include <opm/models/parallel/threadedentityiterator.hh>
+#include <opm/models/parallel/threadmanager.hh>
+
+#include <opm/simulators/linalg/cprpressurevaridx.hh>
+#include <opm/simulators/linalg/explicitcellcondenser.hh>
+#include <opm/simulators/linalg/matrixfreetpfaoperator.hh>
+#include <opm/simulators/linalg/sparsitypattern.hh>
 
 #include <dune/common/version.hh>
 #include <dune/common/fvector.hh>
 #include <dune/common/fmatrix.hh>
+#include <dune/grid/common/gridenums.hh>
 
+#include <algorithm>
 #include <type_traits>
 #include <iostream>
 #include <vector>
 #include <thread>
 #include <set>
 #include <exception>   // current_exception, rethrow_exception
+#include <stdexcept>
 #include <mutex>
+#include <limits>
 #include <numeric>
+#include <string>
+#include <tuple>
+#include <utility>
 
 namespace Opm::Properties {
     template<class TypeTag, class MyTypeTag>
@@ -60,6 +74,30 @@ namespace Opm::Properties {
         using type = bool;
         static constexpr type value = false;
     };
+
+    template<class TypeTag, class MyTypeTag>
+    struct LinearizeMatrixFree {
+        using type = bool;
+        static constexpr type value = false;
+    };
+
+    template<class TypeTag, class MyTypeTag>
+    struct EnableAdaptiveImplicit {
+        using type = bool;
+        static constexpr type value = false;
+    };
+
+    template<class TypeTag, class MyTypeTag>
+    struct AdaptiveImplicitCflLimit {
+        using type = double;
+        static constexpr type value = 0.5;
+    };
+
+    template<class TypeTag, class MyTypeTag>
+    struct AdaptiveImplicitVerbose {
+        using type = bool;
+        static constexpr type value = false;
+    };
 }
 
 namespace Opm {
@@ -96,6 +134,8 @@ class TpfaLinearizer
     using Stencil = GetPropType<TypeTag, Properties::Stencil>;
     using LocalResidual = GetPropType<TypeTag, Properties::LocalResidual>;
     using IntensiveQuantities = GetPropType<TypeTag, Properties::IntensiveQuantities>;
+    using ThreadManager = GetPropType<TypeTag, Properties::ThreadManager>;
+    using Indices = GetPropType<TypeTag, Properties::Indices>;
 
     using Element = typename GridView::template Codim<0>::Entity;
     using ElementIterator = typename GridView::template Codim<0>::Iterator;
@@ -105,14 +145,17 @@ class TpfaLinearizer
     enum { numEq = getPropValue<TypeTag, Properties::NumEq>() };
     enum { historySize = getPropValue<TypeTag, Properties::TimeDiscHistorySize>() };
     enum { dimWorld = GridView::dimensionworld };
+    enum { pressureVarIdx = Linear::detail::CprPressureVarIdx<Indices>::value };
 
     using MatrixBlock = typename SparseMatrixAdapter::MatrixBlock;
     using VectorBlock = Dune::FieldVector<Scalar, numEq>;
+    using MatrixFreeOperator = Linear::MatrixFreeTpfaOperator<MatrixBlock, GlobalEqVector>;
     using ADVectorBlock = GetPropType<TypeTag, Properties::RateVector>;
 
     static const bool linearizeNonLocalElements = getPropValue<TypeTag, Properties::LinearizeNonLocalElements>();
     static const bool enableEnergy = getPropValue<TypeTag, Properties::EnableEnergy>();
     static const bool enableDiffusion = getPropValue<TypeTag, Properties::EnableDiffusion>();
+    static const bool enableDispersionModule = getPropValue<TypeTag, Properties::EnableDispersion>();
     // copying the linearizer is not a good idea
     TpfaLinearizer(const TpfaLinearizer&);
 //! \endcond
@@ -123,6 +166,10 @@ public:
     {
         simulatorPtr_ = 0;
         separateSparseSourceTerms_ = Parameters::get<TypeTag, Properties::SeparateSparseSourceTerms>();
+        matrixFree_ = Parameters::get<TypeTag, Properties::LinearizeMatrixFree>();
+        adaptiveImplicit_ = Parameters::get<TypeTag, Properties::EnableAdaptiveImplicit>();
+        aimCflLimit_ = Parameters::get<TypeTag, Properties::AdaptiveImplicitCflLimit>();
+        aimVerbose_ = Parameters::get<TypeTag, Properties::AdaptiveImplicitVerbose>();
     }
 
     ~TpfaLinearizer()
@@ -136,6 +183,18 @@ public:
     {
         Parameters::registerParam<TypeTag, Properties::SeparateSparseSourceTerms>
             ("Treat well source terms all in one go, instead of on a cell by cell basis.");
+        Parameters::registerParam<TypeTag, Properties::LinearizeMatrixFree>
+            ("Store the derivatives of the faces for a matrix-free Jacobian operator "
+             "instead of assembling the Jacobian matrix.");
+        Parameters::registerParam<TypeTag, Properties::EnableAdaptiveImplicit>
+            ("Treat the non-pressure primary variables of cells with a small CFL number "
+             "explicitly and condense them out of the linear system.");
+        Parameters::registerParam<TypeTag, Properties::AdaptiveImplicitCflLimit>
+            ("The CFL number below which a cell is treated explicitly by the adaptive "
+             "implicit mode.");
+        Parameters::registerParam<TypeTag, Properties::AdaptiveImplicitVerbose>
+            ("Print the number of explicit cells of the adaptive implicit mode in each "
+             "Newton iteration.");
     }
 
     /*!
@@ -249,7 +308,15 @@ public:
     }
 
     void finalize()
-    { jacobian_->finalize(); }
+    {
+        // the linear solver constructs the preconditioner from the Jacobian matrix,
+        // so it gets the diagonal blocks of the matrix-free operator
+        if (matrixFree_)
+            copyDiagonalToJacobian_();
+        jacobian_->finalize();
+        if (adaptiveImplicit_)
+            condenseExplicitCells_();
+    }
 
     /*!
      * \brief Linearize the part of the non-linear system of equations that is associated
@@ -292,6 +359,59 @@ public:
     SparseMatrixAdapter& jacobian()
     { return *jacobian_; }
 
+    /*!
+     * \brief Return the matrix-free Jacobian operator.
+     *
+     * This is only filled if the LinearizeMatrixFree parameter is true. In this
+     * case, the Jacobian matrix returned by jacobian() only contains the diagonal
+     * blocks, which are copied from the operator by finalize(). The linear solver
+     * backends which are derived from ParallelBaseBackend apply this operator instead
+     * of the matrix and use the matrix for the preconditioner.
+     */
+    const MatrixFreeOperator& matrixFreeOperator() const
+    { return matrixFreeOperator_; }
+
+    /*!
+     * \brief Returns true if the Jacobian is linearized into the matrix-free
+     *        operator instead of the Jacobian matrix.
+     */
+    bool isMatrixFree() const
+    { return matrixFree_; }
+
+    /*!
+     * \brief Returns true if the non-pressure primary variables of a cell are
+     *        treated explicitly by the adaptive implicit mode.
+     */
+    bool isExplicitCell(unsigned globI) const
+    { return adaptiveImplicit_ && isExplicit_[globI]; }
+
+    /*!
+     * \brief Returns true if finalize() condenses unknowns out of the linear system.
+     *
+     * The data which is required to recover these unknowns belongs to the current
+     * Jacobian matrix, so the matrix of a previous iteration must not be reused.
+     */
+    bool hasCondensedUnknowns() const
+    { return adaptiveImplicit_; }
+
+    /*!
+     * \brief Recover the update of the primary variables which have been condensed
+     *        out of the linear system by the adaptive implicit mode.
+     *
+     * The linear solver only determines the pressure update of the explicit cells
+     * correctly. Since the derivatives of the explicit cells' equations are kept
+     * by finalize(), the update of their remaining primary variables follows from
+     * the updates of their neighbors.
+     */
+    void expandSolutionUpdate(GlobalEqVector& solutionUpdate) const
+    {
+        if (!adaptiveImplicit_ || condenser_.numExplicitCells() == 0)
+            return;
+
+        OPM_TIMEBLOCK(expandSolutionUpdate);
+        condenser_.expand(solutionUpdate);
+    }
+
     /*!
      * \brief Return constant reference to global residual vector.
      */
@@ -378,7 +498,10 @@ public:
         }
         for (int globI : domain.cells) {
             residual_[globI] = 0.0;
-            jacobian_->clearRow(globI, 0.0);
+            if (matrixFree_)
+                matrixFreeOperator_.clearRow(globI);
+            else
+                jacobian_->clearRow(globI, 0.0);
         }
     }
 
@@ -424,71 +547,78 @@ private:
             return;
         }
         const auto& model = model_();
-        Stencil stencil(gridView_(), model_().dofMapper());
+        const auto& problem = problem_();
+
+        // quantities which do not depend on the cell or the face
+        const Scalar gravity = problem.gravity()[dimWorld - 1];
+        const bool enableDispersion =
+            simulator_().vanguard().eclState().getSimulationConfig().rock_config().dispersion();
+        const bool nonTrivialBoundaryConditions = problem.nonTrivialBoundaryConditions();
 
         // for the main model, find out the global indices of the neighboring degrees of
-        // freedom of each primary degree of freedom
-        using NeighborSet = std::set< unsigned >;
-        std::vector<NeighborSet> sparsityPattern(model.numTotalDof());
-        const Scalar gravity = problem_().gravity()[dimWorld - 1];
+        // freedom of each primary degree of freedom. the rows are first collected by
+        // each thread and then copied into neighborInfo_.
         unsigned numCells = model.numTotalDof();
-        neighborInfo_.reserve(numCells, 6 * numCells);
-        std::vector<NeighborInfo> loc_nbinfo;
-        for (const auto& elem : elements(gridView_())) {
-            stencil.update(elem);
-
+        std::vector<ThreadRows_<NeighborInfo>> nbInfoRows;
+        std::vector<std::vector<BoundaryInfo>> threadBoundaryInfo;
+        // only the cells in the interior of the process' partition may be treated
+        // explicitly, the stencils of the others are incomplete
+        if (adaptiveImplicit_) {
+            isExplicit_.assign(numCells, 0);
+            canBeExplicit_.assign(numCells, 0);
+        }
+        forEachStencil_([&](const Stencil& stencil, unsigned threadId) {
+            auto& rows = nbInfoRows[threadId];
             for (unsigned primaryDofIdx = 0; primaryDofIdx < stencil.numPrimaryDof(); ++primaryDofIdx) {
                 unsigned myIdx = stencil.globalSpaceIndex(primaryDofIdx);
-                loc_nbinfo.resize(stencil.numDof() - 1); // Do not include the primary dof in neighborInfo_
-
-                for (unsigned dofIdx = 0; dofIdx < stencil.numDof(); ++dofIdx) {
+                const Scalar zIn = problem.dofCenterDepth(myIdx);
+                if (adaptiveImplicit_)
+                    canBeExplicit_[myIdx] =
+                        stencil.element(primaryDofIdx).partitionType() == Dune::InteriorEntity;
+
+                // Do not include the primary dof in neighborInfo_
+                rows.beginRow(myIdx);
+                for (unsigned dofIdx = 1; dofIdx < stencil.numDof(); ++dofIdx) {
                     unsigned neighborIdx = stencil.globalSpaceIndex(dofIdx);
-                    sparsityPattern[myIdx].insert(neighborIdx);
-                    if (dofIdx > 0) {
-                        const Scalar trans = problem_().transmissibility(myIdx, neighborIdx);
-                        const auto scvfIdx = dofIdx - 1;
-                        const auto& scvf = stencil.interiorFace(scvfIdx);
-                        const Scalar area = scvf.area();
-                        const Scalar Vin = problem_().model().dofTotalVolume(myIdx);
-                        const Scalar Vex = problem_().model().dofTotalVolume(neighborIdx);
-                        const Scalar zIn = problem_().dofCenterDepth(myIdx);
-                        const Scalar zEx = problem_().dofCenterDepth(neighborIdx);
-                        const Scalar dZg = (zIn - zEx)*gravity;
-                        const Scalar thpres = problem_().thresholdPressure(myIdx, neighborIdx);
-                        Scalar inAlpha {0.};
-                        Scalar outAlpha {0.};
-                        Scalar diffusivity {0.};
-                        Scalar dispersivity {0.};
-                        if constexpr(enableEnergy){
-                            inAlpha = problem_().thermalHalfTransmissibility(myIdx, neighborIdx);
-                            outAlpha = problem_().thermalHalfTransmissibility(neighborIdx, myIdx);
-                        }
-                        if constexpr(enableDiffusion){
-                            diffusivity = problem_().diffusivity(myIdx, neighborIdx);
-                        }
-                        if (simulator_().vanguard().eclState().getSimulationConfig().rock_config().dispersion()) {
-                            dispersivity = problem_().dispersivity(myIdx, neighborIdx);
-                        }
-                        auto dirId = scvf.dirId();
-                        loc_nbinfo[dofIdx - 1] = NeighborInfo{neighborIdx, {trans, area, thpres, dZg, dirId, Vin, Vex, inAlpha, outAlpha, diffusivity, dispersivity}, nullptr};
-
+                    const auto scvfIdx = dofIdx - 1;
+                    const auto& scvf = stencil.interiorFace(scvfIdx);
+                    const Scalar zEx = problem.dofCenterDepth(neighborIdx);
+
+                    NeighborInfo nbInfo;
+                    nbInfo.trans = problem.transmissibility(myIdx, neighborIdx);
+                    nbInfo.faceArea = scvf.area();
+                    nbInfo.thpres = problem.thresholdPressure(myIdx, neighborIdx);
+                    nbInfo.dZg = (zIn - zEx)*gravity;
+                    nbInfo.neighbor = neighborIdx;
+                    nbInfo.matBlockOffset = 0;
+                    nbInfo.dirId = scvf.dirId();
+                    if constexpr(enableEnergy){
+                        nbInfo.inAlpha = problem.thermalHalfTransmissibility(myIdx, neighborIdx);
+                        nbInfo.outAlpha = problem.thermalHalfTransmissibility(neighborIdx, myIdx);
+                    }
+                    if constexpr(enableDiffusion){
+                        nbInfo.diffusivity = problem.diffusivity(myIdx, neighborIdx);
+                    }
+                    if constexpr(enableDispersionModule){
+                        nbInfo.dispersivity = enableDispersion ? problem.dispersivity(myIdx, neighborIdx) : 0.0;
                     }
+                    rows.data.push_back(nbInfo);
                 }
-                neighborInfo_.appendRow(loc_nbinfo.begin(), loc_nbinfo.end());
-                if (problem_().nonTrivialBoundaryConditions()) {
+
+                if (nonTrivialBoundaryConditions) {
                     for (unsigned bfIndex = 0; bfIndex < stencil.numBoundaryFaces(); ++bfIndex) {
                         const auto& bf = stencil.boundaryFace(bfIndex);
                         const int dir_id = bf.dirId();
                         // not for NNCs
                         if (dir_id < 0)
                             continue;
-                        const auto [type, massrateAD] = problem_().boundaryCondition(myIdx, dir_id);
+                        const auto [type, massrateAD] = problem.boundaryCondition(myIdx, dir_id);
                         // Strip the unnecessary (and zero anyway) derivatives off massrate.
                         VectorBlock massrate(0.0);
                         for (size_t ii = 0; ii < massrate.size(); ++ii) {
                             massrate[ii] = massrateAD[ii].value();
                         }
-                        const auto& exFluidState = problem_().boundaryFluidState(myIdx, dir_id);
+                        const auto& exFluidState = problem.boundaryFluidState(myIdx, dir_id);
                         BoundaryConditionData bcdata{type,
                                                      massrate,
                                                      exFluidState.pvtRegionIndex(),
@@ -496,28 +626,103 @@ private:
                                                      bf.area(),
                                                      bf.integrationPos()[dimWorld - 1],
                                                      exFluidState};
-                        boundaryInfo_.push_back({myIdx, dir_id, bfIndex, bcdata});
+                        threadBoundaryInfo[threadId].push_back({myIdx, dir_id, bfIndex, bcdata});
                     }
                 }
             }
+        }, [&](unsigned numThreads) {
+            nbInfoRows.resize(numThreads);
+            threadBoundaryInfo.resize(numThreads);
+        });
+
+        assembleSparseTable_(neighborInfo_, nbInfoRows, model.numGridDof());
+
+        // keep the boundary faces in the order of the cells
+        boundaryInfo_.clear();
+        for (const auto& bi : threadBoundaryInfo)
+            boundaryInfo_.insert(boundaryInfo_.end(), bi.begin(), bi.end());
+        std::stable_sort(boundaryInfo_.begin(), boundaryInfo_.end(),
+                         [](const BoundaryInfo& a, const BoundaryInfo& b)
+                         { return a.cell < b.cell; });
+
+        // the sparsity pattern of each row consists of the cell itself and the
+        // neighbors which have been recorded in neighborInfo_ above. since the rows
+        // are independent, the pattern can be built in parallel.
+        // if the linearization is matrix-free, the matrix only gets its diagonal
+        // since the derivatives are stored by the matrix-free operator.
+        assert(neighborInfo_.size() == numCells);
+        Linear::SparsityPattern sparsityPattern(numCells);
+        const long numRows = static_cast<long>(numCells);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (long globI = 0; globI < numRows; ++globI)
+            sparsityPattern.addRowSize(globI, matrixFree_ ? 1 : neighborInfo_.rowSize(globI) + 1);
+        sparsityPattern.endRowSizes();
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (long globI = 0; globI < numRows; ++globI) {
+            sparsityPattern.addIndex(globI, globI);
+            if (matrixFree_)
+                continue;
+            for (const auto& nbInfo : neighborInfo_[globI])
+                sparsityPattern.addIndex(globI, nbInfo.neighbor);
         }
+        sparsityPattern.endIndices();
 
         // add the additional neighbors and degrees of freedom caused by the auxiliary
         // equations
         size_t numAuxMod = model.numAuxiliaryModules();
-        for (unsigned auxModIdx = 0; auxModIdx < numAuxMod; ++auxModIdx)
-            model.auxiliaryModule(auxModIdx)->addNeighbors(sparsityPattern);
+        if (numAuxMod > 0 && matrixFree_)
+            OPM_THROW(std::logic_error, "Matrix-free linearization is not supported for models "
+                                        "with auxiliary equations");
+        // the operator is not aware of the overlap of the linear solver
+        if (matrixFree_ && simulator_().gridView().comm().size() > 1)
+            OPM_THROW(std::logic_error, "Matrix-free linearization is only supported "
+                                        "for sequential runs");
+        if (adaptiveImplicit_ && (matrixFree_ || separateSparseSourceTerms_ || numAuxMod > 0))
+            OPM_THROW(std::logic_error, "The adaptive implicit mode is not supported for matrix-free "
+                                        "linearization, separate sparse source terms or models with "
+                                        "auxiliary equations");
+        if (numAuxMod > 0) {
+            std::vector<std::set<unsigned>> auxNeighbors(numCells);
+            for (unsigned auxModIdx = 0; auxModIdx < numAuxMod; ++auxModIdx)
+                model.auxiliaryModule(auxModIdx)->addNeighbors(auxNeighbors);
+            sparsityPattern.merge(auxNeighbors);
+        }
 
         // allocate raw matrix
         jacobian_.reset(new SparseMatrixAdapter(simulator_()));
         diagMatAddress_.resize(numCells);
         // create matrix structure based on sparsity pattern
         jacobian_->reserve(sparsityPattern);
+
+        if (matrixFree_) {
+            createMatrixFreeOperator_(numCells);
+            fullDomain_.cells.resize(numCells);
+            std::iota(fullDomain_.cells.begin(), fullDomain_.cells.end(), 0);
+            return;
+        }
+
+        // the off-diagonal blocks are addressed by their offset from the first block
+        // of the matrix, which is the first block of the first row. the offsets are
+        // stored using 32 bits.
+        if (sparsityPattern.numNonZeros() > std::numeric_limits<unsigned>::max())
+            OPM_THROW(std::runtime_error, "The Jacobian has " + std::to_string(sparsityPattern.numNonZeros())
+                                          + " non-zero blocks which cannot be addressed by the 32-bit "
+                                          "offsets of the TPFA linearizer");
+        blockBase_ = jacobian_->blockAddress(0, *sparsityPattern.rowBegin(0));
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
         for (unsigned globI = 0; globI < numCells; globI++) {
             const auto& nbInfos = neighborInfo_[globI];
             diagMatAddress_[globI] = jacobian_->blockAddress(globI, globI);
             for (auto& nbInfo : nbInfos) {
-                nbInfo.matBlockAddress = jacobian_->blockAddress(nbInfo.neighbor, globI);
+                const auto offset = jacobian_->blockAddress(nbInfo.neighbor, globI) - blockBase_;
+                assert(0 <= offset && static_cast<size_t>(offset) < sparsityPattern.numNonZeros());
+                nbInfo.matBlockOffset = static_cast<unsigned>(offset);
             }
         }
 
@@ -526,12 +731,60 @@ private:
         std::iota(fullDomain_.cells.begin(), fullDomain_.cells.end(), 0);
     }
 
+    // Allocate the blocks of the matrix-free operator in the order of the faces of
+    // neighborInfo_. The derivatives of the flux over a face of cell i with regard to
+    // the variables of cell i belong to the row of its neighbor j, so each face
+    // stores the position of the opposite face (j, i).
+    void createMatrixFreeOperator_(unsigned numCells)
+    {
+        assert(neighborInfo_.size() == numCells);
+        std::vector<unsigned> rowSizes(numCells, 0);
+        for (unsigned globI = 0; globI < numCells; ++globI)
+            rowSizes[globI] = neighborInfo_.rowSize(globI);
+        matrixFreeOperator_.reserve(rowSizes.begin(), rowSizes.end());
+
+        diagMatAddress_.resize(numCells);
+        blockBase_ = matrixFreeOperator_.numFaces() > 0 ? &matrixFreeOperator_.offDiagonal(0) : nullptr;
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (unsigned globI = 0; globI < numCells; globI++) {
+            diagMatAddress_[globI] = &matrixFreeOperator_.diagonal(globI);
+            unsigned faceIdx = matrixFreeOperator_.rowBegin(globI);
+            for (auto& nbInfo : neighborInfo_[globI]) {
+                matrixFreeOperator_.setNeighbor(faceIdx++, nbInfo.neighbor);
+
+                const unsigned globJ = nbInfo.neighbor;
+                unsigned oppositeIdx = matrixFreeOperator_.rowBegin(globJ);
+                for (const auto& nbInfoJ : neighborInfo_[globJ]) {
+                    if (nbInfoJ.neighbor == globI)
+                        break;
+                    ++oppositeIdx;
+                }
+                assert(oppositeIdx < matrixFreeOperator_.rowEnd(globJ));
+                nbInfo.matBlockOffset = oppositeIdx;
+            }
+        }
+    }
+
+    void copyDiagonalToJacobian_()
+    {
+        const long numCells = static_cast<long>(diagMatAddress_.size());
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (long globI = 0; globI < numCells; ++globI)
+            *jacobian_->blockAddress(globI, globI) = matrixFreeOperator_.diagonal(globI);
+    }
+
     // reset the global linear system of equations.
     void resetSystem_()
     {
         residual_ = 0.0;
         // zero all matrix entries
         jacobian_->clear();
+        if (matrixFree_)
+            matrixFreeOperator_.clear();
     }
 
     // Initialize the flows, flores, and velocity sparse tables
@@ -548,79 +801,152 @@ private:
             return;
         }
         const auto& model = model_();
+        const auto& vanguard = simulator_().vanguard();
         const auto& nncOutput = simulator_().problem().eclWriter()->getOutputNnc();
-        Stencil stencil(gridView_(), model_().dofMapper());
-        unsigned numCells = model.numTotalDof();
-        std::unordered_multimap<int, std::pair<int, int>> nncIndices;
-        std::vector<FlowInfo> loc_flinfo;
-        std::vector<VelocityInfo> loc_vlinfo;
-        unsigned int nncId = 0;
         VectorBlock flow(0.0);
 
-        // Create a nnc structure to use fast lookup
+        // Sort the NNCs by the cartesian indices of the cells they connect, so that the
+        // NNC of a face can be found by a binary search. For duplicate connections, the
+        // one which was specified last takes precedence.
+        using NncKey = std::tuple<int, int, unsigned>;
+        std::vector<NncKey> nncIndices;
+        nncIndices.reserve(nncOutput.size());
         for (unsigned int nncIdx = 0; nncIdx < nncOutput.size(); ++nncIdx) {
-            const int ci1 = nncOutput[nncIdx].cell1;
-            const int ci2 = nncOutput[nncIdx].cell2;
-            nncIndices.emplace(ci1, std::make_pair(ci2, nncIdx));
-        }
-
-        if (anyFlows) {
-            flowsInfo_.reserve(numCells, 6 * numCells);
-        }
-        if (anyFlores) {
-            floresInfo_.reserve(numCells, 6 * numCells);
-        }
-        if (enableDispersion) {
-            velocityInfo_.reserve(numCells, 6 * numCells);
+            nncIndices.emplace_back(nncOutput[nncIdx].cell1, nncOutput[nncIdx].cell2, nncIdx);
         }
+        std::sort(nncIndices.begin(), nncIndices.end());
 
-        for (const auto& elem : elements(gridView_())) {
-            stencil.update(elem);
+        std::vector<ThreadRows_<FlowInfo>> flowRows;
+        std::vector<ThreadRows_<VelocityInfo>> velocityRows;
+        forEachStencil_([&](const Stencil& stencil, unsigned threadId) {
+            auto& flRows = flowRows[threadId];
+            auto& vlRows = velocityRows[threadId];
             for (unsigned primaryDofIdx = 0; primaryDofIdx < stencil.numPrimaryDof(); ++primaryDofIdx) {
                 unsigned myIdx = stencil.globalSpaceIndex(primaryDofIdx);
-                int numFaces = stencil.numBoundaryFaces() + stencil.numInteriorFaces();
-                loc_flinfo.resize(numFaces);
-                loc_vlinfo.resize(stencil.numDof() - 1);
+                const int cartMyIdx = vanguard.cartesianIndex(myIdx);
+                flRows.beginRow(myIdx);
+                vlRows.beginRow(myIdx);
 
-                for (unsigned dofIdx = 0; dofIdx < stencil.numDof(); ++dofIdx) {
+                for (unsigned dofIdx = 1; dofIdx < stencil.numDof(); ++dofIdx) {
                     unsigned neighborIdx = stencil.globalSpaceIndex(dofIdx);
-                    if (dofIdx > 0) {
-                        const auto scvfIdx = dofIdx - 1;
-                        const auto& scvf = stencil.interiorFace(scvfIdx);
-                        int faceId = scvf.dirId();
-                        const int cartMyIdx = simulator_().vanguard().cartesianIndex(myIdx);
-                        const int cartNeighborIdx = simulator_().vanguard().cartesianIndex(neighborIdx);
-                        const auto& range = nncIndices.equal_range(cartMyIdx);
-                        for (auto it = range.first; it != range.second; ++it) {
-                            if (it->second.first == cartNeighborIdx){
+                    const auto scvfIdx = dofIdx - 1;
+                    const auto& scvf = stencil.interiorFace(scvfIdx);
+                    int faceId = scvf.dirId();
+                    unsigned int nncId = 0;
+                    if (!nncIndices.empty()) {
+                        const int cartNeighborIdx = vanguard.cartesianIndex(neighborIdx);
+                        const NncKey key{cartMyIdx, cartNeighborIdx, std::numeric_limits<unsigned>::max()};
+                        auto it = std::upper_bound(nncIndices.begin(), nncIndices.end(), key);
+                        if (it != nncIndices.begin()) {
+                            --it;
+                            if (std::get<0>(*it) == cartMyIdx && std::get<1>(*it) == cartNeighborIdx) {
                                 // -1 gives problem since is used for the nncInput from the deck
                                 faceId = -2;
                                 // the index is stored to be used for writting the outputs
-                                nncId = it->second.second;
+                                nncId = std::get<2>(*it);
                             }
                         }
-                        loc_flinfo[dofIdx - 1] = FlowInfo{faceId, flow, nncId};
-                        loc_vlinfo[dofIdx - 1] = VelocityInfo{flow};
                     }
-                } 
+                    flRows.data.push_back(FlowInfo{faceId, flow, nncId});
+                    vlRows.data.push_back(VelocityInfo{flow});
+                }
 
                 for (unsigned bdfIdx = 0; bdfIdx < stencil.numBoundaryFaces(); ++bdfIdx) {
                     const auto& scvf = stencil.boundaryFace(bdfIdx);
                     int faceId = scvf.dirId();
-                    loc_flinfo[stencil.numInteriorFaces() + bdfIdx] = FlowInfo{faceId, flow, nncId};
+                    flRows.data.push_back(FlowInfo{faceId, flow, 0});
                 }
+            }
+        }, [&](unsigned numThreads) {
+            flowRows.resize(numThreads);
+            velocityRows.resize(numThreads);
+        });
 
+        const size_t numRows = model.numGridDof();
+        if (anyFlows) {
+            assembleSparseTable_(flowsInfo_, flowRows, numRows);
+        }
+        if (anyFlores) {
+            assembleSparseTable_(floresInfo_, flowRows, numRows);
+        }
+        if (enableDispersion) {
+            assembleSparseTable_(velocityInfo_, velocityRows, numRows);
+        }
+    }
 
-                if (anyFlows) {
-                    flowsInfo_.appendRow(loc_flinfo.begin(), loc_flinfo.end());
-                }
-                if (anyFlores) {
-                    floresInfo_.appendRow(loc_flinfo.begin(), loc_flinfo.end());
-                }
-                if (enableDispersion) {
-                    velocityInfo_.appendRow(loc_vlinfo.begin(), loc_vlinfo.end());
+    // The rows of a sparse table which have been computed by a single thread.
+    template <class T>
+    struct ThreadRows_
+    {
+        void beginRow(unsigned rowIdx)
+        { rows.emplace_back(rowIdx, data.size()); }
+
+        std::vector<std::pair<unsigned, size_t>> rows; // (row index, offset in data)
+        std::vector<T> data;
+    };
+
+    // Call fn(stencil, threadId) for the stencil of each element of the grid in
+    // parallel. Before the threads start, init(numThreads) is called.
+    template <class Fn, class InitFn>
+    void forEachStencil_(Fn&& fn, InitFn&& init)
+    {
+        std::mutex exceptionLock;
+        std::exception_ptr exceptionPtr = nullptr;
+
+        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(gridView_());
+        init(ThreadManager::maxThreads());
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            const unsigned threadId = ThreadManager::threadId();
+            Stencil stencil(gridView_(), model_().dofMapper());
+            ElementIterator elemIt = threadedElemIt.beginParallel();
+            try {
+                for (; !threadedElemIt.isFinished(elemIt); elemIt = threadedElemIt.increment()) {
+                    stencil.update(*elemIt);
+                    fn(static_cast<const Stencil&>(stencil), threadId);
                 }
             }
+            catch (...) {
+                std::lock_guard<std::mutex> take(exceptionLock);
+                exceptionPtr = std::current_exception();
+                threadedElemIt.setFinished();
+            }
+        }
+
+        if (exceptionPtr)
+            std::rethrow_exception(exceptionPtr);
+    }
+
+    // Size the rows of a sparse table and copy the rows which were computed by the
+    // individual threads into it.
+    template <class T>
+    static void assembleSparseTable_(SparseTable<T>& table,
+                                     const std::vector<ThreadRows_<T>>& threadRows,
+                                     size_t numRows)
+    {
+        std::vector<int> rowSizes(numRows, 0);
+        for (const auto& tr : threadRows) {
+            for (size_t i = 0; i < tr.rows.size(); ++i) {
+                const size_t end = (i + 1 < tr.rows.size()) ? tr.rows[i + 1].second : tr.data.size();
+                rowSizes[tr.rows[i].first] = static_cast<int>(end - tr.rows[i].second);
+            }
+        }
+        table.allocate(rowSizes.begin(), rowSizes.end());
+
+        const int numThreadRows = static_cast<int>(threadRows.size());
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (int t = 0; t < numThreadRows; ++t) {
+            const auto& tr = threadRows[t];
+            for (const auto& [rowIdx, offset] : tr.rows) {
+                auto row = table[rowIdx];
+                std::copy(tr.data.begin() + offset,
+                          tr.data.begin() + offset + rowSizes[rowIdx],
+                          row.begin());
+            }
         }
     }
 
@@ -671,8 +997,8 @@ public:
                 adres = 0.0;
                 darcyFlux = 0.0;
                 const IntensiveQuantities& intQuantsEx = model_().intensiveQuantities(globJ, /*timeIdx*/ 0);
-                LocalResidual::computeFlux(adres,darcyFlux, globI, globJ, intQuantsIn, intQuantsEx, nbInfo.res_nbinfo);
-                adres *= nbInfo.res_nbinfo.faceArea;
+                LocalResidual::computeFlux(adres,darcyFlux, globI, globJ, intQuantsIn, intQuantsEx, residualNBInfo_(globI, nbInfo));
+                adres *= nbInfo.faceArea;
                 if (enableFlows) {
                     for (unsigned eqIdx = 0; eqIdx < numEq; ++ eqIdx) {
                         flowsInfo_[globI][loc].flow[eqIdx] = adres[eqIdx].value();
@@ -709,6 +1035,59 @@ public:
         }
     }
 
+    /*!
+     * \brief Evaluate the residual of a single cell and its derivatives with regard
+     *        to the primary variables of the cell.
+     *
+     * Unlike linearizeDomain(), this neither modifies the global residual nor the
+     * Jacobian matrix, so it may be called for different cells concurrently. The
+     * intensive quantities of the cell and its neighbors are given by
+     * intQuants(globalIdx). For each face, faceFn(neighborIdx, flux, fluxDeriv) is
+     * called with the flux out of the cell and its derivatives with regard to the
+     * primary variables of the cell. The derivatives of the neighbor's residual with
+     * regard to the cell's primary variables are the negative of the latter.
+     *
+     * The cell is evaluated in the same way as by linearizeDomain(). This is not
+     * possible if the sparse source terms are evaluated separately.
+     */
+    template <class IntQuantsFn, class FaceFn>
+    void linearizeCell(unsigned globI,
+                       const IntQuantsFn& intQuants,
+                       VectorBlock& res,
+                       MatrixBlock& diag,
+                       FaceFn&& faceFn)
+    {
+        // the sparse source terms are added to the global residual by the well
+        // model, so they cannot be evaluated for a single cell
+        if (separateSparseSourceTerms_)
+            OPM_THROW(std::logic_error,
+                      "Linearizing single cells is not supported with separate sparse source terms");
+
+        VectorBlock source;
+        linearizeCellTerms_(globI, intQuants, res, diag, source,
+                            [&faceFn](unsigned, const NeighborInfo& nbInfo,
+                                      const VectorBlock& flux, const MatrixBlock& fluxDeriv,
+                                      const ADVectorBlock&)
+                            { faceFn(nbInfo.neighbor, flux, fluxDeriv); },
+                            [this, globI](const VectorBlock&)
+                            { return oldStorage_(globI); });
+
+        // Boundary terms. boundaryInfo_ is sorted by cell.
+        auto bdyIt = std::lower_bound(boundaryInfo_.begin(), boundaryInfo_.end(), globI,
+                                      [](const BoundaryInfo& bi, unsigned cell)
+                                      { return bi.cell < cell; });
+        for (; bdyIt != boundaryInfo_.end() && bdyIt->cell == globI; ++bdyIt) {
+            if (bdyIt->bcdata.type == BCType::NONE)
+                continue;
+
+            VectorBlock r;
+            MatrixBlock bMat;
+            computeBoundaryTerm_(*bdyIt, intQuants(globI), r, bMat);
+            res += r;
+            diag += bMat;
+        }
+    }
+
 private:
     template <class SubDomainType>
     void linearize_(const SubDomainType& domain)
@@ -731,117 +1110,95 @@ private:
         const unsigned int numCells = domain.cells.size();
         const bool on_full_domain = (numCells == model_().numTotalDof());
 
+        // the adaptive implicit mode classifies the cells when the full domain is
+        // linearized. at the beginning of a time step, all cells are classified from
+        // scratch, later Newton iterations only switch explicit cells to implicit.
+        const bool classifyCells = adaptiveImplicit_ && on_full_domain;
+        const bool isFirstIteration = model_().newtonMethod().numIterations() == 0;
+        const double dt = simulator_().timeStepSize();
+        const auto intQuants = [this](unsigned globalIdx) -> const IntensiveQuantities&
+        { return model_().intensiveQuantities(globalIdx, /*timeIdx*/ 0); };
+
 #ifdef _OPENMP
 #pragma omp parallel for
 #endif
         for (unsigned ii = 0; ii < numCells; ++ii) {
             OPM_TIMEBLOCK_LOCAL(linearizationForEachCell);
             const unsigned globI = domain.cells[ii];
-            const auto& nbInfos = neighborInfo_[globI];
-            VectorBlock res(0.0);
-            MatrixBlock bMat(0.0);
-            ADVectorBlock adres(0.0);
-            ADVectorBlock darcyFlux(0.0);
-            const IntensiveQuantities& intQuantsIn = model_().intensiveQuantities(globI, /*timeIdx*/ 0);
-
-            // Flux term.
+            VectorBlock res;
+            MatrixBlock diag;
+            VectorBlock source;
+            VectorBlock outflow(0.0);
+            VectorBlock storage(0.0);
+
+            const auto faceFn = [&](unsigned loc, const NeighborInfo& nbInfo,
+                                    const VectorBlock& flux, const MatrixBlock& fluxDeriv,
+                                    const ADVectorBlock& darcyFlux)
             {
-            OPM_TIMEBLOCK_LOCAL(fluxCalculationForEachCell);
-            short loc = 0;
-            for (const auto& nbInfo : nbInfos) {
-                OPM_TIMEBLOCK_LOCAL(fluxCalculationForEachFace);
-                unsigned globJ = nbInfo.neighbor;
-                assert(globJ != globI);
-                res = 0.0;
-                bMat = 0.0;
-                adres = 0.0;
-                darcyFlux = 0.0;
-                const IntensiveQuantities& intQuantsEx = model_().intensiveQuantities(globJ, /*timeIdx*/ 0);
-                LocalResidual::computeFlux(adres,darcyFlux, globI, globJ, intQuantsIn, intQuantsEx, nbInfo.res_nbinfo);
-                adres *= nbInfo.res_nbinfo.faceArea;
                 if (enableDispersion) {
                     for (unsigned phaseIdx = 0; phaseIdx < numEq; ++ phaseIdx) {
-                        velocityInfo_[globI][loc].velocity[phaseIdx] = darcyFlux[phaseIdx].value() / nbInfo.res_nbinfo.faceArea;
+                        velocityInfo_[globI][loc].velocity[phaseIdx] = darcyFlux[phaseIdx].value() / nbInfo.faceArea;
                     }
                 }
-                setResAndJacobi(res, bMat, adres);
-                residual_[globI] += res;
-                //SparseAdapter syntax:  jacobian_->addToBlock(globI, globI, bMat);
-                *diagMatAddress_[globI] += bMat;
-                bMat *= -1.0;
-                //SparseAdapter syntax: jacobian_->addToBlock(globJ, globI, bMat);
-                *nbInfo.matBlockAddress += bMat;
-                ++loc;
-            }
-            }
+                if (classifyCells) {
+                    for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                        outflow[eqIdx] += std::max(flux[eqIdx], Scalar(0.0));
+                }
+                //SparseAdapter syntax: jacobian_->addToBlock(globJ, globI, -fluxDeriv);
+                blockBase_[nbInfo.matBlockOffset] -= fluxDeriv;
+            };
 
-            // Accumulation term.
-            double dt = simulator_().timeStepSize();
-            double volume = model_().dofTotalVolume(globI);
-            Scalar storefac = volume / dt;
-            adres = 0.0;
+            const auto storageFn = [&](const VectorBlock& currentStorage)
             {
-                OPM_TIMEBLOCK_LOCAL(computeStorage);
-                LocalResidual::computeStorage(adres, intQuantsIn);
-            }
-            setResAndJacobi(res, bMat, adres);
-            // Either use cached storage term, or compute it on the fly.
-            if (model_().enableStorageCache()) {
-                // The cached storage for timeIdx 0 (current time) is not
-                // used, but after storage cache is shifted at the end of the
-                // timestep, it will become cached storage for timeIdx 1.
-                model_().updateCachedStorage(globI, /*timeIdx=*/0, res);
-                if (model_().newtonMethod().numIterations() == 0) {
-                    // Need to update the storage cache.
-                    if (problem_().recycleFirstIterationStorage()) {
-                        // Assumes nothing have changed in the system which
-                        // affects masses calculated from primary variables.
-                        if (on_full_domain) {
-                            // This is to avoid resetting the start-of-step storage
-                            // to incorrect numbers when we do local solves, where the iteration
-                            // number will start from 0, but the starting state may not be identical
-                            // to the start-of-step state.
-                            // Note that a full assembly must be done before local solves
-                            // otherwise this will be left un-updated.
-                            model_().updateCachedStorage(globI, /*timeIdx=*/1, res);
+                if (classifyCells)
+                    storage = currentStorage;
+                // Either use cached storage term, or compute it on the fly.
+                if (model_().enableStorageCache()) {
+                    // The cached storage for timeIdx 0 (current time) is not
+                    // used, but after storage cache is shifted at the end of the
+                    // timestep, it will become cached storage for timeIdx 1.
+                    model_().updateCachedStorage(globI, /*timeIdx=*/0, currentStorage);
+                    if (model_().newtonMethod().numIterations() == 0) {
+                        // Need to update the storage cache.
+                        if (problem_().recycleFirstIterationStorage()) {
+                            // Assumes nothing have changed in the system which
+                            // affects masses calculated from primary variables.
+                            if (on_full_domain) {
+                                // This is to avoid resetting the start-of-step storage
+                                // to incorrect numbers when we do local solves, where the iteration
+                                // number will start from 0, but the starting state may not be identical
+                                // to the start-of-step state.
+                                // Note that a full assembly must be done before local solves
+                                // otherwise this will be left un-updated.
+                                model_().updateCachedStorage(globI, /*timeIdx=*/1, currentStorage);
+                            }
+                        } else {
+                            Dune::FieldVector<Scalar, numEq> tmp;
+                            IntensiveQuantities intQuantOld = model_().intensiveQuantities(globI, 1);
+                            LocalResidual::computeStorage(tmp, intQuantOld);
+                            model_().updateCachedStorage(globI, /*timeIdx=*/1, tmp);
                         }
-                    } else {
-                        Dune::FieldVector<Scalar, numEq> tmp;
-                        IntensiveQuantities intQuantOld = model_().intensiveQuantities(globI, 1);
-                        LocalResidual::computeStorage(tmp, intQuantOld);
-                        model_().updateCachedStorage(globI, /*timeIdx=*/1, tmp);
                     }
                 }
-                res -= model_().cachedStorage(globI, 1);
-            } else {
-                OPM_TIMEBLOCK_LOCAL(computeStorage0);
-                Dune::FieldVector<Scalar, numEq> tmp;
-                IntensiveQuantities intQuantOld = model_().intensiveQuantities(globI, 1);
-                LocalResidual::computeStorage(tmp, intQuantOld);
-                // assume volume do not change
-                res -= tmp;
-            }
-            res *= storefac;
-            bMat *= storefac;
-            residual_[globI] += res;
-            //SparseAdapter syntax: jacobian_->addToBlock(globI, globI, bMat);
-            *diagMatAddress_[globI] += bMat;
+                return oldStorage_(globI);
+            };
 
-            // Cell-wise source terms.
-            // This will include well sources if SeparateSparseSourceTerms is false.
-            res = 0.0;
-            bMat = 0.0;
-            adres = 0.0;
-            if (separateSparseSourceTerms_) {
-                LocalResidual::computeSourceDense(adres, problem_(), globI, 0);
-            } else {
-                LocalResidual::computeSource(adres, problem_(), globI, 0);
-            }
-            adres *= -volume;
-            setResAndJacobi(res, bMat, adres);
+            linearizeCellTerms_(globI, intQuants, res, diag, source, faceFn, storageFn);
             residual_[globI] += res;
-            //SparseAdapter syntax: jacobian_->addToBlock(globI, globI, bMat);
-            *diagMatAddress_[globI] += bMat;
+            //SparseAdapter syntax: jacobian_->addToBlock(globI, globI, diag);
+            *diagMatAddress_[globI] += diag;
+
+            if (classifyCells) {
+                // cells with sources, e.g. the ones which are perforated by wells,
+                // are always treated implicitly
+                const bool hasSource = source.infinity_norm() > 0.0;
+                const bool isSlow = !hasSource && canBeExplicit_[globI] &&
+                    hasSmallCflNumber_(outflow, storage, model_().dofTotalVolume(globI), dt);
+                if (isFirstIteration)
+                    isExplicit_[globI] = isSlow;
+                else if (!isSlow)
+                    isExplicit_[globI] = 0;
+            }
         } // end of loop for cell globI.
 
         // Add sparse source terms. For now only wells.
@@ -854,17 +1211,161 @@ private:
             if (bdyInfo.bcdata.type == BCType::NONE)
                 continue;
 
-            VectorBlock res(0.0);
-            MatrixBlock bMat(0.0);
-            ADVectorBlock adres(0.0);
+            VectorBlock res;
+            MatrixBlock bMat;
             const unsigned globI = bdyInfo.cell;
-            const IntensiveQuantities& insideIntQuants = model_().intensiveQuantities(globI, /*timeIdx*/ 0);
-            LocalResidual::computeBoundaryFlux(adres, problem_(), bdyInfo.bcdata, insideIntQuants, globI);
-            adres *= bdyInfo.bcdata.faceArea;
-            setResAndJacobi(res, bMat, adres);
+            computeBoundaryTerm_(bdyInfo, intQuants(globI), res, bMat);
             residual_[globI] += res;
             ////SparseAdapter syntax: jacobian_->addToBlock(globI, globI, bMat);
             *diagMatAddress_[globI] += bMat;
+
+            // the boundary fluxes are not considered by the CFL criterion
+            if (classifyCells)
+                isExplicit_[globI] = 0;
+        }
+    }
+
+    // Evaluate the flux, storage and source terms of a cell and their derivatives with
+    // regard to the primary variables of the cell. This is shared by linearize_() and
+    // linearizeCell(). For each face, faceFn(faceIdx, nbInfo, flux, fluxDeriv,
+    // darcyFlux) is called. storageFn(storage) is called with the storage term of the
+    // current solution and returns the one of the previous time step. The source
+    // term is returned separately in addition to being part of the residual. The
+    // boundary terms are not included.
+    template <class IntQuantsFn, class FaceFn, class StorageFn>
+    void linearizeCellTerms_(unsigned globI,
+                             const IntQuantsFn& intQuants,
+                             VectorBlock& res,
+                             MatrixBlock& diag,
+                             VectorBlock& source,
+                             FaceFn&& faceFn,
+                             StorageFn&& storageFn)
+    {
+        VectorBlock r;
+        MatrixBlock bMat;
+        ADVectorBlock adres(0.0);
+        ADVectorBlock darcyFlux(0.0);
+        res = 0.0;
+        diag = 0.0;
+        const IntensiveQuantities& intQuantsIn = intQuants(globI);
+
+        // Flux term.
+        {
+            OPM_TIMEBLOCK_LOCAL(fluxCalculationForEachCell);
+            unsigned loc = 0;
+            for (const auto& nbInfo : neighborInfo_[globI]) {
+                OPM_TIMEBLOCK_LOCAL(fluxCalculationForEachFace);
+                const unsigned globJ = nbInfo.neighbor;
+                assert(globJ != globI);
+                adres = 0.0;
+                darcyFlux = 0.0;
+                LocalResidual::computeFlux(adres, darcyFlux, globI, globJ, intQuantsIn, intQuants(globJ),
+                                           residualNBInfo_(globI, nbInfo));
+                adres *= nbInfo.faceArea;
+                setResAndJacobi(r, bMat, adres);
+                res += r;
+                diag += bMat;
+                faceFn(loc, nbInfo, static_cast<const VectorBlock&>(r),
+                       static_cast<const MatrixBlock&>(bMat), static_cast<const ADVectorBlock&>(darcyFlux));
+                ++loc;
+            }
+        }
+
+        // Accumulation term.
+        const double dt = simulator_().timeStepSize();
+        const double volume = model_().dofTotalVolume(globI);
+        const Scalar storefac = volume / dt;
+        adres = 0.0;
+        {
+            OPM_TIMEBLOCK_LOCAL(computeStorage);
+            LocalResidual::computeStorage(adres, intQuantsIn);
+        }
+        setResAndJacobi(r, bMat, adres);
+        // assume volume do not change
+        r -= storageFn(static_cast<const VectorBlock&>(r));
+        r *= storefac;
+        bMat *= storefac;
+        res += r;
+        diag += bMat;
+
+        // Cell-wise source terms.
+        // This will include well sources if SeparateSparseSourceTerms is false.
+        adres = 0.0;
+        if (separateSparseSourceTerms_) {
+            LocalResidual::computeSourceDense(adres, problem_(), globI, 0);
+        } else {
+            LocalResidual::computeSource(adres, problem_(), globI, 0);
+        }
+        adres *= -volume;
+        setResAndJacobi(source, bMat, adres);
+        res += source;
+        diag += bMat;
+    }
+
+    // The storage term of a cell at the beginning of the time step.
+    VectorBlock oldStorage_(unsigned globI)
+    {
+        if (model_().enableStorageCache())
+            return model_().cachedStorage(globI, /*timeIdx=*/1);
+
+        OPM_TIMEBLOCK_LOCAL(computeStorage0);
+        Dune::FieldVector<Scalar, numEq> tmp;
+        IntensiveQuantities intQuantOld = model_().intensiveQuantities(globI, 1);
+        LocalResidual::computeStorage(tmp, intQuantOld);
+        return tmp;
+    }
+
+    // The flux over a boundary face and its derivatives with regard to the primary
+    // variables of the cell.
+    void computeBoundaryTerm_(const BoundaryInfo& bdyInfo,
+                              const IntensiveQuantities& insideIntQuants,
+                              VectorBlock& res,
+                              MatrixBlock& bMat)
+    {
+        ADVectorBlock adres(0.0);
+        LocalResidual::computeBoundaryFlux(adres, problem_(), bdyInfo.bcdata, insideIntQuants, bdyInfo.cell);
+        adres *= bdyInfo.bcdata.faceArea;
+        setResAndJacobi(res, bMat, adres);
+    }
+
+    // Returns true if the fraction of the mass of each component which leaves a cell
+    // during the time step is below the CFL limit of the adaptive implicit mode.
+    bool hasSmallCflNumber_(const VectorBlock& outflow,
+                            const VectorBlock& storage,
+                            Scalar volume,
+                            Scalar dt) const
+    {
+        for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx) {
+            if (outflow[eqIdx] <= 0.0)
+                continue;
+            const Scalar mass = storage[eqIdx]*volume;
+            if (!(dt*outflow[eqIdx] < aimCflLimit_*mass))
+                return false;
+        }
+        return true;
+    }
+
+    // Condense the non-pressure primary variables of the explicit cells out of the
+    // linear system, see Linear::ExplicitCellCondenser.
+    void condenseExplicitCells_()
+    {
+        OPM_TIMEBLOCK(condenseExplicitCells);
+        explicitCells_.clear();
+        for (unsigned globI = 0; globI < isExplicit_.size(); ++globI) {
+            if (isExplicit_[globI])
+                explicitCells_.push_back(globI);
+        }
+        condenser_.condense(jacobian_->istlMatrix(), explicitCells_, pressureVarIdx);
+
+        if (aimVerbose_) {
+            const auto& comm = simulator_().gridView().comm();
+            const unsigned long numExplicitCells = comm.sum(static_cast<unsigned long>(explicitCells_.size()));
+            const unsigned long numTotalCells = comm.sum(static_cast<unsigned long>(isExplicit_.size()));
+            if (comm.rank() == 0)
+                std::cout << "Adaptive implicit: " << numExplicitCells << " of " << numTotalCells
+                          << " cells are explicit, " << numExplicitCells*(numEq - 1) << " of "
+                          << numTotalCells*numEq << " unknowns condensed out of the linear system\n"
+                          << std::flush;
         }
     }
 
@@ -884,7 +1385,7 @@ private:
             auto nbInfos = neighborInfo_[globI]; // nbInfos will be a SparseTable<...>::mutable_iterator_range.
             for (auto& nbInfo : nbInfos) {
                 unsigned globJ = nbInfo.neighbor;
-                nbInfo.res_nbinfo.trans = problem_().transmissibility(globI, globJ);
+                nbInfo.trans = problem_().transmissibility(globI, globJ);
             }
         }
     }
@@ -900,15 +1401,77 @@ private:
 
     LinearizationType linearizationType_;
 
+    // The static data of a face is streamed from memory for each linearization, so
+    // it is kept as small as possible: the data of the cells (i.e., their volumes)
+    // is not duplicated for each face, the quantities of the energy, diffusion and
+    // dispersion modules only take up space if the respective module is enabled and
+    // the off-diagonal matrix block is addressed using a 32-bit offset.
     using ResidualNBInfo = typename LocalResidual::ResidualNBInfo;
+    struct EnergyNBInfo
+    {
+        Scalar inAlpha;
+        Scalar outAlpha;
+    };
+    struct DiffusionNBInfo
+    {
+        Scalar diffusivity;
+    };
+    struct DispersionNBInfo
+    {
+        Scalar dispersivity;
+    };
+    template <int moduleIdx>
+    struct NoNBInfo
+    {};
+
     struct NeighborInfo
+        : public std::conditional_t<enableEnergy, EnergyNBInfo, NoNBInfo<0>>
+        , public std::conditional_t<enableDiffusion, DiffusionNBInfo, NoNBInfo<1>>
+        , public std::conditional_t<enableDispersionModule, DispersionNBInfo, NoNBInfo<2>>
     {
+        Scalar trans;
+        Scalar faceArea;
+        Scalar thpres;
+        Scalar dZg;
         unsigned int neighbor;
-        ResidualNBInfo res_nbinfo;
-        MatrixBlock* matBlockAddress;
+        unsigned int matBlockOffset; // offset of the (neighbor, cell) block from blockBase_
+        int dirId;
     };
     SparseTable<NeighborInfo> neighborInfo_;
     std::vector<MatrixBlock*> diagMatAddress_;
+    MatrixBlock* blockBase_ = nullptr;
+    MatrixFreeOperator matrixFreeOperator_;
+    bool matrixFree_ = false;
+
+    // the state of the adaptive implicit mode
+    std::vector<char> isExplicit_;
+    std::vector<char> canBeExplicit_;
+    std::vector<unsigned> explicitCells_;
+    Linear::ExplicitCellCondenser<typename SparseMatrixAdapter::IstlMatrix, GlobalEqVector> condenser_;
+    double aimCflLimit_ = 0.5;
+    bool adaptiveImplicit_ = false;
+    bool aimVerbose_ = false;
+
+    // Expand the compressed static data of a face into the structure expected by
+    // the local residual.
+    ResidualNBInfo residualNBInfo_(unsigned globI, const NeighborInfo& nbInfo) const
+    {
+        const auto& model = model_();
+        ResidualNBInfo res {nbInfo.trans, nbInfo.faceArea, nbInfo.thpres, nbInfo.dZg, nbInfo.dirId,
+                            model.dofTotalVolume(globI), model.dofTotalVolume(nbInfo.neighbor),
+                            0.0, 0.0, 0.0, 0.0};
+        if constexpr (enableEnergy) {
+            res.inAlpha = nbInfo.inAlpha;
+            res.outAlpha = nbInfo.outAlpha;
+        }
+        if constexpr (enableDiffusion) {
+            res.diffusivity = nbInfo.diffusivity;
+        }
+        if constexpr (enableDispersionModule) {
+            res.dispersivity = nbInfo.dispersivity;
+        }
+        return res;
+    }
 
     struct FlowInfo
     {
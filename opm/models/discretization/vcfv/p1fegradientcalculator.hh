@@ -31,6 +31,7 @@
 #include "vcfvproperties.hh"
 
 #include <opm/models/discretization/common/fvbasegradientcalculator.hh>
+#include <opm/models/utils/parametersystem.hh>
 
 #include <dune/common/fvector.hh>
 #include <dune/common/version.hh>
@@ -41,11 +42,33 @@
 #include <dune/localfunctions/lagrange/pqkfactory.hh>
 #endif // HAVE_DUNE_LOCALFUNCTIONS
 
-#include <dune/common/fvector.hh>
-
+#include <atomic>
+#include <cstddef>
+#include <mutex>
 #include <vector>
 
 namespace Opm {
+/*!
+ * \ingroup FiniteElementDiscretizations
+ *
+ * \brief The values and global gradients of the P1 shape functions at the interior
+ *        flux approximation points of all elements of a grid.
+ *
+ * For element \f$e\f$, the entries for face \f$f\f$ and vertex \f$v\f$ are
+ * located at index <tt>offset[e] + f*numVertices[e] + v</tt>. The table is owned by
+ * the discretization and it is filled by the P1FeGradientCalculator.
+ */
+template <class Scalar, int dim>
+struct P1FeGradientTable
+{
+    std::mutex mutex;
+    std::atomic<int> gridSequenceNumber{-1};
+    std::vector<std::size_t> offset;
+    std::vector<unsigned> numVertices;
+    std::vector<Scalar> values;
+    std::vector<Dune::FieldVector<Scalar, dim>> gradients;
+};
+
 /*!
  * \ingroup FiniteElementDiscretizations
  *
@@ -54,6 +77,14 @@ namespace Opm {
  *
  * This approach can also be used for the vertex-centered finite volume (VCFV)
  * discretization.
+ *
+ * Since the grid does not change between two adaptation steps, the values and
+ * global gradients of the shape functions at the interior flux approximation points
+ * of all elements can be computed once per grid sequence number and stored in a
+ * table of the discretization which is shared by all element contexts. prepare()
+ * then only needs to set two pointers into this table. Since the table requires
+ * memory for every flux approximation point of the grid, it must be enabled using
+ * the EnableP1FeGradientTable parameter.
  */
 template<class TypeTag>
 class P1FeGradientCalculator : public FvBaseGradientCalculator<TypeTag>
@@ -63,6 +94,7 @@ class P1FeGradientCalculator : public FvBaseGradientCalculator<TypeTag>
     using Evaluation = GetPropType<TypeTag, Properties::Evaluation>;
     using GridView = GetPropType<TypeTag, Properties::GridView>;
     using ElementContext = GetPropType<TypeTag, Properties::ElementContext>;
+    using Stencil = GetPropType<TypeTag, Properties::Stencil>;
 
     enum { dim = GridView::dimension };
 
@@ -79,10 +111,25 @@ class P1FeGradientCalculator : public FvBaseGradientCalculator<TypeTag>
     using LocalFiniteElementCache = Dune::PQkLocalFiniteElementCache<CoordScalar, Scalar, dim, 1>;
     using LocalFiniteElement = typename LocalFiniteElementCache::FiniteElementType;
     using LocalBasisTraits = typename LocalFiniteElement::Traits::LocalBasisType::Traits;
+    using ShapeValue = typename LocalBasisTraits::RangeType;
     using ShapeJacobian = typename LocalBasisTraits::JacobianType;
+    using GradientTable = P1FeGradientTable<Scalar, dim>;
 #endif // HAVE_DUNE_LOCALFUNCTIONS
 
 public:
+    /*!
+     * \brief Register all run-time parameters for the gradient calculator.
+     */
+    static void registerParameters()
+    {
+        ParentType::registerParameters();
+
+        if (getPropValue<TypeTag, Properties::UseP1FiniteElementGradients>())
+            Parameters::registerParam<TypeTag, Properties::EnableP1FeGradientTable>
+                ("Precompute the P1 shape function values and gradients at the flux "
+                 "approximation points of all elements once per grid sequence number");
+    }
+
     /*!
      * \brief Precomputes the common values to calculate gradients and
      *        values of quantities at any flux approximation point.
@@ -99,39 +146,22 @@ public:
             throw std::logic_error("The dune-localfunctions module is required in oder to use"
                                    " finite element gradients");
 #else
-            const auto& stencil = elemCtx.stencil(timeIdx);
-
-            const LocalFiniteElement& localFE = feCache_.get(elemCtx.element().type());
-            localFiniteElement_ = &localFE;
-
-            // loop over all face centeres
-            for (unsigned faceIdx = 0; faceIdx < stencil.numInteriorFaces(); ++faceIdx) {
-                const auto& localFacePos = stencil.interiorFace(faceIdx).localPos();
-
-                // Evaluate the P1 shape functions and their gradients at all
-                // flux approximation points.
-                if (prepareValues)
-                    localFE.localBasis().evaluateFunction(localFacePos, p1Value_[faceIdx]);
-
-                if (prepareGradients) {
-                    // first, get the shape function's gradient in local coordinates
-                    std::vector<ShapeJacobian> localGradient;
-                    localFE.localBasis().evaluateJacobian(localFacePos, localGradient);
-
-                    // convert to a gradient in global space by
-                    // multiplying with the inverse transposed jacobian of
-                    // the position
-                    const auto& geom = elemCtx.element().geometry();
-                    const auto& jacInvT =
-                        geom.jacobianInverseTransposed(localFacePos);
-
-                    size_t numVertices = elemCtx.numDof(timeIdx);
-                    for (unsigned vertIdx = 0; vertIdx < numVertices; vertIdx++) {
-                        jacInvT.mv(/*xVector=*/localGradient[vertIdx][0],
-                                   /*destVector=*/p1Gradient_[faceIdx][vertIdx]);
-                    }
-                }
+            if (GradientTable* tablePtr = elemCtx.model().p1FeGradientTable()) {
+                const GradientTable& table = updateGradientTable_(*tablePtr, elemCtx);
+                const unsigned elemIdx = elemCtx.model().elementMapper().index(elemCtx.element());
+                numVertices_ = table.numVertices[elemIdx];
+                p1Value_ = table.values.data() + table.offset[elemIdx];
+                p1Gradient_ = table.gradients.data() + table.offset[elemIdx];
+                return;
             }
+
+            numVertices_ = elemCtx.numDof(timeIdx);
+            computeElement_<prepareValues, prepareGradients>(localValues_,
+                                                             localGradients_,
+                                                             elemCtx.element(),
+                                                             elemCtx.stencil(timeIdx));
+            p1Value_ = localValues_;
+            p1Gradient_ = localGradients_;
 #endif
         }
         else
@@ -171,9 +201,9 @@ public:
             for (unsigned vertIdx = 0; vertIdx < elemCtx.numDof(/*timeIdx=*/0); ++vertIdx) {
                 if (std::is_same<QuantityType, Scalar>::value ||
                     elemCtx.focusDofIndex() == vertIdx)
-                    value += quantityCallback(vertIdx)*p1Value_[fapIdx][vertIdx];
+                    value += quantityCallback(vertIdx)*p1Value_[fapIdx*numVertices_ + vertIdx];
                 else
-                    value += Toolbox::value(quantityCallback(vertIdx))*p1Value_[fapIdx][vertIdx];
+                    value += Toolbox::value(quantityCallback(vertIdx))*p1Value_[fapIdx*numVertices_ + vertIdx];
             }
 
             return value;
@@ -223,12 +253,12 @@ public:
                 {
                     const auto& tmp = quantityCallback(vertIdx);
                     for (unsigned k = 0; k < tmp.size(); ++k)
-                        value[k] += tmp[k]*p1Value_[fapIdx][vertIdx];
+                        value[k] += tmp[k]*p1Value_[fapIdx*numVertices_ + vertIdx];
                 }
                 else {
                     const auto& tmp = quantityCallback(vertIdx);
                     for (unsigned k = 0; k < tmp.size(); ++k)
-                        value[k] += Toolbox::value(tmp[k])*p1Value_[fapIdx][vertIdx];
+                        value[k] += Toolbox::value(tmp[k])*p1Value_[fapIdx*numVertices_ + vertIdx];
                 }
             }
 
@@ -273,13 +303,13 @@ public:
                     elemCtx.focusDofIndex() == vertIdx)
                 {
                     const auto& dofVal = quantityCallback(vertIdx);
-                    const auto& tmp = p1Gradient_[fapIdx][vertIdx];
+                    const auto& tmp = p1Gradient_[fapIdx*numVertices_ + vertIdx];
                     for (int dimIdx = 0; dimIdx < dim; ++ dimIdx)
                         quantityGrad[dimIdx] += dofVal*tmp[dimIdx];
                 }
                 else {
                     const auto& dofVal = quantityCallback(vertIdx);
-                    const auto& tmp = p1Gradient_[fapIdx][vertIdx];
+                    const auto& tmp = p1Gradient_[fapIdx*numVertices_ + vertIdx];
                     for (int dimIdx = 0; dimIdx < dim; ++ dimIdx)
                         quantityGrad[dimIdx] += scalarValue(dofVal)*tmp[dimIdx];
                 }
@@ -339,11 +369,108 @@ public:
 
 private:
 #if HAVE_DUNE_LOCALFUNCTIONS
+    /*!
+     * \brief Evaluate the shape functions and their global gradients at all interior
+     *        flux approximation points of an element.
+     */
+    template <bool prepareValues, bool prepareGradients, class Element>
+    void computeElement_(Scalar* values,
+                         DimVector* gradients,
+                         const Element& element,
+                         const Stencil& stencil)
+    {
+        const LocalFiniteElement& localFE = feCache_.get(element.type());
+        const auto& geom = element.geometry();
+        const unsigned numVertices = stencil.numDof();
+
+        for (unsigned faceIdx = 0; faceIdx < stencil.numInteriorFaces(); ++faceIdx) {
+            const auto& localFacePos = stencil.interiorFace(faceIdx).localPos();
+
+            if (prepareValues) {
+                localFE.localBasis().evaluateFunction(localFacePos, shapeValues_);
+                for (unsigned vertIdx = 0; vertIdx < numVertices; ++vertIdx)
+                    values[faceIdx*numVertices + vertIdx] = shapeValues_[vertIdx][0];
+            }
+
+            if (prepareGradients) {
+                // first, get the shape function's gradient in local coordinates
+                localFE.localBasis().evaluateJacobian(localFacePos, shapeJacobians_);
+
+                // convert to a gradient in global space by multiplying with the
+                // inverse transposed jacobian of the position
+                const auto& jacInvT = geom.jacobianInverseTransposed(localFacePos);
+                for (unsigned vertIdx = 0; vertIdx < numVertices; ++vertIdx)
+                    jacInvT.mv(/*xVector=*/shapeJacobians_[vertIdx][0],
+                               /*destVector=*/gradients[faceIdx*numVertices + vertIdx]);
+            }
+        }
+    }
+
+    /*!
+     * \brief Returns the table of shape function values and gradients of the
+     *        discretization, (re-)building it if the grid has changed.
+     *
+     * The table is shared by all threads, so the first thread which notices a new
+     * grid sequence number builds it for the whole grid while the others wait.
+     */
+    const GradientTable& updateGradientTable_(GradientTable& table,
+                                              const ElementContext& elemCtx)
+    {
+        const int seqNum = elemCtx.simulator().vanguard().gridSequenceNumber();
+        if (table.gridSequenceNumber.load(std::memory_order_acquire) == seqNum)
+            return table;
+
+        std::lock_guard<std::mutex> lock(table.mutex);
+        if (table.gridSequenceNumber.load(std::memory_order_relaxed) == seqNum)
+            return table;
+
+        const auto& gridView = elemCtx.gridView();
+        const auto& elementMapper = elemCtx.model().elementMapper();
+        const std::size_t numElements = gridView.size(/*codim=*/0);
+
+        Stencil stencil(gridView, elemCtx.model().dofMapper());
+
+        // first pass: determine the number of entries required by each element
+        table.offset.assign(numElements, 0);
+        table.numVertices.assign(numElements, 0);
+        std::size_t numEntries = 0;
+        for (const auto& elem : elements(gridView)) {
+            stencil.update(elem);
+            const unsigned elemIdx = elementMapper.index(elem);
+            table.offset[elemIdx] = numEntries;
+            table.numVertices[elemIdx] = stencil.numDof();
+            numEntries += stencil.numInteriorFaces()*stencil.numDof();
+        }
+
+        // second pass: evaluate the shape functions
+        table.values.resize(numEntries);
+        table.gradients.resize(numEntries);
+        for (const auto& elem : elements(gridView)) {
+            stencil.update(elem);
+            const unsigned elemIdx = elementMapper.index(elem);
+            const std::size_t offset = table.offset[elemIdx];
+            computeElement_</*prepareValues=*/true, /*prepareGradients=*/true>
+                (table.values.data() + offset,
+                 table.gradients.data() + offset,
+                 elem,
+                 stencil);
+        }
+
+        table.gridSequenceNumber.store(seqNum, std::memory_order_release);
+        return table;
+    }
+
     static LocalFiniteElementCache feCache_;
 
-    const LocalFiniteElement* localFiniteElement_;
-    std::vector<Dune::FieldVector<Scalar, 1>> p1Value_[maxFap];
-    DimVector p1Gradient_[maxFap][maxDof];
+    unsigned numVertices_{0};
+    const Scalar* p1Value_{nullptr};
+    const DimVector* p1Gradient_{nullptr};
+
+    // storage used if the gradient table is disabled
+    Scalar localValues_[maxFap*maxDof];
+    DimVector localGradients_[maxFap*maxDof];
+    std::vector<ShapeValue> shapeValues_;
+    std::vector<ShapeJacobian> shapeJacobians_;
 #endif // HAVE_DUNE_LOCALFUNCTIONS
 };
 
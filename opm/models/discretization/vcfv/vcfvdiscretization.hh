@@ -93,6 +93,11 @@ struct GridCommHandleFactory<TypeTag, TTag::VcfvDiscretization>
 template<class TypeTag>
 struct UseP1FiniteElementGradients<TypeTag, TTag::VcfvDiscretization> { static constexpr bool value = false; };
 
+//! Do not store the P1 shape function values and gradients for the whole grid by
+//! default because this requires memory for each flux approximation point
+template<class TypeTag>
+struct EnableP1FeGradientTable<TypeTag, TTag::VcfvDiscretization> { static constexpr bool value = false; };
+
 #if HAVE_DUNE_FEM
 //! Set the DiscreteFunctionSpace
 template<class TypeTag>
@@ -158,13 +163,19 @@ class VcfvDiscretization : public GetPropType<TypeTag, Properties::BaseDiscretiz
     using DofMapper = GetPropType<TypeTag, Properties::DofMapper>;
     using GridView = GetPropType<TypeTag, Properties::GridView>;
     using Simulator = GetPropType<TypeTag, Properties::Simulator>;
+    using Scalar = GetPropType<TypeTag, Properties::Scalar>;
 
     enum { dim = GridView::dimension };
 
+    using GradientTable = P1FeGradientTable<Scalar, dim>;
+
 public:
     VcfvDiscretization(Simulator& simulator)
         : ParentType(simulator)
-    { }
+    {
+        if (getPropValue<TypeTag, Properties::UseP1FiniteElementGradients>())
+            enableP1FeGradientTable_ = Parameters::get<TypeTag, Properties::EnableP1FeGradientTable>();
+    }
 
     /*!
      * \brief Returns a string of discretization's human-readable name
@@ -185,6 +196,16 @@ public:
     const DofMapper& dofMapper() const
     { return this->vertexMapper(); }
 
+    /*!
+     * \brief Returns the table of the P1 shape function values and gradients at the
+     *        flux approximation points of all elements.
+     *
+     * The table is filled lazily by the gradient calculators of the element
+     * contexts. If the table is disabled, a null pointer is returned.
+     */
+    GradientTable* p1FeGradientTable() const
+    { return enableP1FeGradientTable_ ? &p1FeGradientTable_ : nullptr; }
+
     /*!
      * \brief Serializes the current state of the model.
      *
@@ -215,6 +236,9 @@ private:
     { return *static_cast<Implementation*>(this); }
     const Implementation& asImp_() const
     { return *static_cast<const Implementation*>(this); }
+
+    bool enableP1FeGradientTable_{false};
+    mutable GradientTable p1FeGradientTable_;
 };
 } // namespace Opm
 
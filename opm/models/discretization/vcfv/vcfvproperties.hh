@@ -46,6 +46,12 @@ struct VcfvDiscretization { using InheritsFrom = std::tuple<FvBaseDiscretization
 template<class TypeTag, class MyTypeTag>
 struct UseP1FiniteElementGradients { using type = UndefinedProperty; };
 
+//! Precompute the values and gradients of the P1 shape functions at the flux
+//! approximation points of all elements instead of evaluating them for each element
+//! context. This is only relevant if P1 finite-element gradients are used.
+template<class TypeTag, class MyTypeTag>
+struct EnableP1FeGradientTable { using type = UndefinedProperty; };
+
 } // namespace Opm::Properties
 
 #endif
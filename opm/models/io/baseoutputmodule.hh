@@ -34,14 +34,17 @@
 #include <opm/models/utils/basicproperties.hh>
 #include <opm/models/common/multiphasebaseproperties.hh>
 #include <opm/models/discretization/common/fvbaseproperties.hh>
+#include <opm/models/discretization/common/reorderingelementmapper.hh>
 
 #include <dune/istl/bvector.hh>
 #include <dune/common/fvector.hh>
 
 #include <array>
+#include <cstddef>
 #include <sstream>
 #include <string>
 #include <string_view>
+#include <type_traits>
 #include <vector>
 
 #include <cstdio>
@@ -78,6 +81,8 @@ class BaseOutputModule
     using ElementContext = GetPropType<TypeTag, Properties::ElementContext>;
     using FluidSystem = GetPropType<TypeTag, Properties::FluidSystem>;
     using DiscBaseOutputModule = GetPropType<TypeTag, Properties::DiscBaseOutputModule>;
+    using ElementMapper = GetPropType<TypeTag, Properties::ElementMapper>;
+    using DofMapper = GetPropType<TypeTag, Properties::DofMapper>;
 
     enum { numPhases = getPropValue<TypeTag, Properties::NumPhases>() };
     enum { numComponents = getPropValue<TypeTag, Properties::NumComponents>() };
@@ -318,6 +323,8 @@ protected:
                              ScalarBuffer& buffer,
                              BufferType bufferType = DofBuffer)
     {
+        restoreNaturalOrder_(buffer, bufferType);
+
         if (bufferType == DofBuffer)
             DiscBaseOutputModule::attachScalarDofData_(baseWriter, buffer, name);
         else if (bufferType == VertexBuffer)
@@ -336,6 +343,8 @@ protected:
                              VectorBuffer& buffer,
                              BufferType bufferType = DofBuffer)
     {
+        restoreNaturalOrder_(buffer, bufferType);
+
         if (bufferType == DofBuffer)
             DiscBaseOutputModule::attachVectorDofData_(baseWriter, buffer, name);
         else if (bufferType == VertexBuffer)
@@ -354,6 +363,8 @@ protected:
                              TensorBuffer& buffer,
                              BufferType bufferType = DofBuffer)
     {
+        restoreNaturalOrder_(buffer, bufferType);
+
         if (bufferType == DofBuffer)
             DiscBaseOutputModule::attachTensorDofData_(baseWriter, buffer, name);
         else if (bufferType == VertexBuffer)
@@ -377,6 +388,7 @@ protected:
             std::string eqName = simulator_.model().primaryVarName(i);
             snprintf(name, 512, pattern, eqName.c_str());
 
+            restoreNaturalOrder_(buffer[i], bufferType);
             if (bufferType == DofBuffer)
                 DiscBaseOutputModule::attachScalarDofData_(baseWriter, buffer[i], name);
             else if (bufferType == VertexBuffer)
@@ -402,6 +414,7 @@ protected:
             oss << i;
             snprintf(name, 512, pattern, oss.str().c_str());
 
+            restoreNaturalOrder_(buffer[i], bufferType);
             if (bufferType == DofBuffer)
                 DiscBaseOutputModule::attachScalarDofData_(baseWriter, buffer[i], name);
             else if (bufferType == VertexBuffer)
@@ -425,6 +438,7 @@ protected:
         for (unsigned i = 0; i < numPhases; ++i) {
             snprintf(name, 512, pattern, FluidSystem::phaseName(i).data());
 
+            restoreNaturalOrder_(buffer[i], bufferType);
             if (bufferType == DofBuffer)
                 DiscBaseOutputModule::attachScalarDofData_(baseWriter, buffer[i], name);
             else if (bufferType == VertexBuffer)
@@ -448,6 +462,7 @@ protected:
         for (unsigned i = 0; i < numComponents; ++i) {
             snprintf(name, 512, pattern, FluidSystem::componentName(i).data());
 
+            restoreNaturalOrder_(buffer[i], bufferType);
             if (bufferType == DofBuffer)
                 DiscBaseOutputModule::attachScalarDofData_(baseWriter, buffer[i], name);
             else if (bufferType == VertexBuffer)
@@ -474,6 +489,7 @@ protected:
                          FluidSystem::phaseName(i).data(),
                          FluidSystem::componentName(j).data());
 
+                restoreNaturalOrder_(buffer[i][j], bufferType);
                 if (bufferType == DofBuffer)
                     DiscBaseOutputModule::attachScalarDofData_(baseWriter, buffer[i][j], name);
                 else if (bufferType == VertexBuffer)
@@ -486,6 +502,29 @@ protected:
         }
     }
 
+    /*!
+     * \brief Bring the data of a buffer back to the ordering of the grid's elements.
+     *
+     * This is only required if the model renumbers the elements, i.e., if the
+     * ReorderingElementMapper is used. Since the output writer evaluates the buffers
+     * using its own mapper, the data of element based buffers must be permuted before
+     * the buffer is attached.
+     */
+    template <class Buffer>
+    void restoreNaturalOrder_(Buffer& buffer, BufferType bufferType) const
+    {
+        if constexpr (IsReorderingElementMapper<ElementMapper>::value) {
+            if (bufferType == VertexBuffer ||
+                (bufferType == DofBuffer && !std::is_same_v<DofMapper, ElementMapper>))
+                return;
+
+            const auto& elementMapper = simulator_.model().elementMapper();
+            const Buffer reorderedBuffer(buffer);
+            for (std::size_t naturalIdx = 0; naturalIdx < buffer.size(); ++naturalIdx)
+                buffer[naturalIdx] = reorderedBuffer[elementMapper.reorderedIndex(naturalIdx)];
+        }
+    }
+
     void attachScalarElementData_(BaseOutputWriter& baseWriter,
                                   ScalarBuffer& buffer,
                                   const char *name)
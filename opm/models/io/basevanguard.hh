@@ -107,7 +107,7 @@ public:
     void loadBalance()
     {
         asImp_().grid().loadBalance();
-        updateGridView_();
+        finalizeLoadBalance_();
     }
 
 protected:
@@ -117,6 +117,25 @@ protected:
         updateGridView_();
     }
 
+    /*!
+     * \brief Refine the grid globally after it has been distributed.
+     *
+     * Refining the coarse grid after load balancing avoids to refine and then
+     * to redistribute the complete fine grid on a single process.
+     */
+    void deferGlobalRefinements_(unsigned numRefinements)
+    { numDeferredRefinements_ = numRefinements; }
+
+    // this method should be called after the grid has been distributed
+    void finalizeLoadBalance_()
+    {
+        if (numDeferredRefinements_ > 0) {
+            asImp_().grid().globalRefine(static_cast<int>(numDeferredRefinements_));
+            numDeferredRefinements_ = 0;
+        }
+        updateGridView_();
+    }
+
     void updateGridView_()
     {
 #if HAVE_DUNE_FEM
@@ -145,6 +164,7 @@ private:
     std::unique_ptr<GridPart> gridPart_;
 #endif
     std::unique_ptr<GridView> gridView_;
+    unsigned numDeferredRefinements_ = 0;
 };
 
 } // namespace Opm
@@ -113,7 +113,7 @@ public:
 
         unsigned numRefinements = Parameters::get<TypeTag, Properties::GridGlobalRefinements>();
         cubeGrid_ = Dune::StructuredGridFactory<Grid>::createCubeGrid(lowerLeft, upperRight, cellRes);
-        cubeGrid_->globalRefine(static_cast<int>(numRefinements));
+        this->deferGlobalRefinements_(numRefinements);
 
         this->finalizeInit_();
     }
@@ -28,7 +28,10 @@
 #define EWOMS_DGF_GRID_VANGUARD_HH
 
 #include <dune/grid/io/file/dgfparser/dgfparser.hh>
+#include <dune/grid/common/backuprestore.hh>
+#include <dune/grid/common/capabilities.hh>
 #include <dune/grid/common/mcmgmapper.hh>
+#include <dune/common/parallel/mpihelper.hh>
 #include <opm/models/discretefracture/fracturemapper.hh>
 
 #include <opm/models/io/basevanguard.hh>
@@ -36,6 +39,9 @@
 #include <opm/models/utils/parametersystem.hh>
 
 
+#include <filesystem>
+#include <fstream>
+#include <iostream>
 #include <type_traits>
 #include <string>
 
@@ -44,6 +50,13 @@ namespace Opm {
 /*!
  * \brief Provides a simulator vanguard which creates a grid by parsing a Dune Grid
  *        Format (DGF) file.
+ *
+ * If the GridCacheFile parameter is set and the grid supports Dune's
+ * backup/restore facility, the distributed coarse grid is written to one file
+ * per process after load balancing. Later runs with the same number of processes
+ * then restore their part of the grid from these files instead of parsing and
+ * distributing the DGF file. The cache is considered to be stale if the DGF file
+ * is newer than any of the cache files.
  */
 template <class TypeTag>
 class DgfVanguard : public BaseVanguard<TypeTag>
@@ -67,6 +80,9 @@ public:
         Parameters::registerParam<TypeTag,Properties::GridGlobalRefinements>
             ("The number of global refinements of the grid "
              "executed after it was loaded");
+        Parameters::registerParam<TypeTag,Properties::GridCacheFile>
+            ("The name prefix of the files which cache the distributed grid. "
+             "Caching is disabled if this is empty");
     }
 
     /*!
@@ -77,8 +93,9 @@ public:
     {
         const std::string dgfFileName = Parameters::get<TypeTag, Properties::GridFile>();
         unsigned numRefinments = Parameters::get<TypeTag, Properties::GridGlobalRefinements>();
+        cacheFileName_ = Parameters::get<TypeTag, Properties::GridCacheFile>();
 
-        {
+        if (cacheFileName_.empty() || !restoreGridCache_(dgfFileName)) {
             // create DGF GridPtr from a dgf file
             Dune::GridPtr< Grid > dgfPointer( dgfFileName );
 
@@ -89,8 +106,8 @@ public:
             gridPtr_.reset( dgfPointer.release() );
         }
 
-        if (numRefinments > 0)
-            gridPtr_->globalRefine(static_cast<int>(numRefinments));
+        // refine the grid only after it has been distributed
+        this->deferGlobalRefinements_(numRefinments);
 
         this->finalizeInit_();
     }
@@ -115,7 +132,16 @@ public:
      * the DGF...
      */
     void loadBalance()
-    { gridPtr_->loadBalance(); }
+    {
+        // a grid which has been restored from the cache is already distributed
+        if (!restoredFromCache_) {
+            gridPtr_->loadBalance();
+            if (!cacheFileName_.empty())
+                writeGridCache_();
+        }
+
+        this->finalizeLoadBalance_();
+    }
 
     /*!
      * \brief Returns the fracture mapper
@@ -180,11 +206,69 @@ protected:
                     fractureMapper_.addFractureEdge(vertexIndices[0], vertexIndices[1]);
             }
         }
+
+        fractureMapper_.finalize();
+        hasFractures_ = true;
+    }
+
+    std::string cacheFilePath_(int rank, int size) const
+    { return cacheFileName_ + "." + std::to_string(size) + "." + std::to_string(rank); }
+
+    // try to restore the local part of the grid from the cache. this is a
+    // collective operation: either all processes restore their part or none
+    // does.
+    bool restoreGridCache_(const std::string& dgfFileName)
+    {
+        if constexpr (Dune::Capabilities::hasBackupRestoreFacilities<Grid>::v) {
+            const auto comm = Dune::MPIHelper::getCommunication();
+            const std::string fileName = cacheFilePath_(comm.rank(), comm.size());
+
+            std::error_code ec;
+            int isValid = std::filesystem::exists(fileName, ec) && !ec;
+            if (isValid) {
+                const auto dgfTime = std::filesystem::last_write_time(dgfFileName, ec);
+                isValid = !ec && std::filesystem::last_write_time(fileName, ec) >= dgfTime && !ec;
+            }
+            if (!comm.min(isValid))
+                return false;
+
+            std::ifstream is(fileName, std::ios::binary);
+            gridPtr_.reset(Dune::BackupRestoreFacility<Grid>::restore(is));
+            restoredFromCache_ = true;
+            if (comm.rank() == 0)
+                std::cout << "Restored the distributed grid from '" << cacheFileName_ << ".*'\n"
+                          << std::flush;
+            return true;
+        }
+        else {
+            if (Dune::MPIHelper::getCommunication().rank() == 0)
+                std::cerr << "Warning: The grid does not support backup and restore, "
+                          << "ignoring the grid cache '" << cacheFileName_ << "'\n";
+            cacheFileName_.clear();
+            return false;
+        }
+    }
+
+    // write the local part of the distributed coarse grid to the cache
+    void writeGridCache_()
+    {
+        if constexpr (Dune::Capabilities::hasBackupRestoreFacilities<Grid>::v) {
+            // the fracture topology is not part of the grid's backup
+            const auto comm = Dune::MPIHelper::getCommunication();
+            if (comm.max(static_cast<int>(hasFractures_)))
+                return;
+
+            std::ofstream os(cacheFilePath_(comm.rank(), comm.size()), std::ios::binary);
+            Dune::BackupRestoreFacility<Grid>::backup(*gridPtr_, os);
+        }
     }
 
 private:
     GridPointer    gridPtr_;
     FractureMapper fractureMapper_;
+    std::string cacheFileName_;
+    bool restoredFromCache_ = false;
+    bool hasFractures_ = false;
 };
 
 } // namespace Opm
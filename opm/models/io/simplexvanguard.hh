@@ -109,7 +109,7 @@ public:
                                                                             cellRes);
 
         unsigned numRefinments = Parameters::get<TypeTag, Properties::GridGlobalRefinements>();
-        simplexGrid_->globalRefine(numRefinments);
+        this->deferGlobalRefinements_(numRefinments);
 
         this->finalizeInit_();
     }
@@ -166,7 +166,7 @@ public:
         gridPtr_.reset( Dune::GridPtr< Grid >( dgffile ).release() );
 
         unsigned numRefinements = Parameters::get<TypeTag, Properties::GridGlobalRefinements>();
-        gridPtr_->globalRefine(static_cast<int>(numRefinements));
+        this->deferGlobalRefinements_(numRefinements);
 
         this->finalizeInit_();
     }
@@ -79,9 +79,7 @@ class UnstructuredGridVanguard : public BaseVanguard<TypeTag> {
         ugPtr_.reset(std::move( grid ));
         //GridPointer polygrid( new Grid(*ugPtr) );
         gridPtr_ = new Grid(*ugPtr_);//std::move(polygrid);
-        if (numRefinments > 0) {
-            gridPtr_->globalRefine(static_cast<int>(numRefinments));
-        }
+        this->deferGlobalRefinements_(numRefinments);
         this->finalizeInit_();
 #endif
     }
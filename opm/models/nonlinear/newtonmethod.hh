@@ -97,6 +97,14 @@ template<class TypeTag>
 struct NewtonTargetIterations<TypeTag, TTag::NewtonMethod> { static constexpr int value = 10; };
 template<class TypeTag>
 struct NewtonMaxIterations<TypeTag, TTag::NewtonMethod> { static constexpr int value = 20; };
+template<class TypeTag>
+struct NewtonJacobianUpdateInterval<TypeTag, TTag::NewtonMethod> { static constexpr int value = 1; };
+template<class TypeTag>
+struct NewtonJacobianReuseRate<TypeTag, TTag::NewtonMethod>
+{
+    using type = GetPropType<TypeTag, Scalar>;
+    static constexpr type value = 0.25;
+};
 
 } // namespace Opm::Properties
 
@@ -140,6 +148,8 @@ public:
         lastError_ = 1e100;
         error_ = 1e100;
         tolerance_ = Parameters::get<TypeTag, Properties::NewtonTolerance>();
+        jacobianUpdateInterval_ = Parameters::get<TypeTag, Properties::NewtonJacobianUpdateInterval>();
+        jacobianReuseRate_ = Parameters::get<TypeTag, Properties::NewtonJacobianReuseRate>();
 
         numIterations_ = 0;
     }
@@ -167,6 +177,13 @@ public:
         Parameters::registerParam<TypeTag, Properties::NewtonMaxError>
             ("The maximum error tolerated by the Newton "
              "method to which does not cause an abort");
+        Parameters::registerParam<TypeTag, Properties::NewtonJacobianUpdateInterval>
+            ("The maximum number of Newton iterations which use the same "
+             "Jacobian matrix and preconditioner. 1 means that the Jacobian "
+             "is updated in every iteration");
+        Parameters::registerParam<TypeTag, Properties::NewtonJacobianReuseRate>
+            ("The maximum ratio of the errors of two successive Newton "
+             "iterations for which the previous Jacobian matrix may be reused");
     }
 
     /*!
@@ -267,6 +284,14 @@ public:
         SolutionVector currentSolution(nextSolution);
         GlobalEqVector solutionUpdate(nextSolution.size());
 
+        // the Jacobian of the previous time step is never reused
+        jacobianAge_ = 0;
+        numReusedJacobians_ = 0;
+        numUpdatedJacobians_ = 0;
+        reusedSolveTime_ = 0.0;
+        updatedSolveTime_ = 0.0;
+        const bool jacobianReuseEnabled = jacobianUpdateInterval_ > 1;
+
         Linearizer& linearizer = model().linearizer();
 
         TimerGuard prePostProcessTimerGuard(prePostProcessTimer_);
@@ -312,6 +337,10 @@ public:
                 auto& residual = linearizer.residual();
                 const auto& jacobian = linearizer.jacobian();
                 linearSolver_.prepare(jacobian, residual);
+                // the linear solver overwrites its right hand side, so the residual
+                // must be set again if the solve with an old Jacobian fails
+                if (jacobianReuseEnabled)
+                    unsyncedResidual_ = residual;
                 linearSolver_.setResidual(residual);
                 linearSolver_.getResidual(residual);
                 solveTimer_.stop();
@@ -345,10 +374,37 @@ public:
 
                 solveTimer_.start();
                 // solve A x = b, where b is the residual, A is its Jacobian and x is the
-                // update of the solution
-                linearSolver_.setMatrix(jacobian);
+                // update of the solution. the Jacobian and the preconditioner of a
+                // previous iteration may be used instead of the current ones.
+                Timer linearSolveTimer;
+                linearSolveTimer.start();
+                bool reuseJacobian = asImp_().reuseJacobian_() && linearSolver_.reuseMatrix();
+                if (!reuseJacobian)
+                    linearSolver_.setMatrix(jacobian);
                 solutionUpdate = 0.0;
                 bool converged = linearSolver_.solve(solutionUpdate);
+                if (!converged && reuseJacobian) {
+                    // the old Jacobian is too far off, try again with the current one
+                    if (asImp_().verbose_())
+                        std::cout << "Newton: Linear solver did not converge with the "
+                                  << "reused Jacobian, updating it\n" << std::flush;
+                    reuseJacobian = false;
+                    linearSolver_.setResidual(unsyncedResidual_);
+                    linearSolver_.setMatrix(jacobian);
+                    solutionUpdate = 0.0;
+                    converged = linearSolver_.solve(solutionUpdate);
+                }
+                linearSolveTimer.stop();
+                if (reuseJacobian) {
+                    ++jacobianAge_;
+                    ++numReusedJacobians_;
+                    reusedSolveTime_ += linearSolveTimer.realTimeElapsed();
+                }
+                else {
+                    jacobianAge_ = 0;
+                    ++numUpdatedJacobians_;
+                    updatedSolveTime_ += linearSolveTimer.realTimeElapsed();
+                }
                 solveTimer_.stop();
 
                 if (!converged) {
@@ -439,6 +495,21 @@ public:
                       << updateTimer_.realTimeElapsed() << "("
                       << 100 * updateTimer_.realTimeElapsed()/elapsedTot << "%)"
                       << "\n" << std::flush;
+
+            if (numReusedJacobians_ > 0) {
+                // the difference of the average solve times approximates the time which
+                // is saved per iteration by not setting up the preconditioner
+                const Scalar reusedTime = reusedSolveTime_/numReusedJacobians_;
+                const Scalar updatedTime =
+                    numUpdatedJacobians_ > 0 ? updatedSolveTime_/numUpdatedJacobians_ : 0.0;
+                std::cout << "Reused the Jacobian in " << numReusedJacobians_ << " of "
+                          << numReusedJacobians_ + numUpdatedJacobians_ << " iterations, "
+                          << "linear solve time per iteration with reused/updated Jacobian: "
+                          << reusedTime << "/" << updatedTime << " seconds, "
+                          << "estimated time saved: "
+                          << numReusedJacobians_*(updatedTime - reusedTime) << " seconds"
+                          << "\n" << std::flush;
+            }
         }
 
 
@@ -642,9 +713,14 @@ protected:
                     const GlobalEqVector&,
                     GlobalEqVector& solutionUpdate)
     {
+        auto& model = simulator_.model();
+
+        // recover the unknowns which the linearizer has condensed out of the linear
+        // system
+        model.linearizer().expandSolutionUpdate(solutionUpdate);
+
         // loop over the auxiliary modules and ask them to post process the solution
         // vector.
-        auto& model = simulator_.model();
         const auto& comm = simulator_.gridView().comm();
         for (unsigned i = 0; i < model.numAuxiliaryModules(); ++i) {
             auto& auxMod = *model.auxiliaryModule(i);
@@ -802,6 +878,33 @@ protected:
         }
     }
 
+    /*!
+     * \brief Returns true if the linear system of the current iteration should be
+     *        solved using the Jacobian matrix and the preconditioner of a previous
+     *        iteration.
+     *
+     * The Jacobian is reused if this has been enabled by the
+     * NewtonJacobianUpdateInterval parameter, it is not older than allowed and the
+     * error of the last iteration has been reduced by at least the factor given by the
+     * NewtonJacobianReuseRate parameter. Otherwise, i.e., if the convergence degrades,
+     * the Jacobian is updated.
+     */
+    bool reuseJacobian_() const
+    {
+        if (jacobianUpdateInterval_ <= 1 || numIterations_ == 0)
+            return false;
+
+        // the data which is required to recover the unknowns that have been condensed
+        // out of the linear system only matches the current Jacobian
+        if (simulator_.model().linearizer().hasCondensedUnknowns())
+            return false;
+
+        if (jacobianAge_ + 1 >= jacobianUpdateInterval_)
+            return false;
+
+        return error_ <= jacobianReuseRate_*lastError_;
+    }
+
     /*!
      * \brief Returns true iff another Newton iteration should be done.
      */
@@ -874,9 +977,23 @@ protected:
     Scalar lastError_;
     Scalar tolerance_;
 
+    // the maximum number of iterations for which a Jacobian matrix is used and the
+    // factor by which the error must be reduced for it to be reused
+    int jacobianUpdateInterval_;
+    Scalar jacobianReuseRate_;
+
     // actual number of iterations done so far
     int numIterations_;
 
+    // the number of iterations since the Jacobian matrix has been updated and the
+    // statistics of the reuse of the Jacobian during the current time step
+    int jacobianAge_ = 0;
+    int numReusedJacobians_ = 0;
+    int numUpdatedJacobians_ = 0;
+    Scalar reusedSolveTime_ = 0.0;
+    Scalar updatedSolveTime_ = 0.0;
+    GlobalEqVector unsyncedResidual_;
+
     // the linear solver
     LinearSolverBackend linearSolver_;
 
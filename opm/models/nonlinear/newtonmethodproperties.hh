@@ -82,6 +82,21 @@ struct NewtonTargetIterations { using type = UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
 struct NewtonMaxIterations { using type = UndefinedProperty; };
 
+/*!
+ * \brief The maximum number of Newton iterations which use the same Jacobian matrix.
+ *
+ * If this is larger than 1, the Jacobian matrix and the preconditioner of the linear
+ * solver of an iteration may be reused by the subsequent iterations (i.e., a chord or
+ * Shamanskii method is used) as long as the error is reduced quickly enough.
+ */
+template<class TypeTag, class MyTypeTag>
+struct NewtonJacobianUpdateInterval { using type = UndefinedProperty; };
+
+//! The maximum ratio between the errors of two successive Newton iterations for which
+//! the Jacobian matrix of the previous iteration may be reused
+template<class TypeTag, class MyTypeTag>
+struct NewtonJacobianReuseRate { using type = UndefinedProperty; };
+
 } // end namespace  Opm::Properties
 
 #endif
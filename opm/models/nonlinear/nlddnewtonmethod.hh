@@ -0,0 +1,661 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::NlddNewtonMethod
+ */
+#ifndef EWOMS_NLDD_NEWTON_METHOD_HH
+#define EWOMS_NLDD_NEWTON_METHOD_HH
+
+#include "newtonmethodproperties.hh"
+
+#include <opm/common/Exceptions.hpp>
+
+#include <opm/models/discretization/common/fvbaseproperties.hh>
+#include <opm/models/utils/parametersystem.hh>
+#include <opm/models/utils/propertysystem.hh>
+#include <opm/models/utils/timer.hh>
+
+#include <opm/simulators/linalg/ilufirstelement.hh>
+
+#include <dune/istl/bcrsmatrix.hh>
+#include <dune/istl/bvector.hh>
+#include <dune/istl/istlexception.hh>
+#include <dune/istl/operators.hh>
+#include <dune/istl/preconditioners.hh>
+#include <dune/istl/solvers.hh>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace Opm::Properties {
+
+//! The number of subdomains into which the process-local grid partition is split
+//! ('0' means 'automatic')
+template<class TypeTag, class MyTypeTag>
+struct NlddNumSubdomains { using type = UndefinedProperty; };
+
+//! The order in which the subdomains see the updates of their neighbors
+//! ("gauss-seidel" or "jacobi")
+template<class TypeTag, class MyTypeTag>
+struct NlddLocalSolveApproach { using type = UndefinedProperty; };
+
+//! The maximum number of Newton iterations for a single subdomain
+template<class TypeTag, class MyTypeTag>
+struct NlddMaxLocalIterations { using type = UndefinedProperty; };
+
+//! The factor by which the tolerance of the global Newton method is multiplied to
+//! get the tolerance of the subdomain solves
+template<class TypeTag, class MyTypeTag>
+struct NlddLocalToleranceScaling { using type = UndefinedProperty; };
+
+//! The residual reduction which the linear solver for the subdomains aims at
+template<class TypeTag, class MyTypeTag>
+struct NlddLocalLinearSolverTolerance { using type = UndefinedProperty; };
+
+template<class TypeTag>
+struct NlddNumSubdomains<TypeTag, TTag::NewtonMethod> { static constexpr int value = 0; };
+template<class TypeTag>
+struct NlddLocalSolveApproach<TypeTag, TTag::NewtonMethod> { static constexpr auto value = "gauss-seidel"; };
+template<class TypeTag>
+struct NlddMaxLocalIterations<TypeTag, TTag::NewtonMethod> { static constexpr int value = 10; };
+template<class TypeTag>
+struct NlddLocalToleranceScaling<TypeTag, TTag::NewtonMethod>
+{
+    using type = GetPropType<TypeTag, Scalar>;
+    static constexpr type value = 1.0;
+};
+template<class TypeTag>
+struct NlddLocalLinearSolverTolerance<TypeTag, TTag::NewtonMethod>
+{
+    using type = GetPropType<TypeTag, Scalar>;
+    static constexpr type value = 1e-3;
+};
+
+} // namespace Opm::Properties
+
+namespace Opm {
+
+/*!
+ * \ingroup Newton
+ *
+ * \brief A non-linearly preconditioned Newton method based on a non-linear domain
+ *        decomposition (NLDD).
+ *
+ * Before each global Newton iteration except the first one, the process-local part of
+ * the grid is split into subdomains for which the non-linear system of equations is
+ * solved individually while the primary variables outside of the subdomain are kept
+ * fixed. Afterwards, a regular global Newton step is taken. Since the strongly
+ * non-linear parts of the problem (e.g. saturation fronts) are usually localized, this
+ * tends to reduce the number of global iterations -- and thus the number of global
+ * linear solves and collective communications -- for difficult time steps.
+ *
+ * The subdomains are obtained by a greedy graph growing partitioner operating on the
+ * connectivity of the interior cells of the process. The subdomain solves can either
+ * be done in Gauss-Seidel fashion (each subdomain sees the updated solution of the
+ * subdomains which have been processed before it) or in Jacobi fashion (all subdomains
+ * start from the same state). Subdomains never span multiple processes, so the local
+ * solves do not require any communication. The subdomains of a process are solved one
+ * after the other while the threads of the process are used to linearize and update
+ * the individual subdomains: All subdomains share the Jacobian matrix and the residual
+ * of the linearizer as well as the intensive quantity cache of the model, and the
+ * Gauss-Seidel approach is inherently sequential.
+ *
+ * This class is layered on top of the Newton method of the actual model, i.e., to use
+ * it for the black-oil model, specify
+ * \code
+ * template<class TypeTag>
+ * struct NewtonMethod<TypeTag, TTag::YourTypeTag>
+ * { using type = Opm::NlddNewtonMethod<TypeTag, Opm::BlackOilNewtonMethod<TypeTag>>; };
+ * \endcode
+ *
+ * The linearizer must be able to linearize subdomains which are specified as a list
+ * of cells, i.e., this requires a cell-centered discretization. Both, the
+ * TpfaLinearizer and the FvBaseLinearizer support this.
+ */
+template <class TypeTag, class BaseNewtonMethod>
+class NlddNewtonMethod : public BaseNewtonMethod
+{
+    using ParentType = BaseNewtonMethod;
+
+    using Scalar = GetPropType<TypeTag, Properties::Scalar>;
+    using Simulator = GetPropType<TypeTag, Properties::Simulator>;
+    using Model = GetPropType<TypeTag, Properties::Model>;
+    using GridView = GetPropType<TypeTag, Properties::GridView>;
+    using Stencil = GetPropType<TypeTag, Properties::Stencil>;
+    using ElementContext = GetPropType<TypeTag, Properties::ElementContext>;
+    using SolutionVector = GetPropType<TypeTag, Properties::SolutionVector>;
+    using GlobalEqVector = GetPropType<TypeTag, Properties::GlobalEqVector>;
+    using PrimaryVariables = GetPropType<TypeTag, Properties::PrimaryVariables>;
+    using EqVector = GetPropType<TypeTag, Properties::EqVector>;
+    using SparseMatrixAdapter = GetPropType<TypeTag, Properties::SparseMatrixAdapter>;
+
+    using Element = typename GridView::template Codim<0>::Entity;
+    using ElementSeed = typename Element::EntitySeed;
+
+    using IstlMatrix = typename SparseMatrixAdapter::IstlMatrix;
+    using MatrixBlock = typename SparseMatrixAdapter::MatrixBlock;
+    using LocalMatrix = Dune::BCRSMatrix<MatrixBlock>;
+    using LocalVector = Dune::BlockVector<EqVector>;
+
+    // the number of cells per subdomain if the number of subdomains is chosen
+    // automatically
+    static constexpr unsigned autoSubdomainSize_ = 1000;
+
+public:
+    /*!
+     * \brief A part of the process-local grid which is solved on its own.
+     *
+     * The data members are named such that objects of this class can be passed to the
+     * linearizeDomain() method of the linearizer.
+     */
+    struct SubDomain
+    {
+        //! The index of the subdomain on the current process
+        unsigned index;
+
+        //! The global indices of the cells of the subdomain in ascending order
+        std::vector<int> cells;
+
+        //! The seeds of the grid elements which correspond to the cells
+        std::vector<ElementSeed> elementSeeds;
+    };
+
+    NlddNewtonMethod(Simulator& simulator)
+        : ParentType(simulator)
+    {
+        numSubdomains_ = Parameters::get<TypeTag, Properties::NlddNumSubdomains>();
+        maxLocalIterations_ = Parameters::get<TypeTag, Properties::NlddMaxLocalIterations>();
+        localToleranceScaling_ = Parameters::get<TypeTag, Properties::NlddLocalToleranceScaling>();
+        localLinearSolverTolerance_ = Parameters::get<TypeTag, Properties::NlddLocalLinearSolverTolerance>();
+
+        const std::string approach = Parameters::get<TypeTag, Properties::NlddLocalSolveApproach>();
+        if (approach == "gauss-seidel")
+            jacobiApproach_ = false;
+        else if (approach == "jacobi")
+            jacobiApproach_ = true;
+        else
+            throw std::invalid_argument("Unknown approach for the local solves of the "
+                                        "non-linear domain decomposition: '" + approach + "'. "
+                                        "Valid choices are 'gauss-seidel' and 'jacobi'.");
+
+        gridSequenceNumber_ = -1;
+    }
+
+    /*!
+     * \brief Register all run-time parameters for the Newton method.
+     */
+    static void registerParameters()
+    {
+        ParentType::registerParameters();
+
+        Parameters::registerParam<TypeTag, Properties::NlddNumSubdomains>
+            ("The number of subdomains per process used by the non-linear domain "
+             "decomposition ('0' means 'automatic')");
+        Parameters::registerParam<TypeTag, Properties::NlddLocalSolveApproach>
+            ("The approach used for the subdomain solves of the non-linear domain "
+             "decomposition ('gauss-seidel' or 'jacobi')");
+        Parameters::registerParam<TypeTag, Properties::NlddMaxLocalIterations>
+            ("The maximum number of Newton iterations for a single subdomain");
+        Parameters::registerParam<TypeTag, Properties::NlddLocalToleranceScaling>
+            ("The factor by which the Newton tolerance is scaled for the subdomain solves");
+        Parameters::registerParam<TypeTag, Properties::NlddLocalLinearSolverTolerance>
+            ("The residual reduction of the linear solver for the subdomain solves");
+    }
+
+    /*!
+     * \brief Returns the subdomains of the current process.
+     *
+     * The subdomains are created lazily, i.e., this is empty before the first subdomain
+     * solve has been attempted.
+     */
+    const std::vector<SubDomain>& subdomains() const
+    { return subdomains_; }
+
+    /*!
+     * \brief Returns the timer which measures the time spent for the subdomain solves.
+     */
+    const Timer& localSolveTimer() const
+    { return localSolveTimer_; }
+
+protected:
+    friend NewtonMethod<TypeTag>;
+    friend ParentType;
+
+    /*!
+     * \copydoc NewtonMethod::begin_
+     */
+    void begin_(const SolutionVector& u)
+    {
+        ParentType::begin_(u);
+
+        localSolveTimer_.halt();
+    }
+
+    /*!
+     * \brief Indicates the beginning of a Newton iteration.
+     *
+     * The subdomain solves are done here because the Newton method considers the
+     * solution at the end of this method to be the one at the beginning of the global
+     * iteration. The first iteration of each time step is always a purely global one:
+     * The linearizer needs a full linearization to update the storage term of the
+     * beginning of the time step, and we do not want to do any local work if the
+     * initial solution is already converged.
+     */
+    void beginIteration_()
+    {
+        ParentType::beginIteration_();
+
+        if (this->numIterations() > 0) {
+            localSolveTimer_.start();
+            solveSubdomains_();
+            localSolveTimer_.stop();
+        }
+    }
+
+private:
+    struct LocalSolveReport
+    {
+        bool converged = false;
+        int iterations = 0;
+    };
+
+    void solveSubdomains_()
+    {
+        if (gridSequenceNumber_ != this->simulator_.vanguard().gridSequenceNumber())
+            createSubdomains_();
+
+        auto& model = this->model();
+        SolutionVector& solution = model.solution(/*timeIdx=*/0);
+
+        // for the Jacobi approach, the results of the subdomain solves are collected in
+        // a separate vector and all subdomains are reset to their initial state after
+        // they have been solved
+        SolutionVector jacobiSolution;
+        if (jacobiApproach_)
+            jacobiSolution = solution;
+
+        // the subdomains are solved one after the other because they use the same
+        // linearizer. the work for a given subdomain is distributed over the threads.
+        int numConverged = 0;
+        int numLocalIterations = 0;
+        for (const auto& domain : subdomains_) {
+            const LocalSolveReport report = solveSubdomain_(domain);
+            numConverged += report.converged ? 1 : 0;
+            numLocalIterations += report.iterations;
+
+            if (jacobiApproach_ && report.iterations > 0) {
+                for (int globI : domain.cells) {
+                    jacobiSolution[globI] = solution[globI];
+                    solution[globI] = iterationStartSolution_[globI];
+                }
+                updateIntensiveQuantities_(domain);
+            }
+        }
+
+        if (jacobiApproach_) {
+            solution = jacobiSolution;
+            for (const auto& domain : subdomains_)
+                updateIntensiveQuantities_(domain);
+        }
+
+        // the values of the overlap and ghost DOFs must be consistent with the ones of
+        // their owners before the global linearization
+        model.syncOverlap();
+
+        if (Parameters::get<TypeTag, Properties::NewtonVerbose>()) {
+            const auto& comm = this->simulator_.gridView().comm();
+            const int numDomains = comm.sum(static_cast<int>(subdomains_.size()));
+            numConverged = comm.sum(numConverged);
+            numLocalIterations = comm.sum(numLocalIterations);
+
+            this->endIterMsg()
+                << ", converged subdomains=" << numConverged << "/" << numDomains
+                << ", local iterations=" << numLocalIterations;
+        }
+    }
+
+    LocalSolveReport solveSubdomain_(const SubDomain& domain)
+    {
+        auto& model = this->model();
+        auto& linearizer = model.linearizer();
+        SolutionVector& solution = model.solution(/*timeIdx=*/0);
+        const std::size_t numCells = domain.cells.size();
+        const Scalar localTolerance = localToleranceScaling_*this->tolerance();
+
+        // remember the state at the beginning of the local solve to be able to roll
+        // back if the subdomain fails to converge
+        for (std::size_t i = 0; i < numCells; ++i) {
+            localIndex_[domain.cells[i]] = static_cast<int>(i);
+            iterationStartSolution_[domain.cells[i]] = solution[domain.cells[i]];
+        }
+
+        LocalSolveReport report;
+        LocalMatrix localMatrix;
+        LocalVector localResidual(numCells);
+        LocalVector localUpdate(numCells);
+        try {
+            for (int iterIdx = 0; ; ++iterIdx) {
+                linearizer.linearizeDomain(domain);
+                const auto& residual = linearizer.residual();
+
+                if (subdomainError_(domain, residual) <= localTolerance) {
+                    report.converged = true;
+                    break;
+                }
+                else if (iterIdx >= maxLocalIterations_)
+                    break;
+
+                const auto& jacobian = linearizer.jacobian().istlMatrix();
+                if (iterIdx == 0)
+                    createLocalMatrix_(domain, jacobian, localMatrix);
+                assembleLocalSystem_(domain, jacobian, residual, localMatrix, localResidual);
+
+                localUpdate = 0.0;
+                if (!solveLocalLinearSystem_(localMatrix, localUpdate, localResidual))
+                    break;
+
+                for (std::size_t i = 0; i < numCells; ++i) {
+                    const unsigned globI = domain.cells[i];
+                    const PrimaryVariables currentValue(solution[globI]);
+                    this->updatePrimaryVariables_(globI,
+                                                  solution[globI],
+                                                  currentValue,
+                                                  localUpdate[i],
+                                                  residual[globI]);
+                }
+                updateIntensiveQuantities_(domain);
+                ++report.iterations;
+            }
+        }
+        catch (const Dune::Exception&) {
+            report.converged = false;
+        }
+        catch (const NumericalProblem&) {
+            report.converged = false;
+        }
+
+        if (!report.converged && report.iterations > 0) {
+            // the subdomain did not converge. since the local solution is most likely
+            // garbage, we discard it and let the global iteration deal with it
+            for (int globI : domain.cells)
+                solution[globI] = iterationStartSolution_[globI];
+            updateIntensiveQuantities_(domain);
+            report.iterations = 0;
+        }
+
+        for (int globI : domain.cells)
+            localIndex_[globI] = -1;
+
+        return report;
+    }
+
+    // the maximum weighted residual of the cells of a subdomain
+    Scalar subdomainError_(const SubDomain& domain, const GlobalEqVector& residual) const
+    {
+        const auto& model = this->model();
+
+        Scalar result = 0.0;
+        for (int globI : domain.cells) {
+            if (model.dofTotalVolume(globI) <= 0.0)
+                continue;
+
+            const auto& r = residual[globI];
+            for (unsigned eqIdx = 0; eqIdx < r.size(); ++eqIdx)
+                result = std::max(std::abs(r[eqIdx]*model.eqWeight(globI, eqIdx)), result);
+        }
+
+        return result;
+    }
+
+    // create the sparsity pattern of the Jacobian matrix of a subdomain, i.e., the
+    // part of the global matrix which couples the cells of the subdomain with each other
+    void createLocalMatrix_(const SubDomain& domain,
+                            const IstlMatrix& globalMatrix,
+                            LocalMatrix& localMatrix) const
+    {
+        const std::size_t numCells = domain.cells.size();
+
+        std::size_t numNonZeros = 0;
+        for (int globI : domain.cells) {
+            const auto& globalRow = globalMatrix[globI];
+            for (auto colIt = globalRow.begin(); colIt != globalRow.end(); ++colIt)
+                if (localIndex_[colIt.index()] >= 0)
+                    ++numNonZeros;
+        }
+
+        localMatrix.setSize(numCells, numCells, numNonZeros);
+        localMatrix.setBuildMode(LocalMatrix::row_wise);
+        for (auto rowIt = localMatrix.createbegin(); rowIt != localMatrix.createend(); ++rowIt) {
+            const auto& globalRow = globalMatrix[domain.cells[rowIt.index()]];
+            for (auto colIt = globalRow.begin(); colIt != globalRow.end(); ++colIt) {
+                const int localColIdx = localIndex_[colIt.index()];
+                if (localColIdx >= 0)
+                    rowIt.insert(localColIdx);
+            }
+        }
+    }
+
+    void assembleLocalSystem_(const SubDomain& domain,
+                              const IstlMatrix& globalMatrix,
+                              const GlobalEqVector& globalResidual,
+                              LocalMatrix& localMatrix,
+                              LocalVector& localResidual) const
+    {
+        const std::size_t numCells = domain.cells.size();
+        for (std::size_t i = 0; i < numCells; ++i) {
+            const unsigned globI = domain.cells[i];
+            localResidual[i] = globalResidual[globI];
+
+            const auto& globalRow = globalMatrix[globI];
+            auto& localRow = localMatrix[i];
+            for (auto colIt = globalRow.begin(); colIt != globalRow.end(); ++colIt) {
+                const int localColIdx = localIndex_[colIt.index()];
+                if (localColIdx >= 0)
+                    localRow[localColIdx] = *colIt;
+            }
+        }
+    }
+
+    bool solveLocalLinearSystem_(const LocalMatrix& localMatrix,
+                                 LocalVector& x,
+                                 LocalVector& b) const
+    {
+        using LocalOperator = Dune::MatrixAdapter<LocalMatrix, LocalVector, LocalVector>;
+        using LocalPreconditioner = Dune::SeqILU<LocalMatrix, LocalVector, LocalVector>;
+        using LocalSolver = Dune::BiCGSTABSolver<LocalVector>;
+
+        LocalOperator localOperator(localMatrix);
+        LocalPreconditioner localPreconditioner(localMatrix, /*relaxationFactor=*/1.0);
+        LocalSolver localSolver(localOperator,
+                                localPreconditioner,
+                                localLinearSolverTolerance_,
+                                /*maxIterations=*/200,
+                                /*verbosity=*/0);
+
+        // the subdomain solves only serve as a preconditioner for the global Newton
+        // method, so an update which does not achieve the requested residual reduction
+        // is still acceptable as long as it is finite.
+        Dune::InverseOperatorResult result;
+        localSolver.apply(x, b, result);
+
+        return std::isfinite(x.two_norm());
+    }
+
+    // recalculate the intensive quantities of all cells of a subdomain and store them
+    // in the cache of the model
+    void updateIntensiveQuantities_(const SubDomain& domain) const
+    {
+        const auto& model = this->model();
+        const auto& grid = this->simulator_.gridView().grid();
+        const int numElements = domain.elementSeeds.size();
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            ElementContext elemCtx(this->simulator_);
+#ifdef _OPENMP
+#pragma omp for
+#endif
+            for (int elemIdx = 0; elemIdx < numElements; ++elemIdx) {
+                const auto elem = grid.entity(domain.elementSeeds[elemIdx]);
+                elemCtx.updatePrimaryStencil(elem);
+                const std::size_t numPrimaryDof = elemCtx.numPrimaryDof(/*timeIdx=*/0);
+                for (unsigned dofIdx = 0; dofIdx < numPrimaryDof; ++dofIdx) {
+                    const unsigned globalIdx = elemCtx.globalSpaceIndex(dofIdx, /*timeIdx=*/0);
+                    model.setIntensiveQuantitiesCacheEntryValidity(globalIdx, /*timeIdx=*/0, false);
+                }
+                elemCtx.updatePrimaryIntensiveQuantities(/*timeIdx=*/0);
+            }
+        }
+    }
+
+    // partition the interior cells of the process into subdomains using a greedy graph
+    // growing algorithm: starting at the unassigned cell with the lowest index, a
+    // subdomain is grown in breadth-first order until it exhibits the target size.
+    void createSubdomains_()
+    {
+        const auto& model = this->model();
+        const auto& gridView = this->simulator_.gridView();
+        const unsigned numGridDof = model.numGridDof();
+
+        // determine the connectivity graph of the interior cells
+        std::vector<std::vector<unsigned>> neighbors(numGridDof);
+        std::vector<ElementSeed> elementSeeds(numGridDof);
+        std::vector<bool> isInterior(numGridDof, false);
+        unsigned numInterior = 0;
+        Stencil stencil(gridView, model.dofMapper());
+        for (const auto& elem : elements(gridView)) {
+            if (elem.partitionType() != Dune::InteriorEntity)
+                continue;
+
+            stencil.update(elem);
+            if (stencil.numPrimaryDof() != 1)
+                throw std::logic_error("The non-linear domain decomposition requires a "
+                                       "cell-centered discretization");
+
+            const unsigned globI = stencil.globalSpaceIndex(/*dofIdx=*/0);
+            isInterior[globI] = true;
+            elementSeeds[globI] = elem.seed();
+            ++numInterior;
+            for (unsigned dofIdx = 1; dofIdx < stencil.numDof(); ++dofIdx)
+                neighbors[globI].push_back(stencil.globalSpaceIndex(dofIdx));
+        }
+
+        unsigned numSubdomains = numSubdomains_;
+        if (numSubdomains == 0)
+            numSubdomains = (numInterior + autoSubdomainSize_ - 1)/autoSubdomainSize_;
+        numSubdomains = std::max(1u, std::min(numSubdomains, numInterior));
+        const unsigned targetSize = (numInterior + numSubdomains - 1)/numSubdomains;
+
+        std::vector<int> domainIndex(numGridDof, -1);
+        std::vector<unsigned> front;
+        unsigned curDomainIdx = 0;
+        unsigned curDomainSize = 0;
+        for (unsigned seedIdx = 0; seedIdx < numGridDof; ++seedIdx) {
+            if (!isInterior[seedIdx] || domainIndex[seedIdx] >= 0)
+                continue;
+
+            // if the connected component of the current subdomain is exhausted before
+            // the subdomain has reached its target size, the subdomain is continued at
+            // the next seed
+            front.assign(1, seedIdx);
+            domainIndex[seedIdx] = curDomainIdx;
+            ++curDomainSize;
+            for (std::size_t headIdx = 0;
+                 headIdx < front.size() && curDomainSize < targetSize;
+                 ++headIdx)
+            {
+                for (unsigned nbIdx : neighbors[front[headIdx]]) {
+                    if (!isInterior[nbIdx] || domainIndex[nbIdx] >= 0)
+                        continue;
+
+                    domainIndex[nbIdx] = curDomainIdx;
+                    front.push_back(nbIdx);
+                    if (++curDomainSize >= targetSize)
+                        break;
+                }
+            }
+
+            if (curDomainSize >= targetSize) {
+                ++curDomainIdx;
+                curDomainSize = 0;
+            }
+        }
+        if (curDomainSize > 0)
+            ++curDomainIdx;
+
+        subdomains_.clear();
+        subdomains_.resize(curDomainIdx);
+        for (unsigned domainIdx = 0; domainIdx < curDomainIdx; ++domainIdx)
+            subdomains_[domainIdx].index = domainIdx;
+        for (unsigned globI = 0; globI < numGridDof; ++globI) {
+            if (domainIndex[globI] < 0)
+                continue;
+
+            auto& domain = subdomains_[domainIndex[globI]];
+            domain.cells.push_back(globI);
+            domain.elementSeeds.push_back(elementSeeds[globI]);
+        }
+
+        localIndex_.assign(numGridDof, -1);
+        iterationStartSolution_.resize(numGridDof);
+        gridSequenceNumber_ = this->simulator_.vanguard().gridSequenceNumber();
+
+        if (Parameters::get<TypeTag, Properties::NewtonVerbose>()) {
+            const auto& comm = gridView.comm();
+            const unsigned numTotalInterior = comm.sum(numInterior);
+            const unsigned numTotalSubdomains = comm.sum(static_cast<unsigned>(subdomains_.size()));
+            if (this->verbose_())
+                std::cout << "Non-linear domain decomposition: Split " << numTotalInterior
+                          << " interior cells of " << comm.size() << " process(es) into "
+                          << numTotalSubdomains << " subdomains\n" << std::flush;
+        }
+    }
+
+    std::vector<SubDomain> subdomains_;
+    int gridSequenceNumber_;
+
+    // maps the global index of a cell to its index within the subdomain which is
+    // currently solved. (-1 for cells outside of that subdomain.)
+    std::vector<int> localIndex_;
+    // the solution of the cells of the current subdomain before its local solve
+    std::vector<PrimaryVariables> iterationStartSolution_;
+
+    Timer localSolveTimer_;
+
+    int numSubdomains_;
+    int maxLocalIterations_;
+    Scalar localToleranceScaling_;
+    Scalar localLinearSolverTolerance_;
+    bool jacobiApproach_;
+};
+
+} // namespace Opm
+
+#endif
@@ -0,0 +1,648 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::ReorderingTransportSolver
+ */
+#ifndef EWOMS_REORDERING_TRANSPORT_SOLVER_HH
+#define EWOMS_REORDERING_TRANSPORT_SOLVER_HH
+
+#include "newtonmethodproperties.hh"
+
+#include <opm/common/Exceptions.hpp>
+
+#include <opm/models/discretization/common/fvbaseproperties.hh>
+#include <opm/models/utils/parametersystem.hh>
+#include <opm/models/utils/propertysystem.hh>
+#include <opm/models/utils/stronglyconnectedcomponents.hh>
+
+#include <dune/common/fmatrix.hh>
+#include <dune/common/fvector.hh>
+#include <dune/grid/common/gridenums.hh>
+#include <dune/istl/bcrsmatrix.hh>
+#include <dune/istl/bvector.hh>
+#include <dune/istl/istlexception.hh>
+#include <dune/istl/operators.hh>
+#include <dune/istl/preconditioners.hh>
+#include <dune/istl/solvers.hh>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace Opm::Properties {
+
+//! The maximum number of Newton iterations for a strongly connected component of the
+//! reordering transport solver
+template<class TypeTag, class MyTypeTag>
+struct ReorderingTransportMaxLocalIterations { using type = UndefinedProperty; };
+
+template<class TypeTag>
+struct ReorderingTransportMaxLocalIterations<TypeTag, TTag::NewtonMethod> { static constexpr int value = 20; };
+
+} // namespace Opm::Properties
+
+namespace Opm {
+
+/*!
+ * \ingroup Newton
+ *
+ * \brief Solves the transport equations of the black-oil model for a fixed pressure
+ *        by reordering the cells along the direction of the flow.
+ *
+ * With fixed pressures, the upwind fluxes of a cell only depend on the cell itself
+ * and on the neighbors from which fluid flows into it. If cell i depends on cell j
+ * in this sense, the graph of these dependencies is acyclic except for the cells
+ * which form cycles through counter-current flow, i.e., its strongly connected
+ * components. Ordering the components such that each comes after the ones it
+ * depends on makes the transport system block lower-triangular, so it can be solved
+ * by local Newton iterations for one component after the other: Most components
+ * consist of a single cell and their local system is a single block of the
+ * Jacobian matrix.
+ *
+ * The flow directions are determined from the signs of the fluxes over the faces
+ * at the beginning of the solve. Components which do not depend on each other are
+ * grouped into levels and the components of a level are solved in parallel. The
+ * conservation equation of each cell with the largest quasi-IMPES weight is
+ * replaced by the condition that the pressure stays constant, like in
+ * SequentialImplicitNewtonMethod.
+ *
+ * Only the cells in the interior of the process are solved, the ones outside of it
+ * are kept fixed. The intensive quantities must be stored by the model and the
+ * linearizer must be able to evaluate single cells, see
+ * TpfaLinearizer::linearizeCell() and FvBaseLinearizer::linearizeCell().
+ */
+template <class TypeTag>
+class ReorderingTransportSolver
+{
+    using Scalar = GetPropType<TypeTag, Properties::Scalar>;
+    using Simulator = GetPropType<TypeTag, Properties::Simulator>;
+    using GridView = GetPropType<TypeTag, Properties::GridView>;
+    using Stencil = GetPropType<TypeTag, Properties::Stencil>;
+    using ElementContext = GetPropType<TypeTag, Properties::ElementContext>;
+    using IntensiveQuantities = GetPropType<TypeTag, Properties::IntensiveQuantities>;
+    using Indices = GetPropType<TypeTag, Properties::Indices>;
+    using PrimaryVariables = GetPropType<TypeTag, Properties::PrimaryVariables>;
+    using SparseMatrixAdapter = GetPropType<TypeTag, Properties::SparseMatrixAdapter>;
+
+    using Element = typename GridView::template Codim<0>::Entity;
+    using ElementSeed = typename Element::EntitySeed;
+
+    enum { numEq = getPropValue<TypeTag, Properties::NumEq>() };
+    enum { pressureVarIdx = Indices::pressureSwitchIdx };
+
+    using VectorBlock = Dune::FieldVector<Scalar, numEq>;
+    using MatrixBlock = typename SparseMatrixAdapter::MatrixBlock;
+    using LocalMatrix = Dune::BCRSMatrix<MatrixBlock>;
+    using LocalVector = Dune::BlockVector<VectorBlock>;
+
+public:
+    ReorderingTransportSolver(Simulator& simulator)
+        : simulator_(simulator)
+    {
+        maxLocalIterations_ = Parameters::get<TypeTag, Properties::ReorderingTransportMaxLocalIterations>();
+        gridSequenceNumber_ = -1;
+    }
+
+    /*!
+     * \brief Register all run-time parameters of the solver.
+     */
+    static void registerParameters()
+    {
+        Parameters::registerParam<TypeTag, Properties::ReorderingTransportMaxLocalIterations>
+            ("The maximum number of Newton iterations for a strongly connected "
+             "component of the reordering transport solver");
+    }
+
+    /*!
+     * \brief Solve the transport equations of all interior cells.
+     *
+     * The primary variables and the cached intensive quantities of the model are
+     * updated in place. The primary variables of a cell are updated using
+     * updateFn(globalIdx, nextValue, currentValue, update, residual), which
+     * follows the conventions of NewtonMethod::updatePrimaryVariables_(). It is not
+     * called concurrently.
+     *
+     * \param tolerance The maximum weighted residual of the transport equations
+     *                  at which a component is considered converged
+     * \param updateFn The function which updates the primary variables of a cell
+     * \return The maximum number of iterations needed by a component
+     *
+     * Components which have not converged after the maximum number of local
+     * iterations keep the last iterate. Their number is returned by
+     * numUnconvergedComponents().
+     */
+    template <class UpdateFn>
+    int solve(Scalar tolerance, UpdateFn&& updateFn)
+    {
+        auto& model = simulator_.model();
+        if (!model.storeIntensiveQuantities())
+            throw std::logic_error("The reordering transport solver requires the "
+                                   "intensive quantities to be stored");
+
+        if (gridSequenceNumber_ != simulator_.vanguard().gridSequenceNumber())
+            setup_();
+
+        computeOrdering_();
+
+        auto& solution = model.solution(/*timeIdx=*/0);
+        const auto& grid = simulator_.gridView().grid();
+        const auto& levelComponents = scc_.componentsByLevel();
+        const unsigned numLevels = static_cast<unsigned>(scc_.numLevels());
+        int maxIterations = 0;
+        int numFailed = 0;
+        int numUnconverged = 0;
+
+#ifdef _OPENMP
+#pragma omp parallel reduction(max:maxIterations) reduction(+:numFailed) reduction(+:numUnconverged)
+#endif
+        {
+            ElementContext elemCtx(simulator_);
+            LocalSystem_ sys;
+            for (unsigned levelIdx = 0; levelIdx < numLevels; ++levelIdx) {
+                const long begin = scc_.levelBegin(levelIdx);
+                const long end = scc_.levelEnd(levelIdx);
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+                for (long i = begin; i < end; ++i) {
+                    const unsigned compIdx = levelComponents[i];
+                    bool converged = true;
+                    const int iterations = solveComponent_(compIdx, tolerance, elemCtx, sys, updateFn, converged);
+                    if (iterations < 0)
+                        ++numFailed;
+                    else
+                        maxIterations = std::max(maxIterations, iterations);
+                    if (iterations >= 0 && !converged)
+                        ++numUnconverged;
+                }
+
+                // the components of the next levels must see the intensive quantities
+                // of the cells which have been updated. these cannot be written to the
+                // cache while the components are solved because other components of
+                // the level may be reading it.
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+                for (long i = begin; i < end; ++i) {
+                    const unsigned compIdx = levelComponents[i];
+                    for (const unsigned* c = scc_.componentBegin(compIdx); c != scc_.componentEnd(compIdx); ++c) {
+                        if (!changed_[*c])
+                            continue;
+
+                        changed_[*c] = 0;
+                        try {
+                            const auto elem = grid.entity(elementSeeds_[*c]);
+                            elemCtx.updatePrimaryStencil(elem);
+                            elemCtx.updateIntensiveQuantities(solution[*c], /*dofIdx=*/0, /*timeIdx=*/0);
+                            model.updateCachedIntensiveQuantities(elemCtx.intensiveQuantities(/*dofIdx=*/0,
+                                                                                              /*timeIdx=*/0),
+                                                                  *c,
+                                                                  /*timeIdx=*/0);
+                        }
+                        catch (...) {
+                            ++numFailed;
+                        }
+                    }
+                }
+            }
+        }
+
+        numComponentsSolved_ = 0;
+        numUnconvergedComponents_ = static_cast<std::size_t>(numUnconverged);
+        largestComponentSize_ = 0;
+        for (unsigned compIdx = 0; compIdx < scc_.numComponents(); ++compIdx) {
+            if (!isInterior_[*scc_.componentBegin(compIdx)])
+                continue;
+            ++numComponentsSolved_;
+            largestComponentSize_ = std::max(largestComponentSize_, scc_.componentSize(compIdx));
+        }
+
+        if (numFailed > 0)
+            throw NumericalProblem("The local Newton method of the reordering transport solver "
+                                   "failed for " + std::to_string(numFailed) + " components");
+
+        return maxIterations;
+    }
+
+    /*!
+     * \brief Returns the number of strongly connected components of interior cells of
+     *        the last solve.
+     */
+    std::size_t numComponents() const
+    { return numComponentsSolved_; }
+
+    /*!
+     * \brief Returns the number of components of the last solve for which the local
+     *        Newton method did not converge within the maximum number of iterations.
+     */
+    std::size_t numUnconvergedComponents() const
+    { return numUnconvergedComponents_; }
+
+    /*!
+     * \brief Returns the number of cells of the largest strongly connected component
+     *        of the last solve.
+     */
+    unsigned largestComponentSize() const
+    { return largestComponentSize_; }
+
+    /*!
+     * \brief Returns the number of levels of the components of the last solve.
+     *
+     * This is the number of sequential steps which cannot be parallelized.
+     */
+    std::size_t numLevels() const
+    { return scc_.numLevels(); }
+
+private:
+    // the data of the local Newton method of a component. the objects are reused for
+    // all components which are solved by a thread to avoid allocations.
+    struct LocalSystem_
+    {
+        std::vector<PrimaryVariables> priVars;
+        std::vector<IntensiveQuantities> intQuants;
+        std::vector<VectorBlock> residual;
+        std::vector<MatrixBlock> diagonal;
+        std::vector<unsigned> droppedEqIdx;
+        LocalMatrix matrix;
+        LocalVector rhs;
+        LocalVector update;
+    };
+
+    // determine the interior cells, their neighbors and their grid elements
+    void setup_()
+    {
+        const auto& model = simulator_.model();
+        const auto& gridView = simulator_.gridView();
+        const unsigned numGridDof = model.numGridDof();
+
+        isInterior_.assign(numGridDof, 0);
+        elementSeeds_.resize(numGridDof);
+        std::vector<std::vector<unsigned>> neighbors(numGridDof);
+        Stencil stencil(gridView, model.dofMapper());
+        for (const auto& elem : elements(gridView)) {
+            stencil.update(elem);
+            if (stencil.numPrimaryDof() != 1)
+                throw std::logic_error("The reordering transport solver requires a "
+                                       "cell-centered discretization");
+
+            const unsigned globI = stencil.globalSpaceIndex(/*dofIdx=*/0);
+            isInterior_[globI] = elem.partitionType() == Dune::InteriorEntity;
+            elementSeeds_[globI] = elem.seed();
+            for (unsigned dofIdx = 1; dofIdx < stencil.numDof(); ++dofIdx)
+                neighbors[globI].push_back(stencil.globalSpaceIndex(dofIdx));
+        }
+
+        // the faces are stored in the order in which the linearizer visits them
+        neighborOffsets_.assign(1, 0);
+        neighbors_.clear();
+        for (const auto& nb : neighbors) {
+            neighbors_.insert(neighbors_.end(), nb.begin(), nb.end());
+            neighborOffsets_.push_back(static_cast<unsigned>(neighbors_.size()));
+        }
+
+        isUpwindFace_.resize(neighbors_.size());
+        changed_.assign(numGridDof, 0);
+        localIdx_.resize(numGridDof);
+
+        gridSequenceNumber_ = simulator_.vanguard().gridSequenceNumber();
+    }
+
+    // determine the upwind graph of the interior cells and its strongly connected
+    // components. cell i depends on its neighbor j if any component flows from j to
+    // i.
+    void computeOrdering_()
+    {
+        auto& model = simulator_.model();
+        auto& linearizer = model.linearizer();
+        const long numGridDof = static_cast<long>(model.numGridDof());
+        const auto cachedIntQuants = [&model](unsigned globalIdx) -> const IntensiveQuantities&
+        { return *model.cachedIntensiveQuantities(globalIdx, /*timeIdx=*/0); };
+        std::exception_ptr exceptionPtr = nullptr;
+
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (long globI = 0; globI < numGridDof; ++globI) {
+            const unsigned begin = neighborOffsets_[globI];
+            const unsigned end = neighborOffsets_[globI + 1];
+            std::fill(isUpwindFace_.begin() + begin, isUpwindFace_.begin() + end, 0);
+            if (!isInterior_[globI])
+                continue;
+
+            VectorBlock res;
+            MatrixBlock diag;
+            unsigned faceIdx = begin;
+            try {
+                linearizer.linearizeCell(static_cast<unsigned>(globI), cachedIntQuants, res, diag,
+                                         [&](unsigned globJ, const VectorBlock& flux, const MatrixBlock&)
+                                         {
+                                             assert(faceIdx < end && neighbors_[faceIdx] == globJ);
+                                             bool inflow = false;
+                                             for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                                                 inflow = inflow || flux[eqIdx] < 0.0;
+                                             isUpwindFace_[faceIdx++] = inflow && isInterior_[globJ];
+                                         });
+            }
+            catch (...) {
+                // exceptions must not leave the parallel region, rethrow one of them
+                // afterwards
+#ifdef _OPENMP
+#pragma omp critical(ReorderingTransportSolver_exception)
+#endif
+                exceptionPtr = std::current_exception();
+            }
+        }
+
+        if (exceptionPtr)
+            std::rethrow_exception(exceptionPtr);
+
+        edgeOffsets_.assign(1, 0);
+        edges_.clear();
+        for (long globI = 0; globI < numGridDof; ++globI) {
+            for (unsigned faceIdx = neighborOffsets_[globI]; faceIdx < neighborOffsets_[globI + 1]; ++faceIdx)
+                if (isUpwindFace_[faceIdx])
+                    edges_.push_back(neighbors_[faceIdx]);
+            edgeOffsets_.push_back(static_cast<unsigned>(edges_.size()));
+        }
+
+        scc_.compute(edgeOffsets_, edges_);
+    }
+
+    // do Newton iterations for the transport equations of the cells of a component
+    // while the rest of the grid is fixed. returns the number of iterations or -1 if
+    // the local Newton method failed, in which case the cells are left unchanged.
+    // converged is set to false if the tolerance has not been reached within the
+    // maximum number of iterations.
+    template <class UpdateFn>
+    int solveComponent_(unsigned compIdx,
+                        Scalar tolerance,
+                        ElementContext& elemCtx,
+                        LocalSystem_& sys,
+                        UpdateFn& updateFn,
+                        bool& converged)
+    {
+        auto& model = simulator_.model();
+        auto& linearizer = model.linearizer();
+        const auto& grid = simulator_.gridView().grid();
+        auto& solution = model.solution(/*timeIdx=*/0);
+
+        const unsigned* cells = scc_.componentBegin(compIdx);
+        const unsigned size = scc_.componentSize(compIdx);
+        if (!isInterior_[cells[0]])
+            return 0;
+
+        sys.priVars.clear();
+        sys.intQuants.clear();
+        for (unsigned k = 0; k < size; ++k) {
+            localIdx_[cells[k]] = k;
+            sys.priVars.push_back(solution[cells[k]]);
+            sys.intQuants.push_back(*model.cachedIntensiveQuantities(cells[k], /*timeIdx=*/0));
+        }
+        sys.residual.resize(size);
+        sys.diagonal.resize(size);
+        sys.droppedEqIdx.resize(size);
+        if (size > 1)
+            createLocalMatrix_(compIdx, sys);
+
+        const auto intQuants = [&](unsigned globalIdx) -> const IntensiveQuantities&
+        {
+            if (scc_.component(globalIdx) == compIdx)
+                return sys.intQuants[localIdx_[globalIdx]];
+            return *model.cachedIntensiveQuantities(globalIdx, /*timeIdx=*/0);
+        };
+
+        int iterIdx = 0;
+        try {
+            for (; ; ++iterIdx) {
+                if (size > 1)
+                    sys.matrix = 0.0;
+
+                for (unsigned k = 0; k < size; ++k) {
+                    linearizer.linearizeCell(cells[k], intQuants, sys.residual[k], sys.diagonal[k],
+                                             [&](unsigned globJ, const VectorBlock&, const MatrixBlock& fluxDeriv)
+                                             {
+                                                 // the derivative of the neighbor's
+                                                 // residual is the negative one
+                                                 if (size > 1 && scc_.component(globJ) == compIdx)
+                                                     sys.matrix[localIdx_[globJ]][k] -= fluxDeriv;
+                                             });
+                    if (iterIdx == 0)
+                        sys.droppedEqIdx[k] = droppedEquation_(sys.diagonal[k]);
+                }
+
+                converged = error_(cells, sys) <= tolerance;
+                if (converged || iterIdx >= maxLocalIterations_)
+                    break;
+
+                if (!solveLocalSystem_(size, sys))
+                    return -1;
+
+                for (unsigned k = 0; k < size; ++k) {
+                    const PrimaryVariables currentValue(sys.priVars[k]);
+#ifdef _OPENMP
+#pragma omp critical(ReorderingTransportSolver_update)
+#endif
+                    updateFn(cells[k], sys.priVars[k], currentValue, sys.update[k], sys.residual[k]);
+
+                    const auto elem = grid.entity(elementSeeds_[cells[k]]);
+                    elemCtx.updatePrimaryStencil(elem);
+                    elemCtx.updateIntensiveQuantities(sys.priVars[k], /*dofIdx=*/0, /*timeIdx=*/0);
+                    sys.intQuants[k] = elemCtx.intensiveQuantities(/*dofIdx=*/0, /*timeIdx=*/0);
+                }
+            }
+        }
+        catch (...) {
+            // exceptions must not leave the parallel region
+            return -1;
+        }
+
+        if (iterIdx > 0) {
+            for (unsigned k = 0; k < size; ++k) {
+                solution[cells[k]] = sys.priVars[k];
+                changed_[cells[k]] = 1;
+            }
+        }
+
+        return iterIdx;
+    }
+
+    // the matrix of a component contains the couplings between its cells
+    void createLocalMatrix_(unsigned compIdx, LocalSystem_& sys) const
+    {
+        const unsigned* cells = scc_.componentBegin(compIdx);
+        const unsigned size = scc_.componentSize(compIdx);
+
+        sys.matrix.setSize(0, 0);
+        sys.matrix.setSize(size, size);
+        sys.matrix.setBuildMode(LocalMatrix::row_wise);
+        for (auto rowIt = sys.matrix.createbegin(); rowIt != sys.matrix.createend(); ++rowIt) {
+            const unsigned globI = cells[rowIt.index()];
+            rowIt.insert(rowIt.index());
+            for (unsigned faceIdx = neighborOffsets_[globI]; faceIdx < neighborOffsets_[globI + 1]; ++faceIdx) {
+                const unsigned globJ = neighbors_[faceIdx];
+                if (scc_.component(globJ) == compIdx)
+                    rowIt.insert(localIdx_[globJ]);
+            }
+        }
+
+        sys.rhs.resize(size);
+        sys.update.resize(size);
+    }
+
+    // the index of the conservation equation with the largest quasi-IMPES weight
+    static unsigned droppedEquation_(const MatrixBlock& diag)
+    {
+        Dune::FieldMatrix<Scalar, numEq, numEq> diagT;
+        for (int i = 0; i < numEq; ++i)
+            for (int j = 0; j < numEq; ++j)
+                diagT[i][j] = diag[j][i];
+
+        VectorBlock w;
+        VectorBlock unitPressure(0.0);
+        unitPressure[pressureVarIdx] = 1.0;
+        try {
+            diagT.solve(w, unitPressure);
+        }
+        catch (const Dune::FMatrixError&) {
+            return 0;
+        }
+
+        unsigned droppedEqIdx = 0;
+        for (unsigned eqIdx = 1; eqIdx < numEq; ++eqIdx)
+            if (std::abs(w[eqIdx]) > std::abs(w[droppedEqIdx]))
+                droppedEqIdx = eqIdx;
+        return droppedEqIdx;
+    }
+
+    // the maximum weighted residual of the transport equations of a component
+    Scalar error_(const unsigned* cells, const LocalSystem_& sys) const
+    {
+        const auto& model = simulator_.model();
+
+        Scalar result = 0.0;
+        for (unsigned k = 0; k < sys.residual.size(); ++k) {
+            if (model.dofTotalVolume(cells[k]) <= 0.0)
+                continue;
+
+            for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx) {
+                if (eqIdx == sys.droppedEqIdx[k])
+                    continue;
+                const Scalar r = sys.residual[k][eqIdx]*model.eqWeight(cells[k], eqIdx);
+                if (!std::isfinite(r))
+                    throw NumericalProblem("Non-finite residual in the reordering transport solver");
+                result = std::max(std::abs(r), result);
+            }
+        }
+
+        return result;
+    }
+
+    // solve for the update of the non-pressure primary variables. like in the
+    // transport stage of the sequential implicit method, the dropped equation is
+    // replaced by the condition that the pressure stays constant.
+    bool solveLocalSystem_(unsigned size, LocalSystem_& sys) const
+    {
+        const auto fixPressure = [&sys](unsigned k, MatrixBlock& block, bool isDiagonal)
+        {
+            const unsigned droppedEqIdx = sys.droppedEqIdx[k];
+            for (unsigned pvIdx = 0; pvIdx < numEq; ++pvIdx)
+                block[droppedEqIdx][pvIdx] = 0.0;
+            for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                block[eqIdx][pressureVarIdx] = 0.0;
+            if (isDiagonal)
+                block[droppedEqIdx][pressureVarIdx] = 1.0;
+        };
+
+        if (size == 1) {
+            MatrixBlock& diag = sys.diagonal[0];
+            fixPressure(0, diag, /*isDiagonal=*/true);
+            VectorBlock rhs(sys.residual[0]);
+            rhs[sys.droppedEqIdx[0]] = 0.0;
+
+            sys.update.resize(1);
+            diag.solve(sys.update[0], rhs);
+            return std::isfinite(sys.update[0].two_norm());
+        }
+
+        for (unsigned k = 0; k < size; ++k) {
+            auto& row = sys.matrix[k];
+            row[k] += sys.diagonal[k];
+            for (auto colIt = row.begin(); colIt != row.end(); ++colIt)
+                fixPressure(k, *colIt, colIt.index() == k);
+
+            sys.rhs[k] = sys.residual[k];
+            sys.rhs[k][sys.droppedEqIdx[k]] = 0.0;
+        }
+
+        using Operator = Dune::MatrixAdapter<LocalMatrix, LocalVector, LocalVector>;
+        using Preconditioner = Dune::SeqILU<LocalMatrix, LocalVector, LocalVector>;
+
+        Operator op(sys.matrix);
+        Preconditioner preconditioner(sys.matrix, /*relaxationFactor=*/1.0);
+        Dune::BiCGSTABSolver<LocalVector> solver(op,
+                                                 preconditioner,
+                                                 /*reduction=*/1e-8,
+                                                 /*maxIterations=*/200,
+                                                 /*verbosity=*/0);
+
+        Dune::InverseOperatorResult result;
+        sys.update = 0.0;
+        solver.apply(sys.update, sys.rhs, result);
+
+        return std::isfinite(sys.update.two_norm());
+    }
+
+    Simulator& simulator_;
+    int gridSequenceNumber_;
+    int maxLocalIterations_;
+
+    std::vector<char> isInterior_;
+    std::vector<ElementSeed> elementSeeds_;
+    std::vector<unsigned> neighborOffsets_;
+    std::vector<unsigned> neighbors_;
+
+    // the upwind graph and its strongly connected components
+    std::vector<char> isUpwindFace_;
+    std::vector<unsigned> edgeOffsets_;
+    std::vector<unsigned> edges_;
+    StronglyConnectedComponents scc_;
+
+    // the index of each cell within its component and whether its primary variables
+    // have been changed by the current level
+    std::vector<unsigned> localIdx_;
+    std::vector<char> changed_;
+
+    std::size_t numComponentsSolved_ = 0;
+    std::size_t numUnconvergedComponents_ = 0;
+    unsigned largestComponentSize_ = 0;
+};
+
+} // namespace Opm
+
+#endif
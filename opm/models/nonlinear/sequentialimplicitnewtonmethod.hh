@@ -0,0 +1,757 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::SequentialImplicitNewtonMethod
+ */
+#ifndef EWOMS_SEQUENTIAL_IMPLICIT_NEWTON_METHOD_HH
+#define EWOMS_SEQUENTIAL_IMPLICIT_NEWTON_METHOD_HH
+
+#include "newtonmethodproperties.hh"
+#include "reorderingtransportsolver.hh"
+
+#include <opm/common/Exceptions.hpp>
+
+#include <opm/models/discretization/common/fvbaseproperties.hh>
+#include <opm/models/utils/parametersystem.hh>
+#include <opm/models/utils/propertysystem.hh>
+#include <opm/models/utils/timer.hh>
+
+#include <dune/common/fmatrix.hh>
+#include <dune/common/fvector.hh>
+#include <dune/istl/bcrsmatrix.hh>
+#include <dune/istl/bvector.hh>
+#include <dune/istl/istlexception.hh>
+#include <dune/istl/operators.hh>
+#include <dune/istl/preconditioners.hh>
+#include <dune/istl/solvers.hh>
+#include <dune/istl/paamg/amg.hh>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+namespace Opm::Properties {
+
+//! The maximum number of Newton iterations of the pressure stage
+template<class TypeTag, class MyTypeTag>
+struct SequentialImplicitMaxPressureIterations { using type = UndefinedProperty; };
+
+//! Solve the transport stage cell by cell in the order of the flow instead of
+//! solving the transport system of the whole grid
+template<class TypeTag, class MyTypeTag>
+struct SequentialImplicitReorderedTransport { using type = UndefinedProperty; };
+
+//! The maximum number of Newton iterations of the transport stage
+template<class TypeTag, class MyTypeTag>
+struct SequentialImplicitMaxTransportIterations { using type = UndefinedProperty; };
+
+//! The factor by which the tolerance of the Newton method is multiplied to get the
+//! tolerance of the pressure and transport stages
+template<class TypeTag, class MyTypeTag>
+struct SequentialImplicitToleranceScaling { using type = UndefinedProperty; };
+
+//! The residual reduction which the linear solvers of the stages aim at
+template<class TypeTag, class MyTypeTag>
+struct SequentialImplicitLinearSolverTolerance { using type = UndefinedProperty; };
+
+template<class TypeTag>
+struct SequentialImplicitMaxPressureIterations<TypeTag, TTag::NewtonMethod> { static constexpr int value = 5; };
+template<class TypeTag>
+struct SequentialImplicitMaxTransportIterations<TypeTag, TTag::NewtonMethod> { static constexpr int value = 10; };
+template<class TypeTag>
+struct SequentialImplicitReorderedTransport<TypeTag, TTag::NewtonMethod> { static constexpr bool value = false; };
+template<class TypeTag>
+struct SequentialImplicitToleranceScaling<TypeTag, TTag::NewtonMethod>
+{
+    using type = GetPropType<TypeTag, Scalar>;
+    static constexpr type value = 1.0;
+};
+template<class TypeTag>
+struct SequentialImplicitLinearSolverTolerance<TypeTag, TTag::NewtonMethod>
+{
+    using type = GetPropType<TypeTag, Scalar>;
+    static constexpr type value = 1e-3;
+};
+
+} // namespace Opm::Properties
+
+namespace Opm {
+
+/*!
+ * \ingroup Newton
+ *
+ * \brief A Newton method which splits the black-oil equations into a pressure and a
+ *        transport problem that are solved one after the other.
+ *
+ * Before each global Newton iteration except the first one, two stages are
+ * executed:
+ *
+ * - The pressure stage does Newton iterations for the pressure alone. The pressure
+ *   equation of each cell is the weighted sum of its conservation equations, where
+ *   the weights are the "quasi-IMPES" weights, i.e., the solution of D^T w = e_p
+ *   with D being the diagonal block of the Jacobian and e_p the unit vector of the
+ *   pressure. This approximately decouples the pressure from the remaining primary
+ *   variables, so the scalar pressure system is solved using algebraic multi-grid.
+ * - The transport stage does Newton iterations for the remaining primary variables
+ *   while the pressure, and thus the total velocities, are kept fixed. The
+ *   conservation equation with the largest weight in the pressure equation is
+ *   dropped for this. The derivatives of the transport equations are dominated by
+ *   the upstream cells, so the transport system is well-conditioned and cheap to
+ *   solve.
+ *
+ * Note that each Newton iteration of the pressure and of the transport stage calls
+ * linearizeDomain(), i.e., it linearizes the full system of equations for all cells
+ * and only afterwards extracts the equations of the stage. A stage iteration thus
+ * costs as much linearization work as a global Newton iteration; only the linear
+ * systems which need to be solved are smaller.
+ *
+ * The pressure system is solved by a sequential Dune::MatrixAdapter with algebraic
+ * multi-grid on each process, where the rows of the cells which are not in the
+ * interior of the process are pinned. In parallel runs, the pressure solver is
+ * therefore a block-Jacobi method with one block per process, and its convergence
+ * deteriorates with the number of processes.
+ *
+ * Alternatively, the transport stage can be solved by ReorderingTransportSolver,
+ * which solves the transport equations cell by cell in the order of the flow.
+ *
+ * Afterwards, a regular fully implicit Newton step is taken. It acts as an outer
+ * iteration which removes the splitting error: The Newton method only converges
+ * once the full system of equations is satisfied, and if the stages already solved
+ * it, the global iteration only consists of linearizing the system. The first
+ * iteration of each time step is always a purely global one because the linearizer
+ * updates the storage term of the beginning of the time step in it.
+ *
+ * Like the non-linear domain decomposition, the stages are process-local: The
+ * primary variables of the cells which are not in the interior of the process are
+ * kept fixed.
+ *
+ * This class is layered on top of the Newton method of the black-oil model, i.e.,
+ * specify
+ * \code
+ * template<class TypeTag>
+ * struct NewtonMethod<TypeTag, TTag::YourTypeTag>
+ * { using type = Opm::SequentialImplicitNewtonMethod<TypeTag, Opm::BlackOilNewtonMethod<TypeTag>>; };
+ * \endcode
+ *
+ * The discretization must be cell-centered.
+ */
+template <class TypeTag, class BaseNewtonMethod>
+class SequentialImplicitNewtonMethod : public BaseNewtonMethod
+{
+    using ParentType = BaseNewtonMethod;
+
+    using Scalar = GetPropType<TypeTag, Properties::Scalar>;
+    using Simulator = GetPropType<TypeTag, Properties::Simulator>;
+    using GridView = GetPropType<TypeTag, Properties::GridView>;
+    using Stencil = GetPropType<TypeTag, Properties::Stencil>;
+    using Indices = GetPropType<TypeTag, Properties::Indices>;
+    using SolutionVector = GetPropType<TypeTag, Properties::SolutionVector>;
+    using GlobalEqVector = GetPropType<TypeTag, Properties::GlobalEqVector>;
+    using PrimaryVariables = GetPropType<TypeTag, Properties::PrimaryVariables>;
+    using EqVector = GetPropType<TypeTag, Properties::EqVector>;
+    using SparseMatrixAdapter = GetPropType<TypeTag, Properties::SparseMatrixAdapter>;
+
+    enum { numEq = getPropValue<TypeTag, Properties::NumEq>() };
+    enum { pressureVarIdx = Indices::pressureSwitchIdx };
+
+    using IstlMatrix = typename SparseMatrixAdapter::IstlMatrix;
+    using MatrixBlock = typename SparseMatrixAdapter::MatrixBlock;
+
+    using PressureMatrix = Dune::BCRSMatrix<Dune::FieldMatrix<Scalar, 1, 1> >;
+    using PressureVector = Dune::BlockVector<Dune::FieldVector<Scalar, 1> >;
+    using TransportMatrix = Dune::BCRSMatrix<MatrixBlock>;
+    using TransportVector = Dune::BlockVector<EqVector>;
+
+public:
+    SequentialImplicitNewtonMethod(Simulator& simulator)
+        : ParentType(simulator)
+        , reorderingSolver_(simulator)
+    {
+        maxPressureIterations_ = Parameters::get<TypeTag, Properties::SequentialImplicitMaxPressureIterations>();
+        maxTransportIterations_ = Parameters::get<TypeTag, Properties::SequentialImplicitMaxTransportIterations>();
+        reorderedTransport_ = Parameters::get<TypeTag, Properties::SequentialImplicitReorderedTransport>();
+        toleranceScaling_ = Parameters::get<TypeTag, Properties::SequentialImplicitToleranceScaling>();
+        linearSolverTolerance_ = Parameters::get<TypeTag, Properties::SequentialImplicitLinearSolverTolerance>();
+
+        gridSequenceNumber_ = -1;
+    }
+
+    /*!
+     * \brief Register all run-time parameters for the Newton method.
+     */
+    static void registerParameters()
+    {
+        ParentType::registerParameters();
+        ReorderingTransportSolver<TypeTag>::registerParameters();
+
+        Parameters::registerParam<TypeTag, Properties::SequentialImplicitMaxPressureIterations>
+            ("The maximum number of Newton iterations of the pressure stage of the "
+             "sequential implicit method");
+        Parameters::registerParam<TypeTag, Properties::SequentialImplicitMaxTransportIterations>
+            ("The maximum number of Newton iterations of the transport stage of the "
+             "sequential implicit method");
+        Parameters::registerParam<TypeTag, Properties::SequentialImplicitReorderedTransport>
+            ("Solve the transport stage of the sequential implicit method cell by cell "
+             "in the order of the flow");
+        Parameters::registerParam<TypeTag, Properties::SequentialImplicitToleranceScaling>
+            ("The factor by which the Newton tolerance is scaled for the pressure and "
+             "transport stages");
+        Parameters::registerParam<TypeTag, Properties::SequentialImplicitLinearSolverTolerance>
+            ("The residual reduction of the linear solvers of the pressure and transport "
+             "stages");
+    }
+
+    /*!
+     * \brief Returns the timer which measures the time spent in the pressure stage.
+     */
+    const Timer& pressureStageTimer() const
+    { return pressureStageTimer_; }
+
+    /*!
+     * \brief Returns the timer which measures the time spent in the transport stage.
+     */
+    const Timer& transportStageTimer() const
+    { return transportStageTimer_; }
+
+protected:
+    friend NewtonMethod<TypeTag>;
+    friend ParentType;
+
+    /*!
+     * \copydoc NewtonMethod::begin_
+     */
+    void begin_(const SolutionVector& u)
+    {
+        ParentType::begin_(u);
+
+        pressureStageTimer_.halt();
+        transportStageTimer_.halt();
+        numPressureIterations_ = 0;
+        numTransportIterations_ = 0;
+    }
+
+    /*!
+     * \brief Indicates the beginning of a Newton iteration.
+     *
+     * The pressure and transport stages are done here because the Newton method
+     * considers the solution at the end of this method to be the one at the beginning
+     * of the global iteration.
+     */
+    void beginIteration_()
+    {
+        ParentType::beginIteration_();
+
+        if (this->numIterations() == 0)
+            return;
+
+        if (gridSequenceNumber_ != this->simulator_.vanguard().gridSequenceNumber())
+            createSystems_();
+
+        pressureStageTimer_.start();
+        const int pressureIterations = runStage_(Stage::Pressure, maxPressureIterations_);
+        pressureStageTimer_.stop();
+
+        transportStageTimer_.start();
+        const int transportIterations = reorderedTransport_
+            ? runReorderedTransport_()
+            : runStage_(Stage::Transport, maxTransportIterations_);
+        transportStageTimer_.stop();
+
+        numPressureIterations_ += pressureIterations;
+        numTransportIterations_ += transportIterations;
+        if (this->verbose_())
+            this->endIterMsg()
+                << ", pressure iterations=" << pressureIterations
+                << ", transport iterations=" << transportIterations;
+    }
+
+    /*!
+     * \copydoc NewtonMethod::end_
+     */
+    void end_()
+    {
+        ParentType::end_();
+
+        if (this->verbose_())
+            std::cout << "Sequential implicit: " << numPressureIterations_
+                      << " pressure iterations in " << pressureStageTimer_.realTimeElapsed()
+                      << " seconds, " << numTransportIterations_
+                      << " transport iterations in " << transportStageTimer_.realTimeElapsed()
+                      << " seconds\n" << std::flush;
+    }
+
+private:
+    enum class Stage { Pressure, Transport };
+
+    // do Newton iterations for the unknowns of a stage until its equations are
+    // converged. since the linearization involves collective communication, all
+    // processes do the same number of iterations. if something goes wrong, the
+    // solution is reset to the one at the beginning of the stage.
+    int runStage_(Stage stage, int maxIterations)
+    {
+        auto& model = this->model();
+        auto& linearizer = model.linearizer();
+        SolutionVector& solution = model.solution(/*timeIdx=*/0);
+        const auto& comm = this->simulator_.gridView().comm();
+        const Scalar tolerance = toleranceScaling_*this->tolerance();
+
+        stageStartSolution_ = solution;
+        int iterIdx = 0;
+        int succeeded = 1;
+        try {
+            for (; ; ++iterIdx) {
+                linearizer.linearizeDomain();
+                const auto& jacobian = linearizer.jacobian().istlMatrix();
+                const auto& residual = linearizer.residual();
+
+                computeWeights_(jacobian);
+                const Scalar error = comm.max(stage == Stage::Pressure
+                                              ? pressureError_(residual)
+                                              : transportError_(residual));
+                if (error <= tolerance || iterIdx >= maxIterations)
+                    break;
+
+                int solved;
+                if (stage == Stage::Pressure) {
+                    assemblePressureSystem_(jacobian, residual);
+                    solved = solvePressureSystem_();
+                }
+                else {
+                    assembleTransportSystem_(jacobian, residual);
+                    solved = solveTransportSystem_();
+                }
+                if (!comm.min(solved)) {
+                    succeeded = 0;
+                    break;
+                }
+
+                const unsigned numGridDof = model.numGridDof();
+                for (unsigned globI = 0; globI < numGridDof; ++globI) {
+                    if (!isInterior_[globI])
+                        continue;
+
+                    EqVector update(0.0);
+                    if (stage == Stage::Pressure)
+                        update[pressureVarIdx] = pressureUpdate_[globI][0];
+                    else
+                        update = transportUpdate_[globI];
+
+                    const PrimaryVariables currentValue(solution[globI]);
+                    this->updatePrimaryVariables_(globI,
+                                                  solution[globI],
+                                                  currentValue,
+                                                  update,
+                                                  residual[globI]);
+                }
+                model.syncOverlap();
+                model.invalidateAndUpdateIntensiveQuantities(/*timeIdx=*/0);
+            }
+        }
+        catch (const Dune::Exception&) {
+            succeeded = 0;
+        }
+        catch (const NumericalProblem&) {
+            succeeded = 0;
+        }
+
+        if (!comm.min(succeeded)) {
+            // leave it to the global iteration to deal with the problem
+            solution = stageStartSolution_;
+            model.invalidateAndUpdateIntensiveQuantities(/*timeIdx=*/0);
+            return 0;
+        }
+
+        return iterIdx;
+    }
+
+    // solve the transport equations using the reordering solver. the number of
+    // iterations is the largest one of the local Newton methods.
+    int runReorderedTransport_()
+    {
+        auto& model = this->model();
+        SolutionVector& solution = model.solution(/*timeIdx=*/0);
+        const auto& comm = this->simulator_.gridView().comm();
+
+        stageStartSolution_ = solution;
+        int iterations = 0;
+        int succeeded = 1;
+        try {
+            iterations = reorderingSolver_.solve(toleranceScaling_*this->tolerance(),
+                                                 [this](unsigned globalIdx,
+                                                        PrimaryVariables& nextValue,
+                                                        const PrimaryVariables& currentValue,
+                                                        const EqVector& update,
+                                                        const EqVector& residual)
+                                                 {
+                                                     this->updatePrimaryVariables_(globalIdx,
+                                                                                   nextValue,
+                                                                                   currentValue,
+                                                                                   update,
+                                                                                   residual);
+                                                 });
+        }
+        catch (const Dune::Exception&) {
+            succeeded = 0;
+        }
+        catch (const NumericalProblem&) {
+            succeeded = 0;
+        }
+
+        if (!comm.min(succeeded)) {
+            solution = stageStartSolution_;
+            model.invalidateAndUpdateIntensiveQuantities(/*timeIdx=*/0);
+            return 0;
+        }
+
+        // the solver only updates the intensive quantities of the interior cells
+        model.syncOverlap();
+        if (comm.size() > 1)
+            model.invalidateAndUpdateIntensiveQuantities(/*timeIdx=*/0);
+
+        // the components which did not converge keep their last iterate, the global
+        // iteration deals with the remaining residual
+        const std::size_t numUnconverged = comm.sum(reorderingSolver_.numUnconvergedComponents());
+        if (this->verbose_())
+            this->endIterMsg()
+                << ", transport components=" << reorderingSolver_.numComponents()
+                << " (largest " << reorderingSolver_.largestComponentSize()
+                << ", levels " << reorderingSolver_.numLevels()
+                << ", unconverged " << numUnconverged << ")";
+
+        return comm.max(iterations);
+    }
+
+    // determine the interior cells of the process and the sparsity patterns of the
+    // pressure and transport systems. the latter consist of the couplings of the
+    // Jacobian matrix between the degrees of freedom of the grid.
+    void createSystems_()
+    {
+        auto& model = this->model();
+        const auto& gridView = this->simulator_.gridView();
+        const unsigned numGridDof = model.numGridDof();
+
+        isInterior_.assign(numGridDof, false);
+        Stencil stencil(gridView, model.dofMapper());
+        for (const auto& elem : elements(gridView)) {
+            if (elem.partitionType() != Dune::InteriorEntity)
+                continue;
+
+            stencil.update(elem);
+            if (stencil.numPrimaryDof() != 1)
+                throw std::logic_error("The sequential implicit method requires a "
+                                       "cell-centered discretization");
+            isInterior_[stencil.globalSpaceIndex(/*dofIdx=*/0)] = true;
+        }
+
+        // the Jacobian matrix is only allocated by the first linearization
+        model.linearizer().linearizeDomain();
+        const auto& jacobian = model.linearizer().jacobian().istlMatrix();
+        createPattern_(jacobian, pressureMatrix_);
+        createPattern_(jacobian, transportMatrix_);
+
+        weights_.resize(numGridDof);
+        droppedEqIdx_.resize(numGridDof);
+        pressureRhs_.resize(numGridDof);
+        pressureUpdate_.resize(numGridDof);
+        transportRhs_.resize(numGridDof);
+        transportUpdate_.resize(numGridDof);
+
+        gridSequenceNumber_ = this->simulator_.vanguard().gridSequenceNumber();
+    }
+
+    template <class Matrix>
+    void createPattern_(const IstlMatrix& jacobian, Matrix& matrix) const
+    {
+        const std::size_t numGridDof = this->model().numGridDof();
+
+        std::size_t numNonZeros = 0;
+        for (std::size_t rowIdx = 0; rowIdx < numGridDof; ++rowIdx) {
+            const auto& row = jacobian[rowIdx];
+            for (auto colIt = row.begin(); colIt != row.end(); ++colIt)
+                if (colIt.index() < numGridDof)
+                    ++numNonZeros;
+        }
+
+        matrix.setSize(numGridDof, numGridDof, numNonZeros);
+        matrix.setBuildMode(Matrix::row_wise);
+        for (auto rowIt = matrix.createbegin(); rowIt != matrix.createend(); ++rowIt) {
+            const auto& row = jacobian[rowIt.index()];
+            for (auto colIt = row.begin(); colIt != row.end(); ++colIt)
+                if (colIt.index() < numGridDof)
+                    rowIt.insert(colIt.index());
+        }
+    }
+
+    // compute the quasi-IMPES weights of each cell and the equation which is
+    // replaced by the pressure equation
+    void computeWeights_(const IstlMatrix& jacobian)
+    {
+        const long numGridDof = static_cast<long>(this->model().numGridDof());
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (long globI = 0; globI < numGridDof; ++globI) {
+            EqVector& w = weights_[globI];
+            w = 1.0;
+
+            const auto& diag = jacobian[globI][globI];
+            Dune::FieldMatrix<Scalar, numEq, numEq> diagT;
+            for (int i = 0; i < numEq; ++i)
+                for (int j = 0; j < numEq; ++j)
+                    diagT[i][j] = diag[j][i];
+
+            EqVector unitPressure(0.0);
+            unitPressure[pressureVarIdx] = 1.0;
+            try {
+                diagT.solve(w, unitPressure);
+            }
+            catch (const Dune::FMatrixError&) {
+                w = 1.0;
+            }
+
+            // scale the weights such that the largest one is one
+            const Scalar maxWeight = w.infinity_norm();
+            if (maxWeight > 0.0 && std::isfinite(maxWeight))
+                w /= maxWeight;
+            else
+                w = 1.0;
+
+            unsigned droppedEqIdx = 0;
+            for (unsigned eqIdx = 1; eqIdx < numEq; ++eqIdx)
+                if (std::abs(w[eqIdx]) > std::abs(w[droppedEqIdx]))
+                    droppedEqIdx = eqIdx;
+            droppedEqIdx_[globI] = droppedEqIdx;
+        }
+    }
+
+    // the maximum weighted residual of the pressure equations of the interior cells
+    Scalar pressureError_(const GlobalEqVector& residual) const
+    {
+        const auto& model = this->model();
+        const unsigned numGridDof = model.numGridDof();
+
+        Scalar result = 0.0;
+        for (unsigned globI = 0; globI < numGridDof; ++globI) {
+            if (!isInterior_[globI] || model.dofTotalVolume(globI) <= 0.0)
+                continue;
+
+            const Scalar r = weights_[globI]*residual[globI];
+            result = std::max(std::abs(r*model.eqWeight(globI, droppedEqIdx_[globI])), result);
+        }
+
+        return result;
+    }
+
+    // the maximum weighted residual of the transport equations of the interior cells
+    Scalar transportError_(const GlobalEqVector& residual) const
+    {
+        const auto& model = this->model();
+        const unsigned numGridDof = model.numGridDof();
+
+        Scalar result = 0.0;
+        for (unsigned globI = 0; globI < numGridDof; ++globI) {
+            if (!isInterior_[globI] || model.dofTotalVolume(globI) <= 0.0)
+                continue;
+
+            for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx) {
+                if (eqIdx == droppedEqIdx_[globI])
+                    continue;
+                result = std::max(std::abs(residual[globI][eqIdx]*model.eqWeight(globI, eqIdx)), result);
+            }
+        }
+
+        return result;
+    }
+
+    // the pressure equation of a cell is the weighted sum of its conservation
+    // equations, restricted to the pressure columns of the Jacobian. the pressure of
+    // the cells outside of the interior is kept fixed.
+    void assemblePressureSystem_(const IstlMatrix& jacobian, const GlobalEqVector& residual)
+    {
+        const long numGridDof = static_cast<long>(this->model().numGridDof());
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (long globI = 0; globI < numGridDof; ++globI) {
+            auto& row = pressureMatrix_[globI];
+            if (!isInterior_[globI]) {
+                row = 0.0;
+                row[globI] = 1.0;
+                pressureRhs_[globI] = 0.0;
+                continue;
+            }
+
+            const EqVector& w = weights_[globI];
+            const auto& jacRow = jacobian[globI];
+            auto jacColIt = jacRow.begin();
+            for (auto colIt = row.begin(); colIt != row.end(); ++colIt, ++jacColIt) {
+                while (jacColIt.index() != colIt.index())
+                    ++jacColIt;
+
+                Scalar value = 0.0;
+                for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                    value += w[eqIdx]*(*jacColIt)[eqIdx][pressureVarIdx];
+                (*colIt)[0][0] = value;
+            }
+            pressureRhs_[globI] = w*residual[globI];
+        }
+    }
+
+    // the transport system is the Jacobian without the pressure column. the
+    // conservation equation which has been replaced by the pressure equation is
+    // replaced by the condition that the pressure stays constant.
+    void assembleTransportSystem_(const IstlMatrix& jacobian, const GlobalEqVector& residual)
+    {
+        const long numGridDof = static_cast<long>(this->model().numGridDof());
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (long globI = 0; globI < numGridDof; ++globI) {
+            auto& row = transportMatrix_[globI];
+            if (!isInterior_[globI]) {
+                row = 0.0;
+                for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                    row[globI][eqIdx][eqIdx] = 1.0;
+                transportRhs_[globI] = 0.0;
+                continue;
+            }
+
+            const unsigned droppedEqIdx = droppedEqIdx_[globI];
+            const auto& jacRow = jacobian[globI];
+            auto jacColIt = jacRow.begin();
+            for (auto colIt = row.begin(); colIt != row.end(); ++colIt, ++jacColIt) {
+                while (jacColIt.index() != colIt.index())
+                    ++jacColIt;
+
+                MatrixBlock& block = *colIt;
+                block = *jacColIt;
+                for (unsigned pvIdx = 0; pvIdx < numEq; ++pvIdx)
+                    block[droppedEqIdx][pvIdx] = 0.0;
+                for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                    block[eqIdx][pressureVarIdx] = 0.0;
+                if (colIt.index() == static_cast<std::size_t>(globI))
+                    block[droppedEqIdx][pressureVarIdx] = 1.0;
+            }
+
+            transportRhs_[globI] = residual[globI];
+            transportRhs_[globI][droppedEqIdx] = 0.0;
+        }
+    }
+
+    bool solvePressureSystem_()
+    {
+        using Operator = Dune::MatrixAdapter<PressureMatrix, PressureVector, PressureVector>;
+        using Smoother = Dune::SeqSSOR<PressureMatrix, PressureVector, PressureVector>;
+        using Amg = Dune::Amg::AMG<Operator, PressureVector, Smoother>;
+        using SmootherArgs = typename Dune::Amg::SmootherTraits<Smoother>::Arguments;
+        using CoarsenCriterion = Dune::Amg::
+            CoarsenCriterion<Dune::Amg::SymmetricCriterion<PressureMatrix, Dune::Amg::FirstDiagonal> >;
+
+        SmootherArgs smootherArgs;
+        smootherArgs.iterations = 1;
+        smootherArgs.relaxationFactor = 1.0;
+
+        CoarsenCriterion coarsenCriterion(/*maxLevel=*/15, /*coarsenTarget=*/1200);
+        coarsenCriterion.setDefaultValuesIsotropic(GridView::dimension, /*aggregateSizePerDim=*/3);
+        coarsenCriterion.setDebugLevel(0);
+        coarsenCriterion.setMinCoarsenRate(1.05);
+        coarsenCriterion.setAccumulate(Dune::Amg::atOnceAccu);
+        coarsenCriterion.setSkipIsolated(false);
+
+        Operator op(pressureMatrix_);
+        Amg amg(op, coarsenCriterion, smootherArgs);
+        Dune::BiCGSTABSolver<PressureVector> solver(op,
+                                                    amg,
+                                                    linearSolverTolerance_,
+                                                    /*maxIterations=*/100,
+                                                    /*verbosity=*/0);
+
+        // the stages only serve as a non-linear preconditioner of the global Newton
+        // method, so an update which does not achieve the requested residual
+        // reduction is still acceptable as long as it is finite.
+        Dune::InverseOperatorResult result;
+        pressureUpdate_ = 0.0;
+        solver.apply(pressureUpdate_, pressureRhs_, result);
+
+        return std::isfinite(pressureUpdate_.two_norm());
+    }
+
+    bool solveTransportSystem_()
+    {
+        using Operator = Dune::MatrixAdapter<TransportMatrix, TransportVector, TransportVector>;
+        using Preconditioner = Dune::SeqILU<TransportMatrix, TransportVector, TransportVector>;
+
+        Operator op(transportMatrix_);
+        Preconditioner preconditioner(transportMatrix_, /*relaxationFactor=*/1.0);
+        Dune::BiCGSTABSolver<TransportVector> solver(op,
+                                                     preconditioner,
+                                                     linearSolverTolerance_,
+                                                     /*maxIterations=*/200,
+                                                     /*verbosity=*/0);
+
+        Dune::InverseOperatorResult result;
+        transportUpdate_ = 0.0;
+        solver.apply(transportUpdate_, transportRhs_, result);
+
+        return std::isfinite(transportUpdate_.two_norm());
+    }
+
+    int gridSequenceNumber_;
+    std::vector<bool> isInterior_;
+
+    // the quasi-IMPES weights of each cell and the index of the conservation
+    // equation which has the largest weight
+    std::vector<EqVector> weights_;
+    std::vector<unsigned> droppedEqIdx_;
+
+    PressureMatrix pressureMatrix_;
+    PressureVector pressureRhs_;
+    PressureVector pressureUpdate_;
+    TransportMatrix transportMatrix_;
+    TransportVector transportRhs_;
+    TransportVector transportUpdate_;
+
+    // the solution at the beginning of the current stage
+    SolutionVector stageStartSolution_;
+
+    Timer pressureStageTimer_;
+    Timer transportStageTimer_;
+    int numPressureIterations_ = 0;
+    int numTransportIterations_ = 0;
+
+    ReorderingTransportSolver<TypeTag> reorderingSolver_;
+    bool reorderedTransport_;
+
+    int maxPressureIterations_;
+    int maxTransportIterations_;
+    Scalar toleranceScaling_;
+    Scalar linearSolverTolerance_;
+};
+
+} // namespace Opm
+
+#endif
@@ -0,0 +1,225 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::CpuTopology
+ */
+#ifndef EWOMS_CPU_TOPOLOGY_HH
+#define EWOMS_CPU_TOPOLOGY_HH
+
+#if HAVE_MPI
+#include <mpi.h>
+#endif
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \brief Describes the processors on which the current process is allowed to
+ *        run and how the processes of a parallel run share the compute nodes.
+ *
+ * The physical cores are determined by the topology information which the
+ * Linux kernel exposes in /sys/devices/system/cpu. If this information is not
+ * available, each logical processor is considered to be a core. The number of
+ * processes which run on the same node is determined using
+ * MPI_Comm_split_type(MPI_COMM_TYPE_SHARED).
+ */
+class CpuTopology
+{
+public:
+    /*!
+     * \brief A physical core and the logical processors (i.e., hardware
+     *        threads) which belong to it.
+     */
+    struct Core
+    {
+        int package;
+        int coreId;
+        std::vector<int> cpus;
+    };
+
+    /*!
+     * \brief Determine the topology of the calling process.
+     *
+     * If MPI has been initialized, this is a collective operation on
+     * MPI_COMM_WORLD.
+     */
+    static CpuTopology detect()
+    {
+        CpuTopology topo;
+        topo.detectCores_();
+        topo.detectNodeLocalRanks_();
+        return topo;
+    }
+
+    /*!
+     * \brief The physical cores on which the process is allowed to run.
+     */
+    const std::vector<Core>& cores() const
+    { return cores_; }
+
+    /*!
+     * \brief The number of processors which are online on the node.
+     */
+    int numOnlineCpus() const
+    { return numOnlineCpus_; }
+
+    /*!
+     * \brief Returns true if the process may run on all processors of the node,
+     *        i.e., if it has not been bound by the MPI launcher.
+     */
+    bool isUnbound() const
+    {
+        std::size_t numCpus = 0;
+        for (const auto& core : cores_)
+            numCpus += core.cpus.size();
+        return static_cast<int>(numCpus) >= numOnlineCpus_;
+    }
+
+    /*!
+     * \brief The index of the process among the processes on its node.
+     */
+    int nodeLocalRank() const
+    { return nodeLocalRank_; }
+
+    /*!
+     * \brief The number of processes which run on the same node.
+     */
+    int numNodeLocalRanks() const
+    { return numNodeLocalRanks_; }
+
+    /*!
+     * \brief The cores which the process should use exclusively.
+     *
+     * If the process has been bound by the MPI launcher, these are all cores
+     * it may run on. Otherwise, the cores of the node are split evenly between
+     * the processes on the node.
+     */
+    std::vector<Core> ownCores() const
+    {
+        if (!isUnbound() || numNodeLocalRanks_ <= 1 || cores_.empty())
+            return cores_;
+
+        const std::size_t n = cores_.size();
+        const std::size_t k = static_cast<std::size_t>(numNodeLocalRanks_);
+        const std::size_t r = static_cast<std::size_t>(nodeLocalRank_) % k;
+        const std::size_t begin = r*n/k;
+        const std::size_t end = std::max((r + 1)*n/k, begin + 1);
+        std::vector<Core> result;
+        for (std::size_t i = begin; i < end; ++i)
+            result.push_back(cores_[i % n]);
+        return result;
+    }
+
+private:
+    static int readSysfsInt_(int cpu, const char* name, int defaultValue)
+    {
+        std::ifstream is("/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/" + name);
+        int value;
+        if (is >> value)
+            return value;
+        return defaultValue;
+    }
+
+    void detectCores_()
+    {
+        numOnlineCpus_ = static_cast<int>(::sysconf(_SC_NPROCESSORS_ONLN));
+
+        std::vector<int> cpus;
+#if defined(__linux__)
+        cpu_set_t mask;
+        CPU_ZERO(&mask);
+        if (sched_getaffinity(/*pid=*/0, sizeof(mask), &mask) == 0) {
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+                if (CPU_ISSET(cpu, &mask))
+                    cpus.push_back(cpu);
+        }
+#endif
+        if (cpus.empty()) {
+            const int n = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+            for (int cpu = 0; cpu < n; ++cpu)
+                cpus.push_back(cpu);
+        }
+        if (numOnlineCpus_ <= 0)
+            numOnlineCpus_ = static_cast<int>(cpus.size());
+
+        // group the logical processors by (package, core). processors without
+        // topology information are considered to be cores of their own.
+        std::vector<std::tuple<int, int, int>> keyedCpus;
+        for (int cpu : cpus) {
+            const int package = readSysfsInt_(cpu, "physical_package_id", 0);
+            const int coreId = readSysfsInt_(cpu, "core_id", -1 - cpu);
+            keyedCpus.emplace_back(package, coreId, cpu);
+        }
+        std::sort(keyedCpus.begin(), keyedCpus.end());
+
+        cores_.clear();
+        for (const auto& [package, coreId, cpu] : keyedCpus) {
+            if (cores_.empty() || cores_.back().package != package || cores_.back().coreId != coreId)
+                cores_.push_back(Core{package, coreId, {}});
+            cores_.back().cpus.push_back(cpu);
+        }
+    }
+
+    void detectNodeLocalRanks_()
+    {
+        nodeLocalRank_ = 0;
+        numNodeLocalRanks_ = 1;
+
+#if HAVE_MPI && MPI_VERSION >= 3
+        int initialized = 0;
+        MPI_Initialized(&initialized);
+        if (!initialized)
+            return;
+
+        MPI_Comm nodeComm;
+        MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, /*key=*/0,
+                            MPI_INFO_NULL, &nodeComm);
+        MPI_Comm_rank(nodeComm, &nodeLocalRank_);
+        MPI_Comm_size(nodeComm, &numNodeLocalRanks_);
+        MPI_Comm_free(&nodeComm);
+#endif
+    }
+
+    std::vector<Core> cores_;
+    int numOnlineCpus_ = 1;
+    int nodeLocalRank_ = 0;
+    int numNodeLocalRanks_ = 1;
+};
+
+} // namespace Opm
+
+#endif
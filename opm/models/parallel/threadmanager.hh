@@ -32,11 +32,28 @@
 #endif
 
 #include <opm/models/discretization/common/fvbaseproperties.hh>
+#include <opm/models/parallel/cputopology.hh>
 #include <opm/models/utils/parametersystem.hh>
 #include <opm/models/utils/propertysystem.hh>
 
 #include <dune/common/version.hh>
 
+#if HAVE_MPI
+#include <mpi.h>
+#endif
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
 namespace Opm {
 
 /*!
@@ -62,7 +79,13 @@ public:
     {
         Parameters::registerParam<TypeTag, Properties::ThreadsPerProcess>
             ("The maximum number of threads to be instantiated per process "
-             "('-1' means 'automatic')");
+             "('-1' means 'automatic', i.e., one thread per physical core which is "
+             "not used by other processes on the same node)");
+        Parameters::registerParam<TypeTag, Properties::ThreadPinning>
+            ("Pin the threads to the processors available to the process. Possible "
+             "values are 'none', 'compact' (consecutive threads use consecutive "
+             "processors) and 'spread' (the threads are distributed evenly over "
+             "the processors)");
     }
 
     /*!
@@ -72,12 +95,18 @@ public:
      *        and if set (disregard the environment variable OPM_NUM_THREADS).
      *        If false we will assume that the number of OpenMP threads is already set
      *        outside of this function (e.g. by OPM_NUM_THREADS or in the simulator by
-     *        the ThreadsPerProcess parameter).
+     *        the ThreadsPerProcess parameter). In this case, the threads are not
+     *        pinned either.
+     *
+     * If the command line parameters are queried and MPI has already been
+     * initialized, this method is collective on MPI_COMM_WORLD.
      */
     static void init(bool queryCommandLineParameter = true)
     {
+        CpuTopology topology;
         if (queryCommandLineParameter)
         {
+            topology = CpuTopology::detect();
             numThreads_ = Parameters::get<TypeTag, Properties::ThreadsPerProcess>();
 
             // some safety checks. This is pretty ugly macro-magic, but so what?
@@ -100,6 +129,12 @@ public:
 #endif
 
 #ifdef _OPENMP
+            // 'automatic' uses one thread per physical core of the share of the node
+            // which belongs to the process, unless the user explicitly specified
+            // the number of threads via the environment.
+            if (numThreads_ == -1 && !std::getenv("OMP_NUM_THREADS"))
+                numThreads_ = std::max<int>(1, static_cast<int>(topology.ownCores().size()));
+
             // actually limit the number of threads
             if (numThreads_ > 0)
                 omp_set_num_threads(numThreads_);
@@ -110,6 +145,12 @@ public:
         // get the number of threads which are used in the end.
         numThreads_ = omp_get_max_threads();
 #endif
+
+        if (queryCommandLineParameter) {
+            const std::string pinning = Parameters::get<TypeTag, Properties::ThreadPinning>();
+            pinThreads_(pinning, topology);
+            printReport_(pinning, topology);
+        }
     }
 
     /*!
@@ -131,6 +172,92 @@ public:
     }
 
 private:
+    // Bind each OpenMP thread to one of the processors of the cores which belong
+    // to the process. This keeps the threads on the NUMA domain on which the pages
+    // they touched first are located. The first hardware thread of each core is
+    // used before the second one is.
+    static void pinThreads_(const std::string& mode, const CpuTopology& topology)
+    {
+        if (mode == "none")
+            return;
+        if (mode != "compact" && mode != "spread")
+            throw std::invalid_argument("Unknown thread pinning mode '"+mode+"'. Valid values are "
+                                        "'none', 'compact' and 'spread'");
+
+#if defined(_OPENMP) && defined(__linux__)
+        const auto cpus = pinningCpus_(topology);
+        if (cpus.empty())
+            return;
+
+        const bool compact = (mode == "compact");
+#pragma omp parallel
+        {
+            const std::size_t threadId = static_cast<std::size_t>(omp_get_thread_num());
+            const std::size_t numThreads = static_cast<std::size_t>(omp_get_num_threads());
+            const std::size_t cpuIdx =
+                compact ? threadId % cpus.size() : threadId*cpus.size()/numThreads;
+
+            cpu_set_t threadMask;
+            CPU_ZERO(&threadMask);
+            CPU_SET(cpus[cpuIdx], &threadMask);
+            // on linux, a pid of 0 refers to the calling thread
+            sched_setaffinity(/*pid=*/0, sizeof(threadMask), &threadMask);
+        }
+#endif
+    }
+
+    // The processors to which the threads are pinned, ordered such that all cores
+    // get one thread before any core gets a second one.
+    static std::vector<int> pinningCpus_(const CpuTopology& topology)
+    {
+        const auto cores = topology.ownCores();
+        std::vector<int> cpus;
+        for (std::size_t level = 0; ; ++level) {
+            const std::size_t oldSize = cpus.size();
+            for (const auto& core : cores)
+                if (level < core.cpus.size())
+                    cpus.push_back(core.cpus[level]);
+            if (cpus.size() == oldSize)
+                break;
+        }
+        return cpus;
+    }
+
+    // Print how the processes and threads are distributed over the node and warn if
+    // the cores of a node are oversubscribed.
+    static void printReport_(const std::string& pinning, const CpuTopology& topology)
+    {
+        int rank = 0;
+        int oversubscribed = 0;
+        const int numOwnCores = static_cast<int>(topology.ownCores().size());
+        if (topology.isUnbound())
+            oversubscribed = numThreads_*topology.numNodeLocalRanks() > static_cast<int>(topology.cores().size());
+        else
+            oversubscribed = numThreads_ > numOwnCores;
+
+#if HAVE_MPI
+        int initialized = 0;
+        MPI_Initialized(&initialized);
+        if (initialized) {
+            MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+            MPI_Allreduce(MPI_IN_PLACE, &oversubscribed, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+        }
+#endif
+
+        if (rank != 0)
+            return;
+
+        std::ostringstream oss;
+        oss << "Using " << numThreads_ << " thread(s) per process and "
+            << topology.numNodeLocalRanks() << " process(es) on the node of rank 0 ("
+            << numOwnCores << " of " << topology.cores().size() << " available cores per process, "
+            << "pinning: " << pinning << ")\n";
+        if (oversubscribed)
+            oss << "Warning: The number of threads exceeds the number of cores on at least "
+                << "one node. Consider reducing the number of threads per process.\n";
+        std::cout << oss.str() << std::flush;
+    }
+
     static int numThreads_;
 };
 
@@ -48,11 +48,15 @@
 #include <opm/models/io/vtkcompositionmodule.hh>
 #include <opm/models/io/vtkenergymodule.hh>
 #include <opm/models/io/vtkdiffusionmodule.hh>
+#include <opm/models/parallel/threadedentityiterator.hh>
 
 #include <opm/material/fluidmatrixinteractions/NullMaterial.hpp>
 #include <opm/material/fluidmatrixinteractions/MaterialTraits.hpp>
 
+#include <exception>
 #include <iostream>
+#include <limits>
+#include <mutex>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -265,6 +269,7 @@ class PvsModel
     enum { numComponents = getPropValue<TypeTag, Properties::NumComponents>() };
     enum { enableDiffusion = getPropValue<TypeTag, Properties::EnableDiffusion>() };
     enum { enableEnergy = getPropValue<TypeTag, Properties::EnableEnergy>() };
+    enum { numEq = getPropValue<TypeTag, Properties::NumEq>() };
 
     using Element = typename GridView::template Codim<0>::Entity;
     using ElementIterator = typename GridView::template Codim<0>::Iterator;
@@ -487,6 +492,11 @@ public:
      * \internal
      * \brief Do the primary variable switching after a Newton iteration.
      *
+     * The elements are processed by all threads in parallel. Since the intensive
+     * quantities of each degree of freedom need to be computed to decide on the new
+     * phase presence anyway, they are stored in the intensive quantity cache (if it is
+     * enabled) so that the next linearization does not need to compute them again.
+     *
      * This is an internal method that needs to be public because it
      * gets called by the Newton method after an update.
      */
@@ -496,44 +506,39 @@ public:
 
         int succeeded;
         try {
-            std::vector<bool> visited(this->numGridDof(), false);
-            ElementContext elemCtx(this->simulator_);
-
-            for (const auto& elem : elements(this->gridView_, Dune::Partitions::interior)) {
-                elemCtx.updateStencil(elem);
-
-                size_t numLocalDof = elemCtx.stencil(/*timeIdx=*/0).numPrimaryDof();
-                for (unsigned dofIdx = 0; dofIdx < numLocalDof; ++dofIdx) {
-                    unsigned globalIdx = elemCtx.globalSpaceIndex(dofIdx, /*timeIdx=*/0);
-
-                    if (visited[globalIdx])
-                        continue;
-                    visited[globalIdx] = true;
-
-                    // compute the intensive quantities of the current degree of freedom
-                    auto& priVars = this->solution(/*timeIdx=*/0)[globalIdx];
-                    elemCtx.updateIntensiveQuantities(priVars, dofIdx, /*timeIdx=*/0);
-                    const IntensiveQuantities& intQuants = elemCtx.intensiveQuantities(dofIdx, /*timeIdx=*/0);
-
-                    // evaluate primary variable switch
-                    short oldPhasePresence = priVars.phasePresence();
-
-                    // set the primary variables and the new phase state
-                    // from the current fluid state
-                    priVars.assignNaive(intQuants.fluidState());
-
-                    if (oldPhasePresence != priVars.phasePresence()) {
-                        if (verbosity_ > 1)
-                            printSwitchedPhases_(elemCtx,
-                                                 dofIdx,
-                                                 intQuants.fluidState(),
-                                                 oldPhasePresence,
-                                                 priVars);
-                        ++numSwitched_;
+            updateSwitchingDofOwners_();
+
+            std::mutex exceptionLock;
+            std::exception_ptr exceptionPtr = nullptr;
+
+            unsigned numSwitched = 0;
+            ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(this->gridView_);
+#ifdef _OPENMP
+#pragma omp parallel reduction(+:numSwitched)
+#endif
+            {
+                ElementContext elemCtx(this->simulator_);
+                ElementIterator elemIt = threadedElemIt.beginParallel();
+                try {
+                    for (; !threadedElemIt.isFinished(elemIt); elemIt = threadedElemIt.increment()) {
+                        const Element& elem = *elemIt;
+                        if (elem.partitionType() != Dune::InteriorEntity)
+                            continue;
+
+                        numSwitched += switchPrimaryVarsElement_(elemCtx, elem);
                     }
                 }
+                catch (...) {
+                    std::lock_guard<std::mutex> take(exceptionLock);
+                    exceptionPtr = std::current_exception();
+                    threadedElemIt.setFinished();
+                }
             }
 
+            if (exceptionPtr)
+                std::rethrow_exception(exceptionPtr);
+
+            numSwitched_ = numSwitched;
             succeeded = 1;
         }
         catch (...)
@@ -609,6 +614,107 @@ public:
             this->addOutputModule(new Opm::VtkEnergyModule<TypeTag>(this->simulator_));
     }
 
+private:
+    /*!
+     * \brief Adapt the primary variables of all degrees of freedom of an element
+     *        which are owned by it and return the number of phase state changes.
+     */
+    unsigned switchPrimaryVarsElement_(ElementContext& elemCtx, const Element& elem)
+    {
+        unsigned numSwitched = 0;
+        const unsigned elemIdx = static_cast<unsigned>(this->elementMapper().index(elem));
+
+        elemCtx.updateStencil(elem);
+
+        size_t numLocalDof = elemCtx.stencil(/*timeIdx=*/0).numPrimaryDof();
+        for (unsigned dofIdx = 0; dofIdx < numLocalDof; ++dofIdx) {
+            unsigned globalIdx = elemCtx.globalSpaceIndex(dofIdx, /*timeIdx=*/0);
+
+            // each degree of freedom is handled by exactly one element
+            if (switchingDofOwner_[globalIdx] != elemIdx)
+                continue;
+
+            // compute the intensive quantities of the current degree of freedom
+            auto& priVars = this->solution(/*timeIdx=*/0)[globalIdx];
+            elemCtx.updateIntensiveQuantities(priVars, dofIdx, /*timeIdx=*/0);
+            const IntensiveQuantities& intQuants = elemCtx.intensiveQuantities(dofIdx, /*timeIdx=*/0);
+
+            // evaluate primary variable switch
+            const PrimaryVariables oldPriVars(priVars);
+            short oldPhasePresence = priVars.phasePresence();
+
+            // set the primary variables and the new phase state
+            // from the current fluid state
+            priVars.assignNaive(intQuants.fluidState());
+
+            if (oldPhasePresence != priVars.phasePresence()) {
+                if (verbosity_ > 1) {
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+                    printSwitchedPhases_(elemCtx,
+                                         dofIdx,
+                                         intQuants.fluidState(),
+                                         oldPhasePresence,
+                                         priVars);
+                }
+                ++numSwitched;
+            }
+
+            // the intensive quantities which were just computed are only valid if
+            // the primary variables are not modified by the switch. if they were,
+            // we need to re-evaluate them for the new primary variables.
+            if (!this->storeIntensiveQuantities())
+                continue;
+
+            bool unchanged = oldPhasePresence == priVars.phasePresence();
+            for (unsigned pvIdx = 0; unchanged && pvIdx < numEq; ++pvIdx)
+                unchanged = oldPriVars[pvIdx] == priVars[pvIdx];
+
+            if (!unchanged)
+                elemCtx.updateIntensiveQuantities(priVars, dofIdx, /*timeIdx=*/0);
+
+            this->updateCachedIntensiveQuantities(elemCtx.intensiveQuantities(dofIdx, /*timeIdx=*/0),
+                                                  globalIdx,
+                                                  /*timeIdx=*/0);
+        }
+
+        return numSwitched;
+    }
+
+    /*!
+     * \brief Determine which interior element is responsible for the primary
+     *        variable switch of each degree of freedom.
+     *
+     * This only needs to be done once per grid sequence number and allows to
+     * process the elements in parallel without marking visited degrees of freedom.
+     */
+    void updateSwitchingDofOwners_()
+    {
+        int seqNum = this->simulator_.vanguard().gridSequenceNumber();
+        if (switchingDofOwnerSeqNum_ == seqNum
+            && switchingDofOwner_.size() == this->numGridDof())
+            return;
+
+        const unsigned noOwner = std::numeric_limits<unsigned>::max();
+        switchingDofOwner_.assign(this->numGridDof(), noOwner);
+
+        ElementContext elemCtx(this->simulator_);
+        for (const auto& elem : elements(this->gridView_, Dune::Partitions::interior)) {
+            elemCtx.updatePrimaryStencil(elem);
+            const unsigned elemIdx = static_cast<unsigned>(this->elementMapper().index(elem));
+
+            size_t numLocalDof = elemCtx.numPrimaryDof(/*timeIdx=*/0);
+            for (unsigned dofIdx = 0; dofIdx < numLocalDof; ++dofIdx) {
+                unsigned globalIdx = elemCtx.globalSpaceIndex(dofIdx, /*timeIdx=*/0);
+                if (switchingDofOwner_[globalIdx] == noOwner)
+                    switchingDofOwner_[globalIdx] = elemIdx;
+            }
+        }
+
+        switchingDofOwnerSeqNum_ = seqNum;
+    }
+
     mutable Scalar referencePressure_;
 
     // number of switches of the phase state in the last Newton
@@ -617,6 +723,11 @@ public:
 
     // verbosity of the model
     int verbosity_;
+
+    // index of the element which adapts the primary variables of each degree of
+    // freedom and the grid sequence number for which it was determined
+    std::vector<unsigned> switchingDofOwner_;
+    int switchingDofOwnerSeqNum_{-1};
 };
 }
 
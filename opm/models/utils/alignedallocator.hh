@@ -45,6 +45,7 @@
 #include <memory>
 #include <type_traits>
 #include <cassert>
+#include <cstdlib>
 
 namespace Opm {
 
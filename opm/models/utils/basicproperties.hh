@@ -164,6 +164,10 @@ struct CellsZ { using type = UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
 struct GridFile { using type = UndefinedProperty; };
 
+//! name prefix of the files which cache the distributed grid
+template<class TypeTag, class MyTypeTag>
+struct GridCacheFile { using type = UndefinedProperty; };
+
 //! level of the grid view
 template<class TypeTag, class MyTypeTag>
 struct GridViewLevel { using type = UndefinedProperty; };
@@ -210,6 +214,10 @@ struct ModelParameterGroup<TypeTag, TTag::NumericModel> { static constexpr auto
 template<class TypeTag>
 struct GridFile<TypeTag, TTag::NumericModel> { static constexpr auto value = ""; };
 
+//! Do not cache the grid by default
+template<class TypeTag>
+struct GridCacheFile<TypeTag, TTag::NumericModel> { static constexpr auto value = ""; };
+
 #if HAVE_DUNE_FEM
 template<class TypeTag>
 struct GridPart<TypeTag, TTag::NumericModel>
@@ -0,0 +1,154 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::FirstTouchAllocator
+ */
+#ifndef EWOMS_FIRST_TOUCH_ALLOCATOR_HH
+#define EWOMS_FIRST_TOUCH_ALLOCATOR_HH
+
+#include <opm/models/utils/alignedallocator.hh>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cstddef>
+#include <new>
+
+namespace Opm {
+
+/*!
+ * \brief Touch the memory pages of a block of memory in parallel.
+ *
+ * Each OpenMP thread writes to the pages of the part of the block which it is
+ * assigned by a loop over the block using static scheduling. Since the
+ * operating system places a memory page on the NUMA domain of the thread which
+ * touches it first, loops with static scheduling over data which is stored in
+ * such a block will mostly access local memory.
+ */
+inline void firstTouch(void* ptr, std::size_t numBytes)
+{
+    char* bytes = static_cast<char*>(ptr);
+    const std::size_t pageSize = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    {
+        std::size_t threadId = 0;
+        std::size_t numThreads = 1;
+#ifdef _OPENMP
+        threadId = static_cast<std::size_t>(omp_get_thread_num());
+        numThreads = static_cast<std::size_t>(omp_get_num_threads());
+#endif
+        const std::size_t begin = numBytes*threadId/numThreads;
+        const std::size_t end = numBytes*(threadId + 1)/numThreads;
+        for (std::size_t offset = begin; offset < end; offset += pageSize)
+            bytes[offset] = 0;
+    }
+}
+
+/*!
+ * \brief An allocator which distributes the pages of large memory blocks over
+ *        the NUMA domains of the threads which work on them.
+ *
+ * Blocks which are larger than minFirstTouchSize bytes are directly obtained
+ * from the operating system and their pages are touched using firstTouch()
+ * before they are handed out. All smaller blocks are allocated using
+ * aligned_alloc(). Note that the placement of the pages is only retained if
+ * the OpenMP threads are not migrated between the NUMA domains, i.e., the
+ * threads should be pinned (see ThreadManager).
+ */
+template <class T, std::size_t Alignment = alignof(T)>
+class FirstTouchAllocator
+{
+    static_assert(detail::is_alignment_constant<Alignment>::value,
+                  "Alignment must be powers of two!");
+    static_assert(Alignment <= 4096,
+                  "The alignment must not exceed the size of a memory page!");
+
+public:
+    using value_type = T;
+    using pointer = T*;
+    using const_pointer = const T*;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+
+    //! The size in bytes above which the pages of a block are touched in parallel
+    static constexpr std::size_t minFirstTouchSize = 1 << 20;
+
+    template <class U>
+    struct rebind {
+        using other = FirstTouchAllocator<U, Alignment>;
+    };
+
+    FirstTouchAllocator() noexcept = default;
+
+    template <class U>
+    FirstTouchAllocator(const FirstTouchAllocator<U, Alignment>&) noexcept
+    {}
+
+    pointer allocate(size_type size)
+    {
+        const std::size_t numBytes = sizeof(T)*size;
+        if (numBytes < minFirstTouchSize) {
+            void* p = Opm::aligned_alloc(detail::max_align<Alignment, alignof(T)>::value, numBytes);
+            if (!p && size > 0)
+                throw std::bad_alloc();
+            return static_cast<T*>(p);
+        }
+
+        void* p = ::mmap(nullptr, numBytes, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, /*fd=*/-1, /*offset=*/0);
+        if (p == MAP_FAILED)
+            throw std::bad_alloc();
+
+        firstTouch(p, numBytes);
+        return static_cast<T*>(p);
+    }
+
+    void deallocate(pointer ptr, size_type size)
+    {
+        const std::size_t numBytes = sizeof(T)*size;
+        if (numBytes < minFirstTouchSize)
+            Opm::aligned_free(ptr);
+        else
+            ::munmap(ptr, numBytes);
+    }
+
+    template <class U>
+    bool operator==(const FirstTouchAllocator<U, Alignment>&) const noexcept
+    { return true; }
+
+    template <class U>
+    bool operator!=(const FirstTouchAllocator<U, Alignment>&) const noexcept
+    { return false; }
+};
+
+} // namespace Opm
+
+#endif
@@ -149,8 +149,19 @@ public:
 
         finished_ = false;
 
+        // measure the wall time of each setup phase
+        Timer phaseTimer;
+        auto reportPhaseTime = [this, &phaseTimer]() {
+            const double dt = phaseTimer.stop();
+            if (verbose_)
+                std::cout << "  (took " << dt << " seconds)\n" << std::flush;
+            phaseTimer.halt();
+            phaseTimer.start();
+        };
+
         if (verbose_)
             std::cout << "Allocating the simulation vanguard\n" << std::flush;
+        phaseTimer.start();
 
         int exceptionThrown = 0;
         std::string what;
@@ -186,6 +197,7 @@ public:
         }
         checkParallelException("Allocating the simulation vanguard failed: ",
                                exceptionThrown, what);
+        reportPhaseTime();
 
         if (verbose_)
             std::cout << "Distributing the vanguard's data\n" << std::flush;
@@ -197,6 +209,7 @@ public:
         }
         checkParallelException("Could not distribute the vanguard data: ",
                                exceptionThrown, what);
+        reportPhaseTime();
 
         if (verbose_)
             std::cout << "Allocating the model\n" << std::flush;
@@ -208,6 +221,7 @@ public:
         }
         checkParallelException("Could not allocate model: ",
                                exceptionThrown, what);
+        reportPhaseTime();
 
         if (verbose_)
             std::cout << "Allocating the problem\n" << std::flush;
@@ -220,6 +234,7 @@ public:
         }
         checkParallelException("Could not allocate the problem: ",
                                exceptionThrown, what);
+        reportPhaseTime();
 
         if (verbose_)
             std::cout << "Initializing the model\n" << std::flush;
@@ -231,6 +246,7 @@ public:
         }
         checkParallelException("Could not initialize the  model: ",
                                exceptionThrown, what);
+        reportPhaseTime();
 
         if (verbose_)
             std::cout << "Initializing the problem\n" << std::flush;
@@ -242,6 +258,7 @@ public:
         }
         checkParallelException("Could not initialize the problem: ",
                                exceptionThrown, what);
+        reportPhaseTime();
 
         setupTimer_.stop();
 
@@ -307,8 +307,6 @@ static inline int start(int argc, char **argv,  bool registerParams=true)
         if (paramStatus == 2)
             return 0;
 
-        ThreadManager::init();
-
         // initialize MPI, finalize is done automatically on exit
 #if HAVE_DUNE_FEM
         Dune::Fem::MPIManager::initialize(argc, argv);
@@ -317,6 +315,9 @@ static inline int start(int argc, char **argv,  bool registerParams=true)
         myRank = Dune::MPIHelper::instance(argc, argv).rank();
 #endif
 
+        // the thread manager needs MPI to find out how many processes share a node
+        ThreadManager::init();
+
         // read the initial time step and the end time
         Scalar endTime = Parameters::get<TypeTag, Properties::EndTime>();
         if (endTime < -1e50) {
@@ -0,0 +1,233 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::StronglyConnectedComponents
+ */
+#ifndef EWOMS_STRONGLY_CONNECTED_COMPONENTS_HH
+#define EWOMS_STRONGLY_CONNECTED_COMPONENTS_HH
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \brief Computes the strongly connected components of a directed graph and
+ *        orders them such that each component comes after the components it
+ *        depends on.
+ *
+ * The graph is given in compressed row storage: The edges of vertex v are
+ * targets[offsets[v]] to targets[offsets[v + 1] - 1] and an edge from v to w
+ * means that v depends on w. The components are determined using Tarjan's
+ * algorithm, which emits a component only after all components reachable from
+ * it. Since the graphs may be as large as the grid, the depth-first search is
+ * implemented using an explicit stack instead of recursion.
+ *
+ * Additionally, each component is assigned a level: Components without
+ * dependencies on other components are on level 0, all others are on the level
+ * after the highest level of their dependencies. The components of a level do
+ * not depend on each other and can thus be processed in parallel.
+ */
+class StronglyConnectedComponents
+{
+public:
+    /*!
+     * \brief Compute the components of a graph.
+     *
+     * \param offsets The offsets of the edges of each vertex, its size is the
+     *                number of vertices plus one
+     * \param targets The vertices which the edges point to
+     */
+    void compute(const std::vector<unsigned>& offsets, const std::vector<unsigned>& targets)
+    {
+        assert(!offsets.empty());
+        const unsigned numVertices = static_cast<unsigned>(offsets.size() - 1);
+
+        componentOfVertex_.assign(numVertices, unvisited_);
+        componentStart_.assign(1, 0);
+        vertices_.clear();
+        vertices_.reserve(numVertices);
+
+        std::vector<unsigned> index(numVertices, unvisited_);
+        std::vector<unsigned> lowLink(numVertices, 0);
+        std::vector<unsigned> tarjanStack;
+        std::vector<std::pair<unsigned, unsigned>> callStack; // (vertex, next edge)
+        unsigned nextIndex = 0;
+
+        for (unsigned root = 0; root < numVertices; ++root) {
+            if (index[root] != unvisited_)
+                continue;
+
+            index[root] = lowLink[root] = nextIndex++;
+            tarjanStack.push_back(root);
+            callStack.emplace_back(root, offsets[root]);
+            while (!callStack.empty()) {
+                const unsigned v = callStack.back().first;
+                const unsigned edgeIdx = callStack.back().second;
+                if (edgeIdx < offsets[v + 1]) {
+                    ++callStack.back().second;
+                    const unsigned w = targets[edgeIdx];
+                    if (index[w] == unvisited_) {
+                        index[w] = lowLink[w] = nextIndex++;
+                        tarjanStack.push_back(w);
+                        callStack.emplace_back(w, offsets[w]);
+                    }
+                    else if (componentOfVertex_[w] == unvisited_)
+                        // w is still on the Tarjan stack
+                        lowLink[v] = std::min(lowLink[v], index[w]);
+                    continue;
+                }
+
+                // all edges of v have been visited
+                callStack.pop_back();
+                if (lowLink[v] == index[v]) {
+                    const unsigned compIdx = static_cast<unsigned>(componentStart_.size() - 1);
+                    unsigned w;
+                    do {
+                        w = tarjanStack.back();
+                        tarjanStack.pop_back();
+                        componentOfVertex_[w] = compIdx;
+                        vertices_.push_back(w);
+                    } while (w != v);
+                    componentStart_.push_back(static_cast<unsigned>(vertices_.size()));
+                }
+                if (!callStack.empty()) {
+                    const unsigned u = callStack.back().first;
+                    lowLink[u] = std::min(lowLink[u], lowLink[v]);
+                }
+            }
+        }
+
+        computeLevels_(offsets, targets);
+    }
+
+    /*!
+     * \brief Returns the number of components.
+     */
+    std::size_t numComponents() const
+    { return componentStart_.size() - 1; }
+
+    /*!
+     * \brief Returns the index of the component of a vertex.
+     */
+    unsigned component(unsigned vertexIdx) const
+    { return componentOfVertex_[vertexIdx]; }
+
+    /*!
+     * \brief Returns the number of vertices of a component.
+     */
+    unsigned componentSize(unsigned compIdx) const
+    { return componentStart_[compIdx + 1] - componentStart_[compIdx]; }
+
+    /*!
+     * \brief Returns the first vertex of a component.
+     *
+     * The vertices of a component are stored consecutively.
+     */
+    const unsigned* componentBegin(unsigned compIdx) const
+    { return vertices_.data() + componentStart_[compIdx]; }
+
+    /*!
+     * \brief Returns the end of the vertices of a component.
+     */
+    const unsigned* componentEnd(unsigned compIdx) const
+    { return vertices_.data() + componentStart_[compIdx + 1]; }
+
+    /*!
+     * \brief Returns the number of levels.
+     */
+    std::size_t numLevels() const
+    { return levelStart_.size() - 1; }
+
+    /*!
+     * \brief Returns the level of a component.
+     */
+    unsigned level(unsigned compIdx) const
+    { return level_[compIdx]; }
+
+    /*!
+     * \brief Returns the indices of the components of all levels.
+     *
+     * The components of level l are the ones from position levelBegin(l) to
+     * levelEnd(l) - 1.
+     */
+    const std::vector<unsigned>& componentsByLevel() const
+    { return componentsByLevel_; }
+
+    unsigned levelBegin(unsigned levelIdx) const
+    { return levelStart_[levelIdx]; }
+
+    unsigned levelEnd(unsigned levelIdx) const
+    { return levelStart_[levelIdx + 1]; }
+
+private:
+    void computeLevels_(const std::vector<unsigned>& offsets, const std::vector<unsigned>& targets)
+    {
+        // the components are emitted after their dependencies, so the levels of
+        // the dependencies are already known when a component is processed
+        const unsigned numComps = static_cast<unsigned>(numComponents());
+        level_.assign(numComps, 0);
+        unsigned maxLevel = 0;
+        for (unsigned compIdx = 0; compIdx < numComps; ++compIdx) {
+            unsigned level = 0;
+            for (const unsigned* v = componentBegin(compIdx); v != componentEnd(compIdx); ++v) {
+                for (unsigned edgeIdx = offsets[*v]; edgeIdx < offsets[*v + 1]; ++edgeIdx) {
+                    const unsigned depCompIdx = componentOfVertex_[targets[edgeIdx]];
+                    if (depCompIdx != compIdx)
+                        level = std::max(level, level_[depCompIdx] + 1);
+                }
+            }
+            level_[compIdx] = level;
+            maxLevel = std::max(maxLevel, level);
+        }
+
+        // sort the components by level
+        levelStart_.assign(numComps > 0 ? maxLevel + 2 : 1, 0);
+        for (unsigned compIdx = 0; compIdx < numComps; ++compIdx)
+            ++levelStart_[level_[compIdx] + 1];
+        for (std::size_t levelIdx = 1; levelIdx < levelStart_.size(); ++levelIdx)
+            levelStart_[levelIdx] += levelStart_[levelIdx - 1];
+
+        componentsByLevel_.resize(numComps);
+        std::vector<unsigned> pos(levelStart_.begin(), levelStart_.end() - 1);
+        for (unsigned compIdx = 0; compIdx < numComps; ++compIdx)
+            componentsByLevel_[pos[level_[compIdx]]++] = compIdx;
+    }
+
+    static constexpr unsigned unvisited_ = ~0u;
+
+    std::vector<unsigned> componentOfVertex_;
+    std::vector<unsigned> componentStart_{0};
+    std::vector<unsigned> vertices_;
+    std::vector<unsigned> level_;
+    std::vector<unsigned> levelStart_{0};
+    std::vector<unsigned> componentsByLevel_;
+};
+
+} // namespace Opm
+
+#endif
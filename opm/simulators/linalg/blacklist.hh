@@ -38,6 +38,9 @@
 
 #include <iostream>
 #include <algorithm>
+#include <map>
+#include <set>
+#include <vector>
 
 namespace Opm {
 namespace Linear {
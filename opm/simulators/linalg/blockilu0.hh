@@ -0,0 +1,372 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::Linear::BlockIlu0
+ */
+#ifndef EWOMS_BLOCK_ILU0_HH
+#define EWOMS_BLOCK_ILU0_HH
+
+#include <opm/common/Exceptions.hpp>
+
+#include <opm/simulators/linalg/matrixblock.hh>
+
+#include <dune/istl/bcrsmatrix.hh>
+#include <dune/istl/preconditioner.hh>
+#include <dune/istl/solvercategory.hh>
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace Opm {
+namespace Linear {
+
+/*!
+ * \ingroup Linear
+ *
+ * \brief A block ILU(0) or DILU preconditioner with multi-threaded triangular solves.
+ *
+ * The ILU(0) variant computes the incomplete LU factorization of the matrix without
+ * fill-in, the DILU ("diagonal ILU") variant only modifies the diagonal blocks and
+ * uses the off-diagonal blocks of the original matrix, i.e., it does not need to
+ * store a copy of the matrix.
+ *
+ * The forward and backward substitutions are inherently sequential if they are done
+ * row by row. Here, they are parallelized using level scheduling: The rows are
+ * grouped into levels such that each row only depends on rows of previous levels.
+ * All rows of a level can then be processed concurrently. The same scheduling is used
+ * for the factorization itself. The results are identical to those of the sequential
+ * algorithm, i.e., they do not depend on the number of threads.
+ */
+template <class Matrix, class X, class Y>
+class BlockIlu0 : public Dune::Preconditioner<X, Y>
+{
+    using Block = typename Matrix::block_type;
+    // the matrix type might be derived from BCRSMatrix (e.g. for overlapping matrices),
+    // but the factorization only needs the plain sparse matrix
+    using BCRSMatrix = Dune::BCRSMatrix<Block, typename Matrix::allocator_type>;
+    using VectorBlock = typename X::block_type;
+    using Scalar = typename X::field_type;
+
+    // the number of rows of a level which makes it worthwhile to spawn threads
+    static constexpr std::size_t minRowsPerThreadedLevel_ = 64;
+
+public:
+    using matrix_type = Matrix;
+    using domain_type = X;
+    using range_type = Y;
+    using field_type = Scalar;
+
+    /*!
+     * \brief Compute the factorization of a matrix.
+     *
+     * \param matrix The matrix. For the DILU variant, it must not be modified while
+     *               the preconditioner is in use.
+     * \param relaxationFactor The factor by which the result of the preconditioner is
+     *                         scaled.
+     * \param diagonalOnly If true, the DILU variant is used.
+     */
+    BlockIlu0(const Matrix& matrix, Scalar relaxationFactor, bool diagonalOnly = false)
+        : matrix_(matrix)
+        , relaxationFactor_(relaxationFactor)
+        , diagonalOnly_(diagonalOnly)
+    {
+        createLevels_();
+
+        if (diagonalOnly_)
+            factorizeDilu_();
+        else
+            factorizeIlu0_();
+    }
+
+    //! \copydoc Dune::Preconditioner::category()
+    Dune::SolverCategory::Category category() const override
+    { return Dune::SolverCategory::sequential; }
+
+    //! \copydoc Dune::Preconditioner::pre()
+    void pre(X&, Y&) override
+    {}
+
+    /*!
+     * \brief Apply the preconditioner.
+     *
+     * \param v The result of the preconditioner
+     * \param d The defect which ought to be preconditioned
+     */
+    void apply(X& v, const Y& d) override
+    {
+        const BCRSMatrix& A = diagonalOnly_ ? matrix_ : lu_;
+
+        // forward substitution: solve (L + D)y = d for DILU and (L + I)y = d for ILU(0).
+        // the intermediate solution is stored in v.
+        for (std::size_t levelIdx = 0; levelIdx + 1 < lowerLevelOffsets_.size(); ++levelIdx) {
+            const int begin = lowerLevelOffsets_[levelIdx];
+            const int end = lowerLevelOffsets_[levelIdx + 1];
+#ifdef _OPENMP
+#pragma omp parallel for if(end - begin >= static_cast<int>(minRowsPerThreadedLevel_))
+#endif
+            for (int idx = begin; idx < end; ++idx) {
+                const unsigned rowIdx = lowerLevelRows_[idx];
+                const auto& row = A[rowIdx];
+
+                VectorBlock rhs(d[rowIdx]);
+                for (auto colIt = row.begin(); colIt != row.end() && colIt.index() < rowIdx; ++colIt)
+                    colIt->mmv(v[colIt.index()], rhs);
+
+                if (diagonalOnly_)
+                    diagInv_[rowIdx].mv(rhs, v[rowIdx]);
+                else
+                    v[rowIdx] = rhs;
+            }
+        }
+
+        // backward substitution: solve (I + D^-1 U)v = y for DILU and (D + U)v = y for
+        // ILU(0)
+        for (std::size_t levelIdx = 0; levelIdx + 1 < upperLevelOffsets_.size(); ++levelIdx) {
+            const int begin = upperLevelOffsets_[levelIdx];
+            const int end = upperLevelOffsets_[levelIdx + 1];
+#ifdef _OPENMP
+#pragma omp parallel for if(end - begin >= static_cast<int>(minRowsPerThreadedLevel_))
+#endif
+            for (int idx = begin; idx < end; ++idx) {
+                const unsigned rowIdx = upperLevelRows_[idx];
+                const auto& row = A[rowIdx];
+
+                if (diagonalOnly_) {
+                    VectorBlock upperSum(0.0);
+                    for (auto colIt = row.beforeEnd(); colIt != row.beforeBegin() && colIt.index() > rowIdx; --colIt)
+                        colIt->umv(v[colIt.index()], upperSum);
+                    diagInv_[rowIdx].mmv(upperSum, v[rowIdx]);
+                }
+                else {
+                    VectorBlock rhs(v[rowIdx]);
+                    for (auto colIt = row.beforeEnd(); colIt != row.beforeBegin() && colIt.index() > rowIdx; --colIt)
+                        colIt->mmv(v[colIt.index()], rhs);
+                    diagInv_[rowIdx].mv(rhs, v[rowIdx]);
+                }
+            }
+        }
+
+        v *= relaxationFactor_;
+    }
+
+    //! \copydoc Dune::Preconditioner::post()
+    void post(X&) override
+    {}
+
+    /*!
+     * \brief Returns the number of levels of the forward and backward substitutions.
+     *
+     * The average number of rows per level indicates how much parallelism is
+     * available.
+     */
+    std::pair<std::size_t, std::size_t> numLevels() const
+    { return { lowerLevelOffsets_.size() - 1, upperLevelOffsets_.size() - 1 }; }
+
+private:
+    // group the rows into levels. a row's level for the forward substitution is one
+    // more than the maximum level of the rows referenced by its strictly lower part;
+    // the backward substitution is treated analogously using the strictly upper part.
+    void createLevels_()
+    {
+        const std::size_t numRows = matrix_.N();
+
+        std::vector<int> level(numRows, 0);
+        for (std::size_t rowIdx = 0; rowIdx < numRows; ++rowIdx) {
+            const auto& row = matrix_[rowIdx];
+            for (auto colIt = row.begin(); colIt != row.end() && colIt.index() < rowIdx; ++colIt)
+                level[rowIdx] = std::max(level[rowIdx], level[colIt.index()] + 1);
+        }
+        sortByLevel_(level, lowerLevelOffsets_, lowerLevelRows_);
+
+        std::fill(level.begin(), level.end(), 0);
+        for (std::size_t rowIdx = numRows; rowIdx-- > 0; ) {
+            const auto& row = matrix_[rowIdx];
+            for (auto colIt = row.begin(); colIt != row.end(); ++colIt)
+                if (colIt.index() > rowIdx)
+                    level[rowIdx] = std::max(level[rowIdx], level[colIt.index()] + 1);
+        }
+        sortByLevel_(level, upperLevelOffsets_, upperLevelRows_);
+    }
+
+    static void sortByLevel_(const std::vector<int>& level,
+                             std::vector<int>& offsets,
+                             std::vector<unsigned>& rows)
+    {
+        const int numLevels = level.empty() ? 0 : *std::max_element(level.begin(), level.end()) + 1;
+
+        // counting sort of the rows by their level. within a level, the rows are kept
+        // in ascending order.
+        offsets.assign(numLevels + 1, 0);
+        for (int l : level)
+            ++offsets[l + 1];
+        for (int levelIdx = 0; levelIdx < numLevels; ++levelIdx)
+            offsets[levelIdx + 1] += offsets[levelIdx];
+
+        rows.resize(level.size());
+        std::vector<int> pos(offsets.begin(), offsets.end() - 1);
+        for (std::size_t rowIdx = 0; rowIdx < level.size(); ++rowIdx)
+            rows[pos[level[rowIdx]]++] = rowIdx;
+    }
+
+    // the ILU(0) factorization in IKJ order. The strictly lower part of lu_ contains
+    // L (with an implicit unit diagonal), the remaining part contains U.
+    void factorizeIlu0_()
+    {
+        lu_ = matrix_;
+        diagInv_.resize(lu_.N());
+
+        int singular = 0;
+        for (std::size_t levelIdx = 0; levelIdx + 1 < lowerLevelOffsets_.size(); ++levelIdx) {
+            const int begin = lowerLevelOffsets_[levelIdx];
+            const int end = lowerLevelOffsets_[levelIdx + 1];
+#ifdef _OPENMP
+#pragma omp parallel for if(end - begin >= static_cast<int>(minRowsPerThreadedLevel_)) reduction(+:singular)
+#endif
+            for (int idx = begin; idx < end; ++idx) {
+                const unsigned rowIdx = lowerLevelRows_[idx];
+                auto& row = lu_[rowIdx];
+
+                auto colIt = row.begin();
+                for (; colIt != row.end() && colIt.index() < rowIdx; ++colIt) {
+                    const unsigned k = colIt.index();
+
+                    // row k has been counted as singular if it does not exhibit a
+                    // diagonal block, so U_kk^-1 is not available
+                    const auto& rowK = lu_[k];
+                    auto kjIt = rowK.find(k);
+                    if (kjIt == rowK.end())
+                        continue;
+
+                    // L_ik = A_ik * U_kk^-1
+                    colIt->rightmultiply(diagInv_[k]);
+
+                    // A_ij -= L_ik*U_kj for all j > k which exist in both rows
+                    ++kjIt;
+                    auto ijIt = colIt;
+                    ++ijIt;
+                    while (ijIt != row.end() && kjIt != rowK.end()) {
+                        if (ijIt.index() < kjIt.index())
+                            ++ijIt;
+                        else if (kjIt.index() < ijIt.index())
+                            ++kjIt;
+                        else {
+                            Block tmp(*colIt);
+                            tmp.rightmultiply(*kjIt);
+                            *ijIt -= tmp;
+                            ++ijIt;
+                            ++kjIt;
+                        }
+                    }
+                }
+
+                if (colIt == row.end() || colIt.index() != rowIdx) {
+                    ++singular;
+                    continue;
+                }
+
+                singular += invertDiagonal_(rowIdx, *colIt);
+            }
+        }
+
+        if (singular > 0)
+            throw NumericalProblem("ILU(0) factorization encountered a singular "
+                                   "or missing diagonal block");
+    }
+
+    // the DILU factorization: D_ii = A_ii - sum_{k < i} A_ik D_kk^-1 A_ki
+    void factorizeDilu_()
+    {
+        diagInv_.resize(matrix_.N());
+
+        int singular = 0;
+        for (std::size_t levelIdx = 0; levelIdx + 1 < lowerLevelOffsets_.size(); ++levelIdx) {
+            const int begin = lowerLevelOffsets_[levelIdx];
+            const int end = lowerLevelOffsets_[levelIdx + 1];
+#ifdef _OPENMP
+#pragma omp parallel for if(end - begin >= static_cast<int>(minRowsPerThreadedLevel_)) reduction(+:singular)
+#endif
+            for (int idx = begin; idx < end; ++idx) {
+                const unsigned rowIdx = lowerLevelRows_[idx];
+                const auto& row = matrix_[rowIdx];
+
+                const auto diagIt = row.find(rowIdx);
+                if (diagIt == row.end()) {
+                    ++singular;
+                    continue;
+                }
+
+                Block diag(*diagIt);
+                for (auto colIt = row.begin(); colIt.index() < rowIdx; ++colIt) {
+                    const unsigned k = colIt.index();
+                    const auto kiIt = matrix_[k].find(rowIdx);
+                    if (kiIt == matrix_[k].end())
+                        continue;
+
+                    Block tmp(*colIt);
+                    tmp.rightmultiply(diagInv_[k]);
+                    tmp.rightmultiply(*kiIt);
+                    diag -= tmp;
+                }
+
+                singular += invertDiagonal_(rowIdx, diag);
+            }
+        }
+
+        if (singular > 0)
+            throw NumericalProblem("DILU factorization encountered a singular "
+                                   "or missing diagonal block");
+    }
+
+    int invertDiagonal_(unsigned rowIdx, const Block& diag)
+    {
+        try {
+            diagInv_[rowIdx] = diag;
+            diagInv_[rowIdx].invert();
+        }
+        catch (...) {
+            return 1;
+        }
+
+        return 0;
+    }
+
+    const BCRSMatrix& matrix_;
+    BCRSMatrix lu_;
+    std::vector<Block> diagInv_;
+
+    Scalar relaxationFactor_;
+    bool diagonalOnly_;
+
+    // the rows of the forward and backward substitutions grouped by level
+    std::vector<int> lowerLevelOffsets_;
+    std::vector<unsigned> lowerLevelRows_;
+    std::vector<int> upperLevelOffsets_;
+    std::vector<unsigned> upperLevelRows_;
+};
+
+}} // namespace Linear, Opm
+
+#endif
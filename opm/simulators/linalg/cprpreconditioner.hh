@@ -0,0 +1,305 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::Linear::CprPreconditioner
+ */
+#ifndef EWOMS_CPR_PRECONDITIONER_HH
+#define EWOMS_CPR_PRECONDITIONER_HH
+
+#include <opm/simulators/linalg/blockilu0.hh>
+
+#include <dune/common/fmatrix.hh>
+#include <dune/common/fvector.hh>
+#include <dune/istl/bcrsmatrix.hh>
+#include <dune/istl/bvector.hh>
+#include <dune/istl/operators.hh>
+#include <dune/istl/preconditioner.hh>
+#include <dune/istl/preconditioners.hh>
+#include <dune/istl/solvercategory.hh>
+#include <dune/istl/paamg/amg.hh>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace Opm {
+namespace Linear {
+
+/*!
+ * \ingroup Linear
+ *
+ * \brief A two-stage constrained pressure residual (CPR) preconditioner.
+ *
+ * The first stage reduces each block row of the system to a scalar pressure
+ * equation using a weighted sum of the conservation equations and approximately
+ * solves the resulting pressure system with a single cycle of algebraic
+ * multi-grid. The second stage applies block ILU(0) to the residual which is
+ * left after the pressure correction.
+ *
+ * The weights of the pressure equation are either the "quasi-IMPES" weights,
+ * i.e., the solution of D^T w = e_p with D being the diagonal block of the row
+ * and e_p the unit vector of the pressure variable, which approximately
+ * decouples the pressure from the other primary variables, or unit weights,
+ * which simply add up all conservation equations.
+ */
+template <class Matrix, class X, class Y>
+class CprPreconditioner : public Dune::Preconditioner<X, Y>
+{
+    using Block = typename Matrix::block_type;
+    using VectorBlock = typename X::block_type;
+    using Scalar = typename X::field_type;
+
+    static constexpr int numEq = VectorBlock::dimension;
+
+    using PressureMatrix = Dune::BCRSMatrix<Dune::FieldMatrix<Scalar, 1, 1> >;
+    using PressureVector = Dune::BlockVector<Dune::FieldVector<Scalar, 1> >;
+    using PressureOperator = Dune::MatrixAdapter<PressureMatrix, PressureVector, PressureVector>;
+    using PressureSmoother = Dune::SeqSSOR<PressureMatrix, PressureVector, PressureVector>;
+    using PressureAmg = Dune::Amg::AMG<PressureOperator, PressureVector, PressureSmoother>;
+    using SecondStage = BlockIlu0<Matrix, X, Y>;
+
+public:
+    using matrix_type = Matrix;
+    using domain_type = X;
+    using range_type = Y;
+    using field_type = Scalar;
+
+    //! The weights used to reduce the block system to the pressure equation
+    enum class Weights { QuasiImpes, Unit };
+
+    /*!
+     * \brief Set up the preconditioner for a matrix.
+     *
+     * \param matrix The matrix. It must not be modified while the preconditioner
+     *               is in use.
+     * \param pressureVarIdx The index of the pressure in the primary variables
+     * \param weights The kind of weights used to form the pressure equation
+     * \param coarsenTarget The number of unknowns of the coarsest level of the
+     *                      pressure AMG
+     * \param relaxationFactor The factor by which the result of the second stage
+     *                         is scaled.
+     */
+    CprPreconditioner(const Matrix& matrix,
+                      unsigned pressureVarIdx,
+                      Weights weights,
+                      int coarsenTarget,
+                      Scalar relaxationFactor)
+        : matrix_(matrix)
+        , pressureVarIdx_(pressureVarIdx)
+    {
+        computeWeights_(weights);
+        createPressureMatrix_();
+        createPressureAmg_(coarsenTarget);
+        secondStage_ = std::make_unique<SecondStage>(matrix, relaxationFactor);
+    }
+
+    //! \copydoc Dune::Preconditioner::category()
+    Dune::SolverCategory::Category category() const override
+    { return Dune::SolverCategory::sequential; }
+
+    //! \copydoc Dune::Preconditioner::pre()
+    void pre(X& x, Y& y) override
+    {
+        pressureAmg_->pre(pressureX_, pressureRhs_);
+        secondStage_->pre(x, y);
+    }
+
+    /*!
+     * \brief Apply the preconditioner.
+     *
+     * \param v The result of the preconditioner
+     * \param d The defect which ought to be preconditioned
+     */
+    void apply(X& v, const Y& d) override
+    {
+        const std::size_t numRows = matrix_.N();
+        const long n = static_cast<long>(numRows);
+
+        // first stage: restrict the defect to the pressure equation and solve for
+        // the pressure correction
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (long rowIdx = 0; rowIdx < n; ++rowIdx)
+            pressureRhs_[rowIdx] = weights_[rowIdx]*d[rowIdx];
+
+        pressureX_ = 0.0;
+        pressureAmg_->apply(pressureX_, pressureRhs_);
+
+        // compute the defect which remains after the pressure correction. only the
+        // pressure components of the correction are non-zero, so only the
+        // corresponding columns of the matrix are needed.
+        if (!residual_)
+            residual_ = std::make_unique<Y>(d);
+        Y& residual = *residual_;
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (long rowIdx = 0; rowIdx < n; ++rowIdx) {
+            VectorBlock r(d[rowIdx]);
+            const auto& row = matrix_[rowIdx];
+            for (auto colIt = row.begin(); colIt != row.end(); ++colIt) {
+                const Scalar xp = pressureX_[colIt.index()][0];
+                for (int eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                    r[eqIdx] -= (*colIt)[eqIdx][pressureVarIdx_]*xp;
+            }
+            residual[rowIdx] = r;
+        }
+
+        // second stage: smooth the remaining defect and add the pressure correction
+        secondStage_->apply(v, residual);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (long rowIdx = 0; rowIdx < n; ++rowIdx)
+            v[rowIdx][pressureVarIdx_] += pressureX_[rowIdx][0];
+    }
+
+    //! \copydoc Dune::Preconditioner::post()
+    void post(X& x) override
+    {
+        secondStage_->post(x);
+        pressureAmg_->post(pressureX_);
+    }
+
+private:
+    void computeWeights_(Weights weights)
+    {
+        const std::size_t numRows = matrix_.N();
+        weights_.resize(numRows);
+
+        const long n = static_cast<long>(numRows);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (long rowIdx = 0; rowIdx < n; ++rowIdx) {
+            VectorBlock& w = weights_[rowIdx];
+            w = 1.0;
+            if (weights == Weights::Unit)
+                continue;
+
+            const auto diagIt = matrix_[rowIdx].find(rowIdx);
+            if (diagIt == matrix_[rowIdx].end())
+                continue;
+
+            Dune::FieldMatrix<Scalar, numEq, numEq> diagT;
+            for (int i = 0; i < numEq; ++i)
+                for (int j = 0; j < numEq; ++j)
+                    diagT[i][j] = (*diagIt)[j][i];
+
+            VectorBlock unitPressure(0.0);
+            unitPressure[pressureVarIdx_] = 1.0;
+            try {
+                diagT.solve(w, unitPressure);
+            }
+            catch (const Dune::FMatrixError&) {
+                // singular diagonal block: add up all equations
+                w = 1.0;
+                continue;
+            }
+
+            // scale the weights to avoid badly scaled pressure equations
+            const Scalar maxWeight = w.infinity_norm();
+            if (maxWeight > 0.0 && std::isfinite(maxWeight))
+                w /= maxWeight;
+            else
+                w = 1.0;
+        }
+    }
+
+    void createPressureMatrix_()
+    {
+        const std::size_t numRows = matrix_.N();
+        pressureMatrix_.setBuildMode(PressureMatrix::row_wise);
+        pressureMatrix_.setSize(numRows, numRows, matrix_.nonzeroes());
+        for (auto rowIt = pressureMatrix_.createbegin(); rowIt != pressureMatrix_.createend(); ++rowIt) {
+            const auto& row = matrix_[rowIt.index()];
+            for (auto colIt = row.begin(); colIt != row.end(); ++colIt)
+                rowIt.insert(colIt.index());
+        }
+
+        // the pressure equation of a row is the weighted sum of its conservation
+        // equations, restricted to the pressure column of each block
+        const long n = static_cast<long>(numRows);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (long rowIdx = 0; rowIdx < n; ++rowIdx) {
+            const auto& w = weights_[rowIdx];
+            const auto& row = matrix_[rowIdx];
+            auto pressureColIt = pressureMatrix_[rowIdx].begin();
+            for (auto colIt = row.begin(); colIt != row.end(); ++colIt, ++pressureColIt) {
+                Scalar value = 0.0;
+                for (int eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                    value += w[eqIdx]*(*colIt)[eqIdx][pressureVarIdx_];
+                (*pressureColIt)[0][0] = value;
+            }
+        }
+
+        pressureRhs_.resize(numRows);
+        pressureX_.resize(numRows);
+    }
+
+    void createPressureAmg_(int coarsenTarget)
+    {
+        using SmootherArgs = typename Dune::Amg::SmootherTraits<PressureSmoother>::Arguments;
+        SmootherArgs smootherArgs;
+        smootherArgs.iterations = 1;
+        smootherArgs.relaxationFactor = 1.0;
+
+        // use the same coarsening as the AMG backend, except that the pressure
+        // system is scalar
+        using CoarsenCriterion = Dune::Amg::
+            CoarsenCriterion<Dune::Amg::SymmetricCriterion<PressureMatrix, Dune::Amg::FirstDiagonal> >;
+        CoarsenCriterion coarsenCriterion(/*maxLevel=*/15, coarsenTarget);
+        coarsenCriterion.setDefaultValuesIsotropic(/*dim=*/2, /*aggregateSizePerDim=*/3);
+        coarsenCriterion.setDebugLevel(0);
+        coarsenCriterion.setMinCoarsenRate(1.05);
+        coarsenCriterion.setAccumulate(Dune::Amg::atOnceAccu);
+        coarsenCriterion.setSkipIsolated(false);
+
+        pressureOperator_ = std::make_unique<PressureOperator>(pressureMatrix_);
+        pressureAmg_ = std::make_unique<PressureAmg>(*pressureOperator_, coarsenCriterion, smootherArgs);
+    }
+
+    const Matrix& matrix_;
+    unsigned pressureVarIdx_;
+
+    std::vector<VectorBlock> weights_;
+    PressureMatrix pressureMatrix_;
+    PressureVector pressureRhs_;
+    PressureVector pressureX_;
+    std::unique_ptr<Y> residual_;
+
+    std::unique_ptr<PressureOperator> pressureOperator_;
+    std::unique_ptr<PressureAmg> pressureAmg_;
+    std::unique_ptr<SecondStage> secondStage_;
+};
+
+} // namespace Linear
+} // namespace Opm
+
+#endif
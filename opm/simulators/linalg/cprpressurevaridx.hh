@@ -0,0 +1,59 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::Linear::detail::CprPressureVarIdx
+ */
+#ifndef EWOMS_CPR_PRESSURE_VAR_IDX_HH
+#define EWOMS_CPR_PRESSURE_VAR_IDX_HH
+
+#include <type_traits>
+
+namespace Opm {
+namespace Linear {
+namespace detail {
+
+/*!
+ * \brief The index of the pressure in the primary variables of a model.
+ *
+ * The black-oil models call it pressureSwitchIdx, most other models pressure0Idx.
+ * For models which have neither, the first primary variable is used.
+ */
+template <class Indices, class = void>
+struct CprPressureVarIdx
+{ static constexpr unsigned value = 0; };
+
+template <class Indices>
+struct CprPressureVarIdx<Indices, std::void_t<decltype(Indices::pressure0Idx)> >
+{ static constexpr unsigned value = Indices::pressure0Idx; };
+
+template <class Indices>
+struct CprPressureVarIdx<Indices, std::void_t<decltype(Indices::pressureSwitchIdx)> >
+{ static constexpr unsigned value = Indices::pressureSwitchIdx; };
+
+} // namespace detail
+} // namespace Linear
+} // namespace Opm
+
+#endif
@@ -30,13 +30,18 @@
 #include "foreignoverlapfrombcrsmatrix.hh"
 #include "blacklist.hh"
 #include "globalindices.hh"
+#include "neighborexchange.hh"
+#include "sharedmemoryexchange.hh"
 
 #include <opm/models/parallel/mpibuffer.hh>
 
 #include <algorithm>
 #include <limits>
+#include <memory>
 #include <set>
 #include <map>
+#include <typeindex>
+#include <typeinfo>
 #include <vector>
 
 namespace Opm {
@@ -145,6 +150,27 @@ public:
     const PeerSet& peerSet() const
     { return peerSet_; }
 
+    /*!
+     * \brief Returns the object which exchanges the values of a given type
+     *        with the peer processes on the same compute node.
+     *
+     * All vectors which use the same overlap and value type share this object,
+     * so the node communicator and the shared memory window are only set up
+     * once. The first call for a given value type is collective on
+     * MPI_COMM_WORLD.
+     */
+    template <class Value>
+    std::shared_ptr<SharedMemoryExchange<Value> > nodeExchange() const
+    {
+        auto& exchange = nodeExchanges_[std::type_index(typeid(Value))];
+        if (!exchange)
+            exchange = std::make_shared<SharedMemoryExchange<Value> >(
+                peerSet_,
+                [this](ProcessRank peerRank) { return foreignOverlapSize(peerRank); });
+
+        return std::static_pointer_cast<SharedMemoryExchange<Value> >(exchange);
+    }
+
     /*!
      * \brief Returns true iff a domestic index is a border index.
      */
@@ -384,29 +410,20 @@ protected:
         domesticOverlapByIndex_.resize(numLocal());
         borderDistance_.resize(numLocal(), 0);
 
-        PeerSet::const_iterator peerIt;
-        PeerSet::const_iterator peerEndIt = peerSet_.end();
+        // send the overlap indices to all peer processes and receive our
+        // overlap from them in a single exchange
+        NeighborExchange peerExchange(peerSet_);
+        std::vector<std::vector<IndexDistanceNpeers> > sendBufs(peerExchange.numPeers());
+        std::vector<std::vector<IndexDistanceNpeers> > recvBufs;
+        for (size_t i = 0; i < peerExchange.numPeers(); ++i)
+            createIndicesForPeer_(peerExchange.peer(i), sendBufs[i]);
 
-        // send the overlap indices to all peer processes
-        peerIt = peerSet_.begin();
-        for (; peerIt != peerEndIt; ++peerIt) {
-            ProcessRank peerRank = *peerIt;
-            sendIndicesToPeer_(peerRank);
-        }
-
-        // receive our overlap from the processes to all peer processes
-        peerIt = peerSet_.begin();
-        for (; peerIt != peerEndIt; ++peerIt) {
-            ProcessRank peerRank = *peerIt;
-            receiveIndicesFromPeer_(peerRank);
-        }
+        peerExchange.exchange(sendBufs, recvBufs);
 
-        // wait until all send operations complete
-        peerIt = peerSet_.begin();
-        for (; peerIt != peerEndIt; ++peerIt) {
-            ProcessRank peerRank = *peerIt;
-            waitSendIndices_(peerRank);
-        }
+        // the order in which the received indices are processed determines the
+        // domestic indices of the overlap, so this needs to be done sequentially
+        for (size_t i = 0; i < peerExchange.numPeers(); ++i)
+            addIndicesFromPeer_(peerExchange.peer(i), recvBufs[i]);
     }
 
     void updateMasterRanks_()
@@ -444,66 +461,38 @@ protected:
         }
     }
 
-    void sendIndicesToPeer_([[maybe_unused]] ProcessRank peerRank)
+    // create the list of our foreign overlap with a peer process expressed
+    // in global indices
+    void createIndicesForPeer_(ProcessRank peerRank,
+                               std::vector<IndexDistanceNpeers>& indices) const
     {
-#if HAVE_MPI
         const auto& foreignOverlap = foreignOverlap_.foreignOverlapWithPeer(peerRank);
 
-        // first, send a message containing the number of additional
-        // indices stemming from the overlap (i.e. without the border
-        // indices)
-        size_t numIndices = foreignOverlap.size();
-        numIndicesSendBuffer_[peerRank] = new MpiBuffer<size_t>(1);
-        (*numIndicesSendBuffer_[peerRank])[0] = numIndices;
-        numIndicesSendBuffer_[peerRank]->send(peerRank);
-
-        // create MPI buffers
-        indicesSendBuffer_[peerRank] = new MpiBuffer<IndexDistanceNpeers>(numIndices);
-
-        // then send the additional indices themselfs
-        auto overlapIt = foreignOverlap.begin();
-        const auto& overlapEndIt = foreignOverlap.end();
-        for (unsigned i = 0; overlapIt != overlapEndIt; ++overlapIt, ++i) {
-            Index localIdx = overlapIt->index;
-            BorderDistance borderDistance = overlapIt->borderDistance;
+        indices.resize(foreignOverlap.size());
+#ifdef _OPENMP
+#pragma omp parallel for if(indices.size() > 1024)
+#endif
+        for (size_t i = 0; i < foreignOverlap.size(); ++i) {
+            Index localIdx = foreignOverlap[i].index;
             size_t numPeers = foreignOverlap_.foreignOverlapByLocalIndex(localIdx).size();
 
-            IndexDistanceNpeers tmp;
+            IndexDistanceNpeers& tmp = indices[i];
             tmp.index = globalIndices_.domesticToGlobal(localIdx);
-            tmp.borderDistance = borderDistance;
+            tmp.borderDistance = foreignOverlap[i].borderDistance;
             tmp.numPeers = static_cast<unsigned>(numPeers);
-
-            (*indicesSendBuffer_[peerRank])[i] = tmp;
         }
-
-        indicesSendBuffer_[peerRank]->send(peerRank);
-#endif // HAVE_MPI
     }
 
-    void waitSendIndices_(ProcessRank peerRank)
+    // add the foreign overlap of a peer process to the domestic indices
+    void addIndicesFromPeer_(ProcessRank peerRank,
+                             const std::vector<IndexDistanceNpeers>& indices)
     {
-        numIndicesSendBuffer_[peerRank]->wait();
-        delete numIndicesSendBuffer_[peerRank];
+        auto& overlapWithPeer = domesticOverlapWithPeer_[peerRank];
+        overlapWithPeer.reserve(overlapWithPeer.size() + indices.size());
 
-        indicesSendBuffer_[peerRank]->wait();
-        delete indicesSendBuffer_[peerRank];
-    }
-
-    void receiveIndicesFromPeer_([[maybe_unused]] ProcessRank peerRank)
-    {
-#if HAVE_MPI
-        // receive the number of additional indices
-        int numIndices = -1;
-        MpiBuffer<size_t> numIndicesRecvBuff(1);
-        numIndicesRecvBuff.receive(peerRank);
-        numIndices = static_cast<int>(numIndicesRecvBuff[0]);
-
-        // receive the additional indices themselfs
-        MpiBuffer<IndexDistanceNpeers> recvBuff(static_cast<size_t>(numIndices));
-        recvBuff.receive(peerRank);
-        for (unsigned i = 0; i < static_cast<unsigned>(numIndices); ++i) {
-            Index globalIdx = recvBuff[i].index;
-            BorderDistance borderDistance = recvBuff[i].borderDistance;
+        for (const auto& idx : indices) {
+            Index globalIdx = idx.index;
+            BorderDistance borderDistance = idx.borderDistance;
 
             // if the index is not already known, add it to the
             // domestic indices
@@ -521,7 +510,7 @@ protected:
 
             // extend the domestic overlap
             domesticOverlapByIndex_[static_cast<unsigned>(domesticIdx)][static_cast<unsigned>(peerRank)] = borderDistance;
-            domesticOverlapWithPeer_[static_cast<unsigned>(peerRank)].push_back(domesticIdx);
+            overlapWithPeer.push_back(domesticIdx);
 
             //assert(borderDistance >= 0);
             assert(globalIdx >= 0);
@@ -531,7 +520,6 @@ protected:
 
             borderDistance_[static_cast<unsigned>(domesticIdx)] = std::min(borderDistance, borderDistance_[static_cast<unsigned>(domesticIdx)]);
         }
-#endif // HAVE_MPI
     }
 
     // this method is intended to set up the code mapping code for
@@ -571,10 +559,10 @@ protected:
     std::vector<BorderDistance> borderDistance_;
     std::vector<ProcessRank> masterRank_;
 
-    std::map<ProcessRank, MpiBuffer<size_t> *> numIndicesSendBuffer_;
-    std::map<ProcessRank, MpiBuffer<IndexDistanceNpeers> *> indicesSendBuffer_;
     GlobalIndices globalIndices_;
     PeerSet peerSet_;
+
+    mutable std::map<std::type_index, std::shared_ptr<void> > nodeExchanges_;
 };
 
 } // namespace Linear
@@ -0,0 +1,198 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::Linear::ExplicitCellCondenser
+ */
+#ifndef EWOMS_EXPLICIT_CELL_CONDENSER_HH
+#define EWOMS_EXPLICIT_CELL_CONDENSER_HH
+
+#include <cstddef>
+#include <vector>
+
+namespace Opm {
+namespace Linear {
+
+/*!
+ * \ingroup Linear
+ *
+ * \brief Condenses all unknowns except the pressure of a set of cells out of a block
+ *        matrix and recovers them after the linear solve.
+ *
+ * This is used by the adaptive implicit mode of the TPFA linearizer for the cells
+ * which are treated explicitly.
+ *
+ * First, the derivatives of the other cells' equations with regard to the condensed
+ * unknowns are dropped, i.e., the other cells see them as constant during the linear
+ * solve. The block (j, i) is only touched for the explicit cell i, so the cells can be
+ * processed in parallel.
+ *
+ * Then, the row of each explicit cell i is multiplied by the inverse of its diagonal
+ * block D. For the off-diagonal block A of column k, C = D^-1 A is kept for expand()
+ * and A is replaced by D e_p C[p], with p being the pressure. The pressure update of
+ * the cell is unaffected by this, but its remaining unknowns only depend on the
+ * cell's own residual. This makes them trivial for the linear solver and the dropped
+ * coupling is recovered by expand(). The row of a cell with a singular diagonal block
+ * is left unchanged.
+ *
+ * The residual does not need to be modified.
+ */
+template <class Matrix, class Vector>
+class ExplicitCellCondenser
+{
+    using MatrixBlock = typename Matrix::block_type;
+    using VectorBlock = typename Vector::block_type;
+
+    static constexpr int numEq = VectorBlock::dimension;
+
+public:
+    /*!
+     * \brief Condense the unknowns of the explicit cells out of the matrix.
+     *
+     * \param matrix The matrix which is modified
+     * \param explicitCells The indices of the explicit cells in ascending order
+     * \param pressureIdx The index of the unknown which is kept for the explicit cells
+     */
+    void condense(Matrix& matrix, const std::vector<unsigned>& explicitCells, unsigned pressureIdx)
+    {
+        explicitCells_ = explicitCells;
+        pressureIdx_ = pressureIdx;
+
+        condensedStart_.assign(1, 0);
+        for (unsigned globI : explicitCells_)
+            condensedStart_.push_back(condensedStart_.back() + matrix[globI].size() - 1);
+        condensedBlocks_.resize(condensedStart_.back());
+        condensedCols_.resize(condensedStart_.back());
+
+        const long numExplicit = static_cast<long>(explicitCells_.size());
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (long ii = 0; ii < numExplicit; ++ii) {
+            const unsigned globI = explicitCells_[ii];
+            for (auto colIt = matrix[globI].begin(); colIt != matrix[globI].end(); ++colIt) {
+                if (colIt.index() == globI)
+                    continue;
+
+                auto blockIt = matrix[colIt.index()].find(globI);
+                if (blockIt == matrix[colIt.index()].end())
+                    continue;
+
+                MatrixBlock& block = *blockIt;
+                for (int eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                    for (int pvIdx = 0; pvIdx < numEq; ++pvIdx)
+                        if (pvIdx != static_cast<int>(pressureIdx_))
+                            block[eqIdx][pvIdx] = 0.0;
+            }
+        }
+
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (long ii = 0; ii < numExplicit; ++ii) {
+            const unsigned globI = explicitCells_[ii];
+            auto& row = matrix[globI];
+            const MatrixBlock& diag = row[globI];
+            MatrixBlock invDiag(diag);
+            bool isInvertible = true;
+            try {
+                invDiag.invert();
+            }
+            catch (...) {
+                isInvertible = false;
+            }
+
+            unsigned k = condensedStart_[ii];
+            for (auto colIt = row.begin(); colIt != row.end(); ++colIt) {
+                if (colIt.index() == globI)
+                    continue;
+
+                MatrixBlock& condensed = condensedBlocks_[k];
+                condensedCols_[k] = static_cast<unsigned>(colIt.index());
+                ++k;
+                if (!isInvertible) {
+                    condensed = 0.0;
+                    continue;
+                }
+
+                condensed = invDiag;
+                condensed.rightmultiply(*colIt);
+                for (int eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                    for (int pvIdx = 0; pvIdx < numEq; ++pvIdx)
+                        (*colIt)[eqIdx][pvIdx] = diag[eqIdx][pressureIdx_]*condensed[pressureIdx_][pvIdx];
+            }
+        }
+    }
+
+    /*!
+     * \brief Recover the unknowns of the explicit cells from the solution of the
+     *        condensed linear system.
+     */
+    void expand(Vector& x) const
+    {
+        // the corrections are computed before any of them is applied because the
+        // pressures of the neighbors may belong to explicit cells as well
+        const long numExplicit = static_cast<long>(explicitCells_.size());
+        std::vector<VectorBlock> corrections(explicitCells_.size());
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (long ii = 0; ii < numExplicit; ++ii) {
+            VectorBlock& correction = corrections[ii];
+            correction = 0.0;
+            for (unsigned k = condensedStart_[ii]; k < condensedStart_[ii + 1]; ++k)
+                condensedBlocks_[k].umv(x[condensedCols_[k]], correction);
+        }
+
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (long ii = 0; ii < numExplicit; ++ii) {
+            auto& update = x[explicitCells_[ii]];
+            for (int pvIdx = 0; pvIdx < numEq; ++pvIdx)
+                if (pvIdx != static_cast<int>(pressureIdx_))
+                    update[pvIdx] -= corrections[ii][pvIdx];
+        }
+    }
+
+    /*!
+     * \brief Returns the number of cells which have been condensed by the last call
+     *        to condense().
+     */
+    std::size_t numExplicitCells() const
+    { return explicitCells_.size(); }
+
+private:
+    // the condensed blocks C of the explicit cells. the blocks of the cell
+    // explicitCells_[ii] are in the range [condensedStart_[ii], condensedStart_[ii + 1])
+    std::vector<unsigned> explicitCells_;
+    std::vector<unsigned> condensedStart_{0};
+    std::vector<unsigned> condensedCols_;
+    std::vector<MatrixBlock> condensedBlocks_;
+    unsigned pressureIdx_ = 0;
+};
+
+} // namespace Linear
+} // namespace Opm
+
+#endif
@@ -29,6 +29,7 @@
 
 #include "overlaptypes.hh"
 #include "blacklist.hh"
+#include "neighborexchange.hh"
 
 #include <opm/models/parallel/mpibuffer.hh>
 
@@ -39,13 +40,16 @@
 
 #include <algorithm>
 #include <iostream>
-#include <map>
 #include <vector>
 
 #if HAVE_MPI
 #include <mpi.h>
 #endif // HAVE_MPI
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 namespace Opm {
 namespace Linear {
 
@@ -90,6 +94,7 @@ public:
 
         // calculate the set of local indices on the border (beware:
         // _not_ the native ones)
+        isLocalBorderIndex_.assign(numLocal(), 0);
         auto it = borderList.begin();
         const auto& endIt = borderList.end();
         for (; it != endIt; ++it) {
@@ -97,9 +102,13 @@ public:
             if (localIdx < 0)
                 continue;
 
-            localBorderIndices_.insert(localIdx);
+            isLocalBorderIndex_[static_cast<unsigned>(localIdx)] = 1;
         }
 
+        // sort the border list to quickly find the peer index of a border index
+        sortedBorderList_.assign(borderList.begin(), borderList.end());
+        std::sort(sortedBorderList_.begin(), sortedBorderList_.end(), borderIndexLess_);
+
         // compute the set of processes which are neighbors of the
         // local process ...
         neighborPeerSet_.update(borderList);
@@ -124,6 +133,18 @@ public:
             minBorderDist = std::min(minBorderDist, borderIt->borderDistance);
         }
 
+#if HAVE_MPI
+        // each level of the breadth first search below exchanges data using a
+        // neighborhood collective, so all processes must agree on the number of
+        // levels, including the ones which do not have any border indices.
+        MPI_Allreduce(MPI_IN_PLACE,   // send buffer
+                      &minBorderDist, // receive buffer
+                      1,              // count
+                      MPI_UNSIGNED,   // data type
+                      MPI_MIN,        // operation
+                      MPI_COMM_WORLD); // communicator
+#endif // HAVE_MPI
+
         // calculate the foreign overlap for the local partition,
         // i.e. find the distance of each row from the seed set.
         foreignOverlapByLocalIndex_.resize(numLocal());
@@ -147,7 +168,11 @@ public:
      * \brief Returns true iff a local index is a border index.
      */
     bool isBorder(Index localIdx) const
-    { return localBorderIndices_.count(localIdx) > 0; }
+    {
+        return localIdx >= 0
+            && static_cast<size_t>(localIdx) < isLocalBorderIndex_.size()
+            && isLocalBorderIndex_[static_cast<unsigned>(localIdx)] != 0;
+    }
 
     /*!
      * \brief Returns true iff a local index is a border index shared with a
@@ -204,7 +229,7 @@ public:
      * \brief Return the map of (peer rank, border distance) for a given local
      * index.
      */
-    const std::map<ProcessRank, BorderDistance> &
+    const OverlapWithIndex&
     foreignOverlapByLocalIndex(Index localIdx) const
     {
         assert(isLocal(localIdx));
@@ -342,53 +367,82 @@ public:
     }
 
 protected:
-    // extend the foreign overlaps by 'overlapSize' levels. this uses
-    // a greedy algorithm which extends the region by one level and
-    // then calls itself recursively...
+    // extend the foreign overlaps by 'overlapSize' levels. this is a
+    // breadth first search over the rows of the matrix which extends the
+    // region by one level per iteration.
     template <class BCRSMatrix>
     void extendForeignOverlap_(const BCRSMatrix& A,
                                SeedList& seedList,
                                BorderDistance borderDistance,
                                BorderDistance overlapSize)
     {
-        // communicate the non-neigbor overlap indices
-        addNonNeighborOverlapIndices_(A, seedList, borderDistance);
-
-        // add all processes in the seed rows of the current overlap level
-        auto seedIt = seedList.begin();
-        const auto& seedEndIt = seedList.end();
-        for (; seedIt != seedEndIt; ++seedIt) {
-            Index localIdx = nativeToLocal(seedIt->index);
-            ProcessRank peerRank = seedIt->peerRank;
-            unsigned distance = borderDistance;
-            if (localIdx < 0)
-                continue;
-            if (foreignOverlapByLocalIndex_[static_cast<unsigned>(localIdx)].count(peerRank) == 0)
-                foreignOverlapByLocalIndex_[static_cast<unsigned>(localIdx)][peerRank] = distance;
+        NeighborExchange neighborExchange(neighborPeerSet());
+
+        SeedList nextSeedList;
+        for (;; ++borderDistance) {
+            // communicate the non-neigbor overlap indices
+            addNonNeighborOverlapIndices_(A, neighborExchange, seedList, borderDistance);
+
+            // add all processes in the seed rows of the current overlap level
+            for (const auto& seed : seedList) {
+                Index localIdx = nativeToLocal(seed.index);
+                if (localIdx < 0)
+                    continue;
+
+                auto& indexOverlap = foreignOverlapByLocalIndex_[static_cast<unsigned>(localIdx)];
+                if (indexOverlap.count(seed.peerRank) == 0)
+                    indexOverlap[seed.peerRank] = borderDistance;
+            }
+
+            // if we have reached the maximum overlap distance, we're
+            // finished
+            if (borderDistance >= overlapSize)
+                return;
+
+            // find the seed list for the next overlap level using the
+            // seed set for the current level
+            findNextSeeds_(A, seedList, nextSeedList);
+            seedList.swap(nextSeedList);
+            nextSeedList.clear();
         }
+    }
 
-        // if we have reached the maximum overlap distance, i.e. we're
-        // finished and break the recursion
-        if (borderDistance >= overlapSize)
-            return;
+    // find all column indices of the seed rows which are not yet in the overlap
+    // of the seed's peer process. The rows are processed by all threads, but the
+    // result is identical to the one of a sequential run.
+    template <class BCRSMatrix>
+    void findNextSeeds_(const BCRSMatrix& A,
+                        const SeedList& seedList,
+                        SeedList& nextSeedList) const
+    {
+        const size_t numSeeds = seedList.size();
+#ifdef _OPENMP
+        const int numThreads = omp_get_max_threads();
+#else
+        const int numThreads = 1;
+#endif
+        std::vector<SeedList> threadSeeds(static_cast<size_t>(numThreads));
 
-        // find the seed list for the next overlap level using the
-        // seed set for the current level
-        SeedList nextSeedList;
-        seedIt = seedList.begin();
-        for (; seedIt != seedEndIt; ++seedIt) {
-            Index nativeRowIdx = seedIt->index;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) num_threads(numThreads) if(numSeeds > 1024)
+#endif
+        for (size_t seedIdx = 0; seedIdx < numSeeds; ++seedIdx) {
+            const auto& seed = seedList[seedIdx];
+            Index nativeRowIdx = seed.index;
             if (nativeToLocal(nativeRowIdx) < 0)
                 continue; // ignore blacklisted indices
-            ProcessRank peerRank = seedIt->peerRank;
+
+#ifdef _OPENMP
+            auto& newSeeds = threadSeeds[static_cast<size_t>(omp_get_thread_num())];
+#else
+            auto& newSeeds = threadSeeds[0];
+#endif
 
             // find all column indices in the row. The indices of the
             // columns are the additional indices of the overlap which
             // we would like to add
-            using ColIterator = typename BCRSMatrix::ConstColIterator;
-            ColIterator colIt = A[static_cast<unsigned>(nativeRowIdx)].begin();
-            ColIterator colEndIt = A[static_cast<unsigned>(nativeRowIdx)].end();
-            for (; colIt != colEndIt; ++colIt) {
+            const auto& row = A[static_cast<unsigned>(nativeRowIdx)];
+            for (auto colIt = row.begin(); colIt != row.end(); ++colIt) {
                 Index nativeColIdx = static_cast<Index>(colIt.index());
                 Index localColIdx = nativeToLocal(nativeColIdx);
 
@@ -397,37 +451,24 @@ protected:
                     continue;
                 // if the process is already is in the overlap of the
                 // column index, ignore this column index!
-                else if (foreignOverlapByLocalIndex_[static_cast<unsigned>(localColIdx)].count(peerRank) > 0)
+                else if (foreignOverlapByLocalIndex_[static_cast<unsigned>(localColIdx)].count(seed.peerRank) > 0)
                     continue;
 
-                // check whether the new index is already in the overlap
-                bool hasIndex = false;
-                typename SeedList::iterator sIt = nextSeedList.begin();
-                typename SeedList::iterator sEndIt = nextSeedList.end();
-                for (; sIt != sEndIt; ++sIt) {
-                    if (sIt->index == nativeColIdx && sIt->peerRank == peerRank) {
-                        hasIndex = true;
-                        break;
-                    }
-                }
-                if (hasIndex)
-                    continue; // we already have this index
-
                 // add the current processes to the seed list for the
                 // next overlap level
                 IndexRankDist newTuple;
                 newTuple.index = nativeColIdx;
-                newTuple.peerRank = peerRank;
-                newTuple.borderDistance = seedIt->borderDistance + 1;
-                nextSeedList.push_back(newTuple);
+                newTuple.peerRank = seed.peerRank;
+                newTuple.borderDistance = seed.borderDistance + 1;
+                newSeeds.push_back(newTuple);
             }
         }
 
-        // clear the old seed list to save some memory
-        seedList.clear();
-
-        // Perform the same excercise for the next overlap distance
-        extendForeignOverlap_(A, nextSeedList, borderDistance + 1, overlapSize);
+        // with the static schedule, each thread handles a contiguous range of
+        // seeds, so concatenating the per-thread lists preserves their order
+        for (const auto& newSeeds : threadSeeds)
+            nextSeedList.insert(nextSeedList.end(), newSeeds.begin(), newSeeds.end());
+        nextSeedList.removeDuplicates();
     }
 
     // Computes the local <-> native index maps
@@ -453,139 +494,96 @@ protected:
 
     Index localToPeerIdx_(Index localIdx, ProcessRank peerRank) const
     {
-        auto it = borderList_.begin();
-        const auto& endIt = borderList_.end();
-        for (; it != endIt; ++it) {
-            if (it->localIdx == localIdx && it->peerRank == peerRank)
-                return it->peerIdx;
-        }
-
-        return -1;
+        BorderIndex key;
+        key.localIdx = localIdx;
+        key.peerRank = peerRank;
+        auto it = std::lower_bound(sortedBorderList_.begin(),
+                                   sortedBorderList_.end(),
+                                   key,
+                                   borderIndexLess_);
+        if (it == sortedBorderList_.end()
+            || it->localIdx != localIdx
+            || it->peerRank != peerRank)
+            return -1;
+
+        return it->peerIdx;
     }
 
+    static bool borderIndexLess_(const BorderIndex& a, const BorderIndex& b)
+    { return a.localIdx < b.localIdx || (a.localIdx == b.localIdx && a.peerRank < b.peerRank); }
+
     template <class BCRSMatrix>
     void addNonNeighborOverlapIndices_(const BCRSMatrix&,
+                                       [[maybe_unused]] const NeighborExchange& neighborExchange,
                                        [[maybe_unused]] SeedList& seedList,
                                        [[maybe_unused]] BorderDistance borderDist)
     {
         // TODO: this probably does not work! (the matrix A is unused, but it is needed
         // from a logical POV.)
 #if HAVE_MPI
-        // first, create the buffers which will contain the number of
-        // border indices relevant for a neighbor peer
-        std::map<ProcessRank, std::vector<BorderIndex> > borderIndices;
+        // create the lists of the border indices relevant for each neighbor
+        // peer. these are indexed by the position of the peer in the neighbor
+        // peer set.
+        const size_t numNeighbors = neighborExchange.numPeers();
+        std::vector<std::vector<BorderIndex> > sendBufs(numNeighbors);
+        std::vector<std::vector<BorderIndex> > recvBufs;
 
         // get all indices in the border which have borderDist as
         // their distance to the closest border of their local process
-        auto it = seedList.begin();
-        const auto& endIt = seedList.end();
-        for (; it != endIt; ++it) {
-            Index localIdx = nativeToLocal(it->index);
+        for (const auto& seed : seedList) {
+            Index localIdx = nativeToLocal(seed.index);
             if (!isBorder(localIdx))
                 continue;
             BorderIndex borderHandle;
             borderHandle.localIdx = localIdx;
-            borderHandle.peerRank = it->peerRank;
-            borderHandle.borderDistance = it->borderDistance;
+            borderHandle.peerRank = seed.peerRank;
+            borderHandle.borderDistance = seed.borderDistance;
 
             // add the border index to all the neighboring peers
-            auto neighborIt = foreignOverlapByLocalIndex_[static_cast<unsigned>(localIdx)].begin();
-            const auto& neighborEndIt = foreignOverlapByLocalIndex_[static_cast<unsigned>(localIdx)].end();
-            for (; neighborIt != neighborEndIt; ++neighborIt) {
-                if (neighborIt->second != 0)
+            for (const auto& [neighborRank, neighborDist] :
+                     foreignOverlapByLocalIndex_[static_cast<unsigned>(localIdx)])
+            {
+                if (neighborDist != 0)
                     // not a border index for the neighbor
                     continue;
-                else if (neighborIt->first == borderHandle.peerRank)
+                else if (neighborRank == borderHandle.peerRank)
                     // don't communicate the indices which are owned
                     // by the peer to itself
                     continue;
 
-                Index peerIdx = localToPeerIdx_(localIdx, neighborIt->first);
+                Index peerIdx = localToPeerIdx_(localIdx, neighborRank);
                 if (peerIdx < 0)
                     // the index is on the border, but is not on the border
                     // with the considered neighboring process. Ignore it!
                     continue;
                 borderHandle.peerIdx = peerIdx;
-                borderIndices[neighborIt->first].push_back(borderHandle);
-            }
-        }
 
-        // now borderIndices contains the lists of indices which we
-        // would like to send to each neighbor. Let's create the MPI
-        // buffers.
-        std::map<ProcessRank, Opm::MpiBuffer<unsigned> > numIndicesSendBufs;
-        std::map<ProcessRank, Opm::MpiBuffer<BorderIndex> > indicesSendBufs;
-        auto peerIt = neighborPeerSet().begin();
-        const auto& peerEndIt = neighborPeerSet().end();
-        for (; peerIt != peerEndIt; ++peerIt) {
-            ProcessRank peerRank = *peerIt;
-            size_t numIndices = borderIndices[peerRank].size();
-            numIndicesSendBufs[peerRank].resize(1);
-            numIndicesSendBufs[peerRank][0] = static_cast<unsigned>(numIndices);
-
-            const auto& peerBorderIndices = borderIndices[peerRank];
-            indicesSendBufs[peerRank].resize(numIndices);
-
-            auto tmpIt = peerBorderIndices.begin();
-            const auto& tmpEndIt = peerBorderIndices.end();
-            size_t i = 0;
-            for (; tmpIt != tmpEndIt; ++tmpIt, ++i) {
-                indicesSendBufs[peerRank][i] = *tmpIt;
+                auto peerIt = neighborPeerSet().find(neighborRank);
+                assert(peerIt != neighborPeerSet().end());
+                sendBufs[static_cast<size_t>(peerIt - neighborPeerSet().begin())].push_back(borderHandle);
             }
         }
 
-        // now, send all these nice buffers to our neighbors
-        peerIt = neighborPeerSet().begin();
-        for (; peerIt != peerEndIt; ++peerIt) {
-            ProcessRank neighborPeer = *peerIt;
-            numIndicesSendBufs[neighborPeer].send(neighborPeer);
-            indicesSendBufs[neighborPeer].send(neighborPeer);
-        }
+        // exchange the border indices with all neighbors at once
+        neighborExchange.exchange(sendBufs, recvBufs);
 
-        // receive all data from the neighbors
-        std::map<ProcessRank, MpiBuffer<unsigned> > numIndicesRcvBufs;
-        std::map<ProcessRank, MpiBuffer<BorderIndex> > indicesRcvBufs;
-        peerIt = neighborPeerSet().begin();
-        for (; peerIt != peerEndIt; ++peerIt) {
-            ProcessRank neighborPeer = *peerIt;
-            auto& numIndicesRcvBuf = numIndicesRcvBufs[neighborPeer];
-            auto& indicesRcvBuf = indicesRcvBufs[neighborPeer];
-
-            numIndicesRcvBuf.resize(1);
-            numIndicesRcvBuf.receive(neighborPeer);
-            unsigned numIndices = numIndicesRcvBufs[neighborPeer][0];
-            indicesRcvBuf.resize(numIndices);
-            indicesRcvBuf.receive(neighborPeer);
-
-            // filter out all indices which are already in the peer
-            // processes' overlap and add them to the seed list. also
-            // extend the set of peer processes.
-            for (unsigned i = 0; i < numIndices; ++i) {
+        // filter out all indices which are already in the peer processes'
+        // overlap and add them to the seed list. also extend the set of peer
+        // processes.
+        const size_t oldSeedListSize = seedList.size();
+        for (auto& recvBuf : recvBufs) {
+            for (auto& borderIdx : recvBuf) {
                 // swap the local and the peer indices, because they were
                 // created with the point view of the sender
-                std::swap(indicesRcvBuf[i].localIdx, indicesRcvBuf[i].peerIdx);
+                std::swap(borderIdx.localIdx, borderIdx.peerIdx);
 
-                ProcessRank peerRank = indicesRcvBuf[i].peerRank;
-                // Index peerIdx = indicesRcvBuf[i].peerIdx;
-                Index localIdx = indicesRcvBuf[i].localIdx;
+                ProcessRank peerRank = borderIdx.peerRank;
+                Index localIdx = borderIdx.localIdx;
 
                 // check if the index is already in the overlap for
                 // the peer
-                const auto& distIt = foreignOverlapByLocalIndex_[static_cast<unsigned>(localIdx)].find(peerRank);
-                if (distIt != foreignOverlapByLocalIndex_[static_cast<unsigned>(localIdx)].end())
-                    continue;
-
-                // make sure the index is not already in the seed list
-                bool inSeedList = false;
-                auto seedIt = seedList.begin();
-                const auto& seedEndIt = seedList.end();
-                for (; seedIt != seedEndIt; ++seedIt) {
-                    if (seedIt->index == localIdx && seedIt->peerRank == peerRank) {
-                        inSeedList = true;
-                        break;
-                    }
-                }
-                if (inSeedList)
+                const auto& indexOverlap = foreignOverlapByLocalIndex_[static_cast<unsigned>(localIdx)];
+                if (indexOverlap.find(peerRank) != indexOverlap.end())
                     continue;
 
                 IndexRankDist seedEntry;
@@ -599,13 +597,9 @@ protected:
             }
         }
 
-        // make sure all data was send
-        peerIt = neighborPeerSet().begin();
-        for (; peerIt != peerEndIt; ++peerIt) {
-            ProcessRank neighborPeer = *peerIt;
-            numIndicesSendBufs[neighborPeer].wait();
-            indicesSendBufs[neighborPeer].wait();
-        }
+        // make sure that the received indices are not already in the seed list
+        if (seedList.size() > oldSeedListSize)
+            seedList.removeDuplicates();
 #endif // HAVE_MPI
     }
 
@@ -616,6 +610,9 @@ protected:
     {
         // determine the minimum rank for all indices
         masterRank_.resize(numLocal_);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
         for (unsigned localIdx = 0; localIdx < numLocal_; ++localIdx) {
             unsigned masterRank = myRank_;
             if (isBorder(static_cast<Index>(localIdx))) {
@@ -679,9 +676,12 @@ protected:
     // index
     std::vector<ProcessRank> masterRank_;
 
-    // set of all local indices which are on the border of some remote
-    // process
-    std::set<Index> localBorderIndices_;
+    // flags which indicate whether a local index is on the border of
+    // some remote process
+    std::vector<unsigned char> isLocalBorderIndex_;
+
+    // the border list sorted by the local index and the peer rank
+    std::vector<BorderIndex> sortedBorderList_;
 
     // stores the set of process ranks which are in the overlap for a
     // given row index "owned" by the current rank. The second value
@@ -33,10 +33,11 @@
 #include <dune/istl/operators.hh>
 
 #include <algorithm>
-#include <set>
-#include <map>
+#include <cassert>
 #include <iostream>
 #include <tuple>
+#include <utility>
+#include <vector>
 
 #if HAVE_MPI
 #include <mpi.h>
@@ -50,14 +51,22 @@ namespace Linear {
  * \brief This class maps domestic row indices to and from "global"
  *        indices which is used to construct an algebraic overlap
  *        for the parallel linear solvers.
+ *
+ * Domestic indices are consecutive, so the domestic to global mapping is
+ * a plain array. The reverse mapping is stored as an array of (global
+ * index, domestic index) pairs sorted by the global index. Since indices
+ * are added while the overlap is constructed, new pairs are first put into
+ * a small sorted array which gets merged into the main one once it becomes
+ * too large.
  */
 template <class ForeignOverlap>
 class GlobalIndices
 {
     GlobalIndices(const GlobalIndices& ) = delete;
 
-    using GlobalToDomesticMap = std::map<Index, Index>;
-    using DomesticToGlobalMap = std::map<Index, Index>;
+    using IndexPair = std::pair<Index, Index>;
+    using GlobalToDomesticMap = std::vector<IndexPair>;
+    using DomesticToGlobalMap = std::vector<Index>;
 
 public:
     GlobalIndices(const ForeignOverlap& foreignOverlap)
@@ -87,22 +96,25 @@ public:
      */
     Index domesticToGlobal(Index domesticIdx) const
     {
-        assert(domesticToGlobal_.find(domesticIdx) != domesticToGlobal_.end());
+        assert(0 <= domesticIdx
+               && static_cast<size_t>(domesticIdx) < domesticToGlobal_.size());
+        assert(domesticToGlobal_[static_cast<size_t>(domesticIdx)] >= 0);
 
-        return domesticToGlobal_.find(domesticIdx)->second;
+        return domesticToGlobal_[static_cast<size_t>(domesticIdx)];
     }
 
     /*!
      * \brief Converts a global index to a domestic one.
+     *
+     * Returns -1 if the global index is not known to the current process.
      */
     Index globalToDomestic(Index globalIdx) const
     {
-        const auto& tmp = globalToDomestic_.find(globalIdx);
-
-        if (tmp == globalToDomestic_.end())
-            return -1;
+        Index domesticIdx = lookup_(globalToDomestic_, globalIdx);
+        if (domesticIdx < 0)
+            domesticIdx = lookup_(recentGlobalToDomestic_, globalIdx);
 
-        return tmp->second;
+        return domesticIdx;
     }
 
     /*!
@@ -126,11 +138,19 @@ public:
      */
     void addIndex(Index domesticIdx, Index globalIdx)
     {
-        domesticToGlobal_[domesticIdx] = globalIdx;
-        globalToDomestic_[globalIdx] = domesticIdx;
-        numDomestic_ = domesticToGlobal_.size();
-
-        assert(domesticToGlobal_.size() == globalToDomestic_.size());
+        assert(domesticIdx >= 0);
+        assert(globalIdx >= 0);
+
+        size_t domIdx = static_cast<size_t>(domesticIdx);
+        if (domIdx >= domesticToGlobal_.size())
+            domesticToGlobal_.resize(domIdx + 1, /*value=*/-1);
+        else if (domesticToGlobal_[domIdx] >= 0)
+            numMapped_ -= 1; // the old mapping gets replaced
+
+        domesticToGlobal_[domIdx] = globalIdx;
+        insertGlobalToDomestic_(globalIdx, domesticIdx);
+        ++numMapped_;
+        numDomestic_ = numMapped_;
     }
 
     /*!
@@ -181,7 +201,7 @@ public:
      * \brief Return true iff a given global index already exists
      */
     bool hasGlobalIndex(Index globalIdx) const
-    { return globalToDomestic_.find(globalIdx) != globalToDomestic_.end(); }
+    { return globalToDomestic(globalIdx) >= 0; }
 
     /*!
      * \brief Prints the global indices of all domestic indices
@@ -199,6 +219,65 @@ public:
     }
 
 protected:
+    static Index lookup_(const GlobalToDomesticMap& map, Index globalIdx)
+    {
+        auto it = std::lower_bound(map.begin(), map.end(), globalIdx,
+                                   [](const IndexPair& a, Index b)
+                                   { return a.first < b; });
+        if (it == map.end() || it->first != globalIdx)
+            return -1;
+
+        return it->second;
+    }
+
+    static bool assign_(GlobalToDomesticMap& map, Index globalIdx, Index domesticIdx)
+    {
+        auto it = std::lower_bound(map.begin(), map.end(), globalIdx,
+                                   [](const IndexPair& a, Index b)
+                                   { return a.first < b; });
+        if (it == map.end() || it->first != globalIdx)
+            return false;
+
+        it->second = domesticIdx;
+        return true;
+    }
+
+    void insertGlobalToDomestic_(Index globalIdx, Index domesticIdx)
+    {
+        if (assign_(globalToDomestic_, globalIdx, domesticIdx)
+            || assign_(recentGlobalToDomestic_, globalIdx, domesticIdx))
+            return;
+
+        // appending to the main array is cheap if the global indices are
+        // added in ascending order, which is the case for the master indices
+        if (recentGlobalToDomestic_.empty()
+            && (globalToDomestic_.empty() || globalToDomestic_.back().first < globalIdx))
+        {
+            globalToDomestic_.emplace_back(globalIdx, domesticIdx);
+            return;
+        }
+
+        auto it = std::lower_bound(recentGlobalToDomestic_.begin(),
+                                   recentGlobalToDomestic_.end(),
+                                   globalIdx,
+                                   [](const IndexPair& a, Index b)
+                                   { return a.first < b; });
+        recentGlobalToDomestic_.emplace(it, globalIdx, domesticIdx);
+
+        // merge the recently added indices into the main array if there are too
+        // many of them. this keeps insertion amortized logarithmic.
+        if (recentGlobalToDomestic_.size() > std::max<size_t>(256, globalToDomestic_.size()/16)) {
+            size_t oldSize = globalToDomestic_.size();
+            globalToDomestic_.insert(globalToDomestic_.end(),
+                                     recentGlobalToDomestic_.begin(),
+                                     recentGlobalToDomestic_.end());
+            std::inplace_merge(globalToDomestic_.begin(),
+                               globalToDomestic_.begin() + static_cast<std::ptrdiff_t>(oldSize),
+                               globalToDomestic_.end());
+            recentGlobalToDomestic_.clear();
+        }
+    }
+
     // retrieve the offset for the indices where we are master in the
     // global index list
     void buildGlobalIndices_()
@@ -339,7 +418,9 @@ protected:
     size_t numDomestic_;
     const ForeignOverlap& foreignOverlap_;
 
+    size_t numMapped_{0};
     GlobalToDomesticMap globalToDomestic_;
+    GlobalToDomesticMap recentGlobalToDomestic_;
     DomesticToGlobalMap domesticToGlobal_;
 };
 
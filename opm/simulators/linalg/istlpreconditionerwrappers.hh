@@ -40,18 +40,33 @@
  * - \c SOR: A successive overrelaxation (SOR) preconditioner
  * - \c ILUn: An ILU(n) preconditioner
  * - \c ILU0: A specialized (and optimized) ILU(0) preconditioner
+ * - \c BlockILU0: A block ILU(0) preconditioner with multi-threaded triangular solves
+ * - \c DILU: A block DILU preconditioner with multi-threaded triangular solves
+ * - \c CPR: A two-stage constrained pressure residual preconditioner using AMG for
+ *          the pressure system and block ILU(0) for the full system
+ * - \c Runtime: Select one of ILUn, BlockILU0, DILU and CPR using the
+ *              PreconditionerType parameter
  */
 #ifndef EWOMS_ISTL_PRECONDITIONER_WRAPPERS_HH
 #define EWOMS_ISTL_PRECONDITIONER_WRAPPERS_HH
 
+#include <opm/models/common/multiphasebaseproperties.hh>
 #include <opm/models/utils/propertysystem.hh>
 #include <opm/models/utils/parametersystem.hh>
+#include <opm/simulators/linalg/blockilu0.hh>
+#include <opm/simulators/linalg/cprpreconditioner.hh>
+#include <opm/simulators/linalg/cprpressurevaridx.hh>
 #include <opm/simulators/linalg/linalgproperties.hh>
 #include <opm/simulators/linalg/ilufirstelement.hh> //definitions needed in next header
 #include <dune/istl/preconditioners.hh>
 
 #include <dune/common/version.hh>
 
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
 namespace Opm {
 namespace Linear {
 #define EWOMS_WRAP_ISTL_PRECONDITIONER(PREC_NAME, ISTL_PREC_TYPE)               \
@@ -184,7 +199,181 @@ private:
     SequentialPreconditioner *seqPreCond_;
 };
 
+// the block ILU(0) and DILU preconditioners use multiple threads for the
+// factorization and for the triangular solves if OpenMP is available.
+#define EWOMS_WRAP_BLOCK_ILU_PRECONDITIONER(PREC_NAME, DIAGONAL_ONLY)           \
+    template <class TypeTag>                                                    \
+    class PreconditionerWrapper##PREC_NAME                                      \
+    {                                                                           \
+        using Scalar = GetPropType<TypeTag, Properties::Scalar>;                 \
+        using OverlappingMatrix = GetPropType<TypeTag, Properties::OverlappingMatrix>; \
+        using OverlappingVector = GetPropType<TypeTag, Properties::OverlappingVector>; \
+                                                                                \
+    public:                                                                     \
+        using SequentialPreconditioner = BlockIlu0<OverlappingMatrix,           \
+                                                   OverlappingVector,           \
+                                                   OverlappingVector>;          \
+        PreconditionerWrapper##PREC_NAME()                                      \
+        {}                                                                      \
+                                                                                \
+        static void registerParameters()                                        \
+        {                                                                       \
+            Parameters::registerParam<TypeTag, Properties::PreconditionerRelaxation> \
+                ("The relaxation factor of the preconditioner");                \
+        }                                                                       \
+                                                                                \
+        void prepare(OverlappingMatrix& matrix)                                 \
+        {                                                                       \
+            Scalar relaxationFactor =                                           \
+            Parameters::get<TypeTag, Properties::PreconditionerRelaxation>();   \
+            seqPreCond_ = new SequentialPreconditioner(matrix,                  \
+                                                       relaxationFactor,        \
+                                                       DIAGONAL_ONLY);          \
+        }                                                                       \
+                                                                                \
+        SequentialPreconditioner& get()                                         \
+        { return *seqPreCond_; }                                                \
+                                                                                \
+        void cleanup()                                                          \
+        { delete seqPreCond_; }                                                 \
+                                                                                \
+    private:                                                                    \
+        SequentialPreconditioner *seqPreCond_;                                  \
+    };
+
+EWOMS_WRAP_BLOCK_ILU_PRECONDITIONER(BlockILU0, /*diagonalOnly=*/false)
+EWOMS_WRAP_BLOCK_ILU_PRECONDITIONER(DILU, /*diagonalOnly=*/true)
+
+template <class TypeTag>
+class PreconditionerWrapperCPR
+{
+    using Scalar = GetPropType<TypeTag, Properties::Scalar>;
+    using Indices = GetPropType<TypeTag, Properties::Indices>;
+    using OverlappingMatrix = GetPropType<TypeTag, Properties::OverlappingMatrix>;
+    using OverlappingVector = GetPropType<TypeTag, Properties::OverlappingVector>;
+
+public:
+    using SequentialPreconditioner = CprPreconditioner<OverlappingMatrix,
+                                                       OverlappingVector,
+                                                       OverlappingVector>;
+    PreconditionerWrapperCPR()
+    {}
+
+    static void registerParameters()
+    {
+        Parameters::registerParam<TypeTag, Properties::PreconditionerRelaxation>
+            ("The relaxation factor of the preconditioner");
+        Parameters::registerParam<TypeTag, Properties::AmgCoarsenTarget>
+            ("The coarsening target for the agglomerations of "
+             "the AMG preconditioner");
+        Parameters::registerParam<TypeTag, Properties::CprWeights>
+            ("The weights used by the CPR preconditioner to form the pressure "
+             "equation. Possible values: 'quasiimpes', 'unit'");
+    }
+
+    void prepare(OverlappingMatrix& matrix)
+    {
+        Scalar relaxationFactor = Parameters::get<TypeTag, Properties::PreconditionerRelaxation>();
+        int coarsenTarget = Parameters::get<TypeTag, Properties::AmgCoarsenTarget>();
+        const std::string weightsName = Parameters::get<TypeTag, Properties::CprWeights>();
+
+        using Weights = typename SequentialPreconditioner::Weights;
+        Weights weights;
+        if (weightsName == "quasiimpes")
+            weights = Weights::QuasiImpes;
+        else if (weightsName == "unit")
+            weights = Weights::Unit;
+        else
+            throw std::invalid_argument("Unknown CPR weights '" + weightsName + "'");
+
+        seqPreCond_ = new SequentialPreconditioner(matrix,
+                                                   detail::CprPressureVarIdx<Indices>::value,
+                                                   weights,
+                                                   coarsenTarget,
+                                                   relaxationFactor);
+    }
+
+    SequentialPreconditioner& get()
+    { return *seqPreCond_; }
+
+    void cleanup()
+    { delete seqPreCond_; }
+
+private:
+    SequentialPreconditioner *seqPreCond_;
+};
+
+// selects the preconditioner at run time using the PreconditionerType parameter. Since
+// the linear solver calls the preconditioner via virtual functions, this is slightly
+// slower than specifying the preconditioner at compile time.
+template <class TypeTag>
+class PreconditionerWrapperRuntime
+{
+    using OverlappingMatrix = GetPropType<TypeTag, Properties::OverlappingMatrix>;
+    using OverlappingVector = GetPropType<TypeTag, Properties::OverlappingVector>;
+
+public:
+    using SequentialPreconditioner = Dune::Preconditioner<OverlappingVector, OverlappingVector>;
+
+    PreconditionerWrapperRuntime()
+        : type_(Parameters::get<TypeTag, Properties::PreconditionerType>())
+    {
+        if (type_ != "ilu" && type_ != "blockilu0" && type_ != "dilu" && type_ != "cpr")
+            throw std::invalid_argument("Unknown preconditioner type '" + type_ + "'");
+    }
+
+    static void registerParameters()
+    {
+        Parameters::registerParam<TypeTag, Properties::PreconditionerType>
+            ("The preconditioner of the linear solver. Possible values: 'ilu', "
+             "'blockilu0', 'dilu', 'cpr'");
+
+        PreconditionerWrapperILU<TypeTag>::registerParameters();
+        PreconditionerWrapperBlockILU0<TypeTag>::registerParameters();
+        PreconditionerWrapperDILU<TypeTag>::registerParameters();
+        PreconditionerWrapperCPR<TypeTag>::registerParameters();
+    }
+
+    void prepare(OverlappingMatrix& matrix)
+    {
+        if (type_ == "ilu")
+            prepare_(iluWrapper_, matrix);
+        else if (type_ == "blockilu0")
+            prepare_(blockIluWrapper_, matrix);
+        else if (type_ == "dilu")
+            prepare_(diluWrapper_, matrix);
+        else
+            prepare_(cprWrapper_, matrix);
+    }
+
+    SequentialPreconditioner& get()
+    { return *seqPreCond_; }
+
+    void cleanup()
+    { cleanupFn_(); }
+
+private:
+    template <class Wrapper>
+    void prepare_(Wrapper& wrapper, OverlappingMatrix& matrix)
+    {
+        wrapper.prepare(matrix);
+        seqPreCond_ = &wrapper.get();
+        cleanupFn_ = [&wrapper]() { wrapper.cleanup(); };
+    }
+
+    std::string type_;
+
+    PreconditionerWrapperILU<TypeTag> iluWrapper_;
+    PreconditionerWrapperBlockILU0<TypeTag> blockIluWrapper_;
+    PreconditionerWrapperDILU<TypeTag> diluWrapper_;
+    PreconditionerWrapperCPR<TypeTag> cprWrapper_;
+
+    SequentialPreconditioner *seqPreCond_;
+    std::function<void()> cleanupFn_;
+};
+
 #undef EWOMS_WRAP_ISTL_PRECONDITIONER
+#undef EWOMS_WRAP_BLOCK_ILU_PRECONDITIONER
 }} // namespace Linear, Opm
 
 #endif
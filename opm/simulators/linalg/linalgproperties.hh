@@ -46,6 +46,15 @@ struct PreconditionerWrapper { using type = UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
 struct LinearSolverScalar { using type = UndefinedProperty; };
 
+/*!
+ * \brief The maximum number of iterative refinement steps of a mixed-precision solve.
+ *
+ * This is only used if the linear solver operates on a different floating point type
+ * than the linearization, i.e., if LinearSolverScalar is not the same as Scalar.
+ */
+template<class TypeTag, class MyTypeTag>
+struct LinearSolverMaxRefinementSteps { using type = UndefinedProperty; };
+
 /*!
  * \brief The size of the algebraic overlap of the linear solver.
  *
@@ -90,6 +99,10 @@ struct PreconditionerOrder { using type = UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
 struct PreconditionerRelaxation { using type = UndefinedProperty; };
 
+//! The preconditioner selected at run time by PreconditionerWrapperRuntime
+template<class TypeTag, class MyTypeTag>
+struct PreconditionerType { using type = UndefinedProperty; };
+
 //! number of iterations between solver restarts for the GMRES solver
 template<class TypeTag, class MyTypeTag>
 struct GMResRestart { using type = UndefinedProperty; };
@@ -104,6 +117,12 @@ struct GlobalEqVector { using type = UndefinedProperty; };
 
 template<class TypeTag, class MyTypeTag>
 struct AmgCoarsenTarget { using type = UndefinedProperty; };
+
+//! The weights used by the CPR preconditioner to form the pressure equation
+//! ("quasiimpes" or "unit")
+template<class TypeTag, class MyTypeTag>
+struct CprWeights { using type = UndefinedProperty; };
+
 template<class TypeTag, class MyTypeTag>
 struct LinearSolverMaxError { using type = UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
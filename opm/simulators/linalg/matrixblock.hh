@@ -33,6 +33,7 @@
 
 #include <opm/common/Exceptions.hpp>
 
+#include <cmath>
 #include <limits>
 
 namespace Opm {
@@ -51,18 +52,70 @@ static inline void invertMatrix(Dune::FieldMatrix<K,1,1>& matrix)
     Dune::FMatrixHelp::invertMatrix(tmp,matrix);
 }
 
+//! invert 2x2 Matrix without changing the original matrix
+template <template<class K> class Matrix, typename K>
+static inline K invertMatrix2(const Matrix<K>& matrix, Matrix<K>& inverse)
+{
+    K det = matrix[0][0] * matrix[1][1] - matrix[0][1] * matrix[1][0];
+
+    if (std::abs(det) < 1e-40) {
+        inverse = std::numeric_limits<K>::quiet_NaN();
+        throw NumericalProblem("Singular matrix");
+    }
+
+    K detInv = 1.0 / det;
+    inverse[0][0] = matrix[1][1] * detInv;
+    inverse[0][1] = -matrix[0][1] * detInv;
+    inverse[1][0] = -matrix[1][0] * detInv;
+    inverse[1][1] = matrix[0][0] * detInv;
+
+    return det;
+}
+
+//! invert 3x3 Matrix without changing the original matrix
+template <template<class K> class Matrix, typename K>
+static inline K invertMatrix3(const Matrix<K>& matrix, Matrix<K>& inverse)
+{
+    inverse[0][0] = matrix[1][1] * matrix[2][2] - matrix[1][2] * matrix[2][1];
+    inverse[1][0] = matrix[1][2] * matrix[2][0] - matrix[1][0] * matrix[2][2];
+    inverse[2][0] = matrix[1][0] * matrix[2][1] - matrix[1][1] * matrix[2][0];
+
+    K det = matrix[0][0] * inverse[0][0] + matrix[0][1] * inverse[1][0] +
+            matrix[0][2] * inverse[2][0];
+
+    if (std::abs(det) < 1e-40) {
+        inverse = std::numeric_limits<K>::quiet_NaN();
+        throw NumericalProblem("Singular matrix");
+    }
+
+    inverse[0][1] = matrix[0][2] * matrix[2][1] - matrix[0][1] * matrix[2][2];
+    inverse[1][1] = matrix[0][0] * matrix[2][2] - matrix[0][2] * matrix[2][0];
+    inverse[2][1] = matrix[0][1] * matrix[2][0] - matrix[0][0] * matrix[2][1];
+
+    inverse[0][2] = matrix[0][1] * matrix[1][2] - matrix[0][2] * matrix[1][1];
+    inverse[1][2] = matrix[0][2] * matrix[1][0] - matrix[0][0] * matrix[1][2];
+    inverse[2][2] = matrix[0][0] * matrix[1][1] - matrix[0][1] * matrix[1][0];
+
+    inverse *= 1.0 / det;
+
+    return det;
+}
+
+template<class K> using FMat2 = Dune::FieldMatrix<K,2,2>;
+template<class K> using FMat3 = Dune::FieldMatrix<K,3,3>;
+
 template <typename K>
 static inline void invertMatrix(Dune::FieldMatrix<K,2,2>& matrix)
 {
-    Dune::FieldMatrix<K,2,2> tmp(matrix);
-    Dune::FMatrixHelp::invertMatrix(tmp,matrix);
+    FMat2<K> tmp(matrix);
+    invertMatrix2<FMat2>(tmp, matrix);
 }
 
 template <typename K>
 static inline void invertMatrix(Dune::FieldMatrix<K,3,3>& matrix)
 {
-    Dune::FieldMatrix<K,3,3> tmp(matrix);
-    Dune::FMatrixHelp::invertMatrix(tmp,matrix);
+    FMat3<K> tmp(matrix);
+    invertMatrix3<FMat3>(tmp, matrix);
 }
 
 //! invert 4x4 Matrix without changing the original matrix
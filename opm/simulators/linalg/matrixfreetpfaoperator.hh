@@ -0,0 +1,215 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::Linear::MatrixFreeTpfaOperator
+ */
+#ifndef EWOMS_MATRIX_FREE_TPFA_OPERATOR_HH
+#define EWOMS_MATRIX_FREE_TPFA_OPERATOR_HH
+
+#include <dune/istl/operators.hh>
+#include <dune/istl/solvercategory.hh>
+
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+namespace Opm {
+namespace Linear {
+
+/*!
+ * \ingroup Linear
+ *
+ * \brief A linear operator which applies the Jacobian of a two-point flux
+ *        discretization using the derivative blocks of the faces.
+ *
+ * Instead of a general sparse matrix, the operator stores one diagonal block per
+ * cell and one off-diagonal block per face of a cell. The faces of a cell are
+ * stored consecutively in the same order as the linearizer visits them, so a
+ * linearizer can write the derivatives of a face directly to their final
+ * location and applying the operator only streams over the faces. Other than
+ * for a BCRS matrix, neither the column index of the diagonal block nor a
+ * per-row indirection needs to be loaded.
+ *
+ * The off-diagonal block of the face k of row i, with neighbor(k) == j, is the
+ * derivative of the residual of cell i with regard to the primary variables of
+ * cell j.
+ */
+template <class MatrixBlock, class X, class Y = X>
+class MatrixFreeTpfaOperator : public Dune::LinearOperator<X, Y>
+{
+public:
+    using domain_type = X;
+    using range_type = Y;
+    using field_type = typename X::field_type;
+    using block_type = MatrixBlock;
+
+    /*!
+     * \brief Allocate the blocks of the operator.
+     *
+     * \param rowSizesBegin Iterator to the number of faces of the first row
+     * \param rowSizesEnd Iterator past the number of faces of the last row
+     */
+    template <class Iterator>
+    void reserve(Iterator rowSizesBegin, Iterator rowSizesEnd)
+    {
+        rowStart_.assign(1, 0);
+        for (Iterator it = rowSizesBegin; it != rowSizesEnd; ++it)
+            rowStart_.push_back(rowStart_.back() + static_cast<unsigned>(*it));
+
+        const std::size_t numRows = rowStart_.size() - 1;
+        diag_.assign(numRows, MatrixBlock(0.0));
+        offDiag_.assign(rowStart_.back(), MatrixBlock(0.0));
+        neighbor_.assign(rowStart_.back(), 0);
+    }
+
+    /*!
+     * \brief Returns the number of rows of the operator.
+     */
+    std::size_t numRows() const
+    { return diag_.size(); }
+
+    /*!
+     * \brief Returns the total number of faces, i.e., off-diagonal blocks.
+     */
+    std::size_t numFaces() const
+    { return offDiag_.size(); }
+
+    /*!
+     * \brief Returns the index of the first face of a row.
+     */
+    unsigned rowBegin(unsigned rowIdx) const
+    { return rowStart_[rowIdx]; }
+
+    /*!
+     * \brief Returns the index past the last face of a row.
+     */
+    unsigned rowEnd(unsigned rowIdx) const
+    { return rowStart_[rowIdx + 1]; }
+
+    /*!
+     * \brief Set the index of the cell on the other side of a face.
+     */
+    void setNeighbor(unsigned faceIdx, unsigned neighborIdx)
+    { neighbor_[faceIdx] = neighborIdx; }
+
+    /*!
+     * \brief Returns the index of the cell on the other side of a face.
+     */
+    unsigned neighbor(unsigned faceIdx) const
+    { return neighbor_[faceIdx]; }
+
+    /*!
+     * \brief Returns the diagonal block of a row.
+     */
+    MatrixBlock& diagonal(unsigned rowIdx)
+    { return diag_[rowIdx]; }
+
+    const MatrixBlock& diagonal(unsigned rowIdx) const
+    { return diag_[rowIdx]; }
+
+    /*!
+     * \brief Returns the off-diagonal block of a face.
+     */
+    MatrixBlock& offDiagonal(unsigned faceIdx)
+    { return offDiag_[faceIdx]; }
+
+    const MatrixBlock& offDiagonal(unsigned faceIdx) const
+    { return offDiag_[faceIdx]; }
+
+    /*!
+     * \brief Set all blocks to zero.
+     */
+    void clear()
+    {
+        const long numRows = static_cast<long>(diag_.size());
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (long rowIdx = 0; rowIdx < numRows; ++rowIdx)
+            clearRow(static_cast<unsigned>(rowIdx));
+    }
+
+    /*!
+     * \brief Set the diagonal block and the blocks of all faces of a row to zero.
+     */
+    void clearRow(unsigned rowIdx)
+    {
+        diag_[rowIdx] = 0.0;
+        for (unsigned faceIdx = rowStart_[rowIdx]; faceIdx < rowStart_[rowIdx + 1]; ++faceIdx)
+            offDiag_[faceIdx] = 0.0;
+    }
+
+    //! \copydoc Dune::LinearOperator::category()
+    Dune::SolverCategory::Category category() const override
+    { return Dune::SolverCategory::sequential; }
+
+    //! apply operator to x:  \f$ y = A(x) \f$
+    void apply(const X& x, Y& y) const override
+    {
+        assert(x.size() == numRows() && y.size() == numRows());
+
+        const long numRows = static_cast<long>(diag_.size());
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (long rowIdx = 0; rowIdx < numRows; ++rowIdx)
+            rowProduct_(static_cast<unsigned>(rowIdx), x, y[rowIdx]);
+    }
+
+    //! apply operator to x, scale and add:  \f$ y = y + \alpha A(x) \f$
+    void applyscaleadd(field_type alpha, const X& x, Y& y) const override
+    {
+        assert(x.size() == numRows() && y.size() == numRows());
+
+        const long numRows = static_cast<long>(diag_.size());
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (long rowIdx = 0; rowIdx < numRows; ++rowIdx) {
+            typename Y::block_type tmp;
+            rowProduct_(static_cast<unsigned>(rowIdx), x, tmp);
+            y[rowIdx].axpy(alpha, tmp);
+        }
+    }
+
+private:
+    template <class RangeBlock>
+    void rowProduct_(unsigned rowIdx, const X& x, RangeBlock& result) const
+    {
+        diag_[rowIdx].mv(x[rowIdx], result);
+        const unsigned end = rowStart_[rowIdx + 1];
+        for (unsigned faceIdx = rowStart_[rowIdx]; faceIdx < end; ++faceIdx)
+            offDiag_[faceIdx].umv(x[neighbor_[faceIdx]], result);
+    }
+
+    std::vector<unsigned> rowStart_{0};
+    std::vector<unsigned> neighbor_;
+    std::vector<MatrixBlock> diag_;
+    std::vector<MatrixBlock> offDiag_;
+};
+
+} // namespace Linear
+} // namespace Opm
+
+#endif
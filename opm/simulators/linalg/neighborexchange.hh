@@ -0,0 +1,202 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::Linear::NeighborExchange
+ */
+#ifndef EWOMS_NEIGHBOR_EXCHANGE_HH
+#define EWOMS_NEIGHBOR_EXCHANGE_HH
+
+#include "overlaptypes.hh"
+
+#if HAVE_MPI
+#include <mpi.h>
+#endif
+
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace Opm {
+namespace Linear {
+
+/*!
+ * \brief Exchanges arrays of trivially copyable objects with a fixed set of
+ *        peer processes in a single collective operation.
+ *
+ * The peer set must be symmetric, i.e., if rank A considers rank B to be its
+ * peer, B must also consider A as one of its peers. The send and receive
+ * buffers are indexed by the position of the peer rank within the peer set.
+ *
+ * If the MPI implementation supports MPI-3, a distributed graph communicator
+ * is created and MPI_Neighbor_alltoall[v] is used for the exchange. Else the
+ * data is exchanged using non-blocking point-to-point messages.
+ */
+class NeighborExchange
+{
+public:
+    explicit NeighborExchange([[maybe_unused]] const PeerSet& peerSet)
+        : peers_(peerSet.begin(), peerSet.end())
+    {
+#if HAVE_MPI && MPI_VERSION >= 3
+        std::vector<int> ranks(peers_.begin(), peers_.end());
+        MPI_Dist_graph_create_adjacent(MPI_COMM_WORLD,
+                                       static_cast<int>(ranks.size()),
+                                       ranks.data(),
+                                       MPI_UNWEIGHTED,
+                                       static_cast<int>(ranks.size()),
+                                       ranks.data(),
+                                       MPI_UNWEIGHTED,
+                                       MPI_INFO_NULL,
+                                       /*reorder=*/0,
+                                       &graphComm_);
+#endif
+    }
+
+    NeighborExchange(const NeighborExchange&) = delete;
+    NeighborExchange& operator=(const NeighborExchange&) = delete;
+
+    ~NeighborExchange()
+    {
+#if HAVE_MPI && MPI_VERSION >= 3
+        MPI_Comm_free(&graphComm_);
+#endif
+    }
+
+    /*!
+     * \brief Returns the number of peer processes.
+     */
+    size_t numPeers() const
+    { return peers_.size(); }
+
+    /*!
+     * \brief Returns the rank of the i-th peer process.
+     */
+    ProcessRank peer(size_t i) const
+    { return peers_[i]; }
+
+    /*!
+     * \brief Send sendBufs[i] to the i-th peer and receive the data sent by the
+     *        i-th peer into recvBufs[i].
+     */
+    template <class T>
+    void exchange(const std::vector<std::vector<T> >& sendBufs,
+                  std::vector<std::vector<T> >& recvBufs) const
+    {
+        static_assert(std::is_trivially_copyable<T>::value,
+                      "Only trivially copyable objects can be exchanged");
+
+        assert(sendBufs.size() == numPeers());
+        recvBufs.resize(numPeers());
+
+#if HAVE_MPI
+        const int n = static_cast<int>(numPeers());
+
+        // exchange the number of bytes to be sent
+        std::vector<int> sendCounts(n), recvCounts(n);
+        for (int i = 0; i < n; ++i)
+            sendCounts[i] = static_cast<int>(sendBufs[i].size()*sizeof(T));
+
+#if MPI_VERSION >= 3
+        MPI_Neighbor_alltoall(sendCounts.data(), 1, MPI_INT,
+                              recvCounts.data(), 1, MPI_INT,
+                              graphComm_);
+#else
+        exchangeP2p_(sendCounts.data(), recvCounts.data());
+#endif
+
+        // flatten the send buffers and allocate the receive buffer
+        std::vector<int> sendDispl(n + 1, 0), recvDispl(n + 1, 0);
+        for (int i = 0; i < n; ++i) {
+            sendDispl[i + 1] = sendDispl[i] + sendCounts[i];
+            recvDispl[i + 1] = recvDispl[i] + recvCounts[i];
+        }
+
+        std::vector<char> sendData(sendDispl[n]);
+        std::vector<char> recvData(recvDispl[n]);
+        for (int i = 0; i < n; ++i)
+            if (sendCounts[i] > 0)
+                std::memcpy(sendData.data() + sendDispl[i], sendBufs[i].data(), sendCounts[i]);
+
+#if MPI_VERSION >= 3
+        MPI_Neighbor_alltoallv(sendData.data(), sendCounts.data(), sendDispl.data(), MPI_BYTE,
+                               recvData.data(), recvCounts.data(), recvDispl.data(), MPI_BYTE,
+                               graphComm_);
+#else
+        exchangeP2p_(sendData.data(), sendCounts.data(), sendDispl.data(),
+                     recvData.data(), recvCounts.data(), recvDispl.data());
+#endif
+
+        for (int i = 0; i < n; ++i) {
+            recvBufs[i].resize(static_cast<size_t>(recvCounts[i])/sizeof(T));
+            if (recvCounts[i] > 0)
+                std::memcpy(recvBufs[i].data(), recvData.data() + recvDispl[i], recvCounts[i]);
+        }
+#else
+        for (auto& buf : recvBufs)
+            buf.clear();
+#endif // HAVE_MPI
+    }
+
+private:
+#if HAVE_MPI && MPI_VERSION < 3
+    void exchangeP2p_(const int* sendCounts, int* recvCounts) const
+    {
+        const int n = static_cast<int>(numPeers());
+        std::vector<MPI_Request> requests(2*n);
+        for (int i = 0; i < n; ++i) {
+            MPI_Irecv(recvCounts + i, 1, MPI_INT, static_cast<int>(peers_[i]),
+                      /*tag=*/0, MPI_COMM_WORLD, &requests[i]);
+            MPI_Isend(const_cast<int*>(sendCounts + i), 1, MPI_INT, static_cast<int>(peers_[i]),
+                      /*tag=*/0, MPI_COMM_WORLD, &requests[n + i]);
+        }
+        MPI_Waitall(2*n, requests.data(), MPI_STATUSES_IGNORE);
+    }
+
+    void exchangeP2p_(const char* sendData, const int* sendCounts, const int* sendDispl,
+                      char* recvData, const int* recvCounts, const int* recvDispl) const
+    {
+        const int n = static_cast<int>(numPeers());
+        std::vector<MPI_Request> requests(2*n);
+        for (int i = 0; i < n; ++i) {
+            MPI_Irecv(recvData + recvDispl[i], recvCounts[i], MPI_BYTE, static_cast<int>(peers_[i]),
+                      /*tag=*/0, MPI_COMM_WORLD, &requests[i]);
+            MPI_Isend(const_cast<char*>(sendData + sendDispl[i]), sendCounts[i], MPI_BYTE,
+                      static_cast<int>(peers_[i]), /*tag=*/0, MPI_COMM_WORLD, &requests[n + i]);
+        }
+        MPI_Waitall(2*n, requests.data(), MPI_STATUSES_IGNORE);
+    }
+#endif
+
+    std::vector<ProcessRank> peers_;
+#if HAVE_MPI && MPI_VERSION >= 3
+    MPI_Comm graphComm_;
+#endif
+};
+
+} // namespace Linear
+} // namespace Opm
+
+#endif
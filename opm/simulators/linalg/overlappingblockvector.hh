@@ -28,6 +28,7 @@
 #define EWOMS_OVERLAPPING_BLOCK_VECTOR_HH
 
 #include "overlaptypes.hh"
+#include "sharedmemoryexchange.hh"
 
 #include <opm/models/parallel/mpibuffer.hh>
 #include <opm/material/common/Valgrind.hpp>
@@ -35,6 +36,7 @@
 #include <dune/istl/bvector.hh>
 #include <dune/common/fvector.hh>
 
+#include <cassert>
 #include <memory>
 #include <map>
 #include <iostream>
@@ -44,6 +46,10 @@ namespace Linear {
 
 /*!
  * \brief An overlap aware block vector.
+ *
+ * The values of the overlapping rows are exchanged with the peer processes on
+ * the same compute node via shared memory and with all remaining peer
+ * processes via MPI messages.
  */
 template <class FieldVector, class Overlap>
 class OverlappingBlockVector : public Dune::BlockVector<FieldVector>
@@ -70,6 +76,7 @@ public:
         , indicesRecvBuff_(obv.indicesRecvBuff_)
         , valuesSendBuff_(obv.valuesSendBuff_)
         , valuesRecvBuff_(obv.valuesRecvBuff_)
+        , nodeExchange_(obv.nodeExchange_)
         , overlap_(obv.overlap_)
     {}
 
@@ -97,6 +104,7 @@ public:
         indicesRecvBuff_ = obv.indicesRecvBuff_;
         valuesSendBuff_ = obv.valuesSendBuff_;
         valuesRecvBuff_ = obv.valuesRecvBuff_;
+        nodeExchange_ = obv.nodeExchange_;
         overlap_ = obv.overlap_;
         return *this;
     }
@@ -174,13 +182,23 @@ public:
      */
     void sync()
     {
-        // send all entries to all peers
+        // send all entries to all peers on other nodes
         for (const auto peerRank: overlap_->peerSet())
-            sendEntries_(peerRank);
+            if (!isNodeLocal_(peerRank))
+                sendEntries_(peerRank);
+
+        // while these messages are in flight, exchange the entries with the peers
+        // on the same node
+        if (nodeExchange_)
+            nodeExchange_->exchange([this](ProcessRank peerRank, FieldVector* dest)
+                                    { packEntries_(peerRank, dest); },
+                                    [this](ProcessRank peerRank, const FieldVector* src, size_t n)
+                                    { assignFromMaster_(peerRank, src, n); });
 
         // recieve all entries to the peers
         for (const auto peerRank: overlap_->peerSet())
-            receiveFromMaster_(peerRank);
+            if (!isNodeLocal_(peerRank))
+                receiveFromMaster_(peerRank);
 
         // wait until we have send everything
         waitSendFinished_();
@@ -192,13 +210,23 @@ public:
      */
     void syncAdd()
     {
-        // send all entries to all peers
+        // send all entries to all peers on other nodes
         for (const auto peerRank: overlap_->peerSet())
-            sendEntries_(peerRank);
+            if (!isNodeLocal_(peerRank))
+                sendEntries_(peerRank);
+
+        // while these messages are in flight, exchange the entries with the peers
+        // on the same node
+        if (nodeExchange_)
+            nodeExchange_->exchange([this](ProcessRank peerRank, FieldVector* dest)
+                                    { packEntries_(peerRank, dest); },
+                                    [this](ProcessRank peerRank, const FieldVector* src, size_t n)
+                                    { add_(peerRank, src, n); });
 
         // recieve all entries to the peers
         for (const auto peerRank: overlap_->peerSet())
-            receiveAdd_(peerRank);
+            if (!isNodeLocal_(peerRank))
+                receiveAdd_(peerRank);
 
         // wait until we have send everything
         waitSendFinished_();
@@ -288,9 +316,42 @@ private:
                 indicesSendBuff[i] = overlap_->globalToDomestic(indicesSendBuff[i]);
             }
         }
+
+        // get the shared memory window for the peers on the same node. it is
+        // only set up by the first vector which uses the overlap
+        nodeExchange_ = overlap_->template nodeExchange<FieldVector>();
 #endif // HAVE_MPI
     }
 
+    bool isNodeLocal_(ProcessRank peerRank) const
+    { return nodeExchange_ && nodeExchange_->isNodeLocal(peerRank); }
+
+    void packEntries_(ProcessRank peerRank, FieldVector* dest) const
+    {
+        const MpiBuffer<Index>& indices = *indicesSendBuff_.at(peerRank);
+        for (unsigned i = 0; i < indices.size(); ++i)
+            dest[i] = (*this)[static_cast<unsigned>(indices[i])];
+    }
+
+    void assignFromMaster_(ProcessRank peerRank, const FieldVector* values, size_t numValues)
+    {
+        const MpiBuffer<Index>& indices = *indicesRecvBuff_.at(peerRank);
+        assert(indices.size() == numValues);
+        for (unsigned j = 0; j < numValues; ++j) {
+            Index domRowIdx = indices[j];
+            if (overlap_->masterRank(domRowIdx) == peerRank)
+                (*this)[static_cast<unsigned>(domRowIdx)] = values[j];
+        }
+    }
+
+    void add_(ProcessRank peerRank, const FieldVector* values, size_t numValues)
+    {
+        const MpiBuffer<Index>& indices = *indicesRecvBuff_.at(peerRank);
+        assert(indices.size() == numValues);
+        for (unsigned j = 0; j < numValues; ++j)
+            (*this)[static_cast<unsigned>(indices[j])] += values[j];
+    }
+
     void sendEntries_(ProcessRank peerRank)
     {
         // copy the values into the send buffer
@@ -311,7 +372,8 @@ private:
         peerIt = overlap_->peerSet().begin();
         for (; peerIt != peerEndIt; ++peerIt) {
             ProcessRank peerRank = *peerIt;
-            valuesSendBuff_[peerRank]->wait();
+            if (!isNodeLocal_(peerRank))
+                valuesSendBuff_[peerRank]->wait();
         }
     }
 
@@ -352,6 +414,7 @@ private:
     std::map<ProcessRank, std::shared_ptr<MpiBuffer<Index> > > indicesRecvBuff_;
     std::map<ProcessRank, std::shared_ptr<MpiBuffer<FieldVector> > > valuesSendBuff_;
     std::map<ProcessRank, std::shared_ptr<MpiBuffer<FieldVector> > > valuesRecvBuff_;
+    std::shared_ptr<SharedMemoryExchange<FieldVector> > nodeExchange_;
 
     const Overlap *overlap_;
 };
@@ -30,11 +30,79 @@
 #include <dune/istl/operators.hh>
 #include <dune/common/version.hh>
 
+#include <cstddef>
+
 namespace Opm {
 namespace Linear {
 
+/*!
+ * \brief Applies a linear operator which is defined on the native vectors of the
+ *        process to overlapping vectors.
+ *
+ * This allows to use matrix-free operators, e.g., the one of the TPFA linearizer, for
+ * the Krylov iterations. The rows which are not native to the process are set to
+ * zero, so the operator is only correct if the process does not have any peers.
+ */
+template <class NativeVector, class OverlappingVector, class Overlap>
+class OverlappingMatrixFreeOperator
+    : public Dune::LinearOperator<OverlappingVector, OverlappingVector>
+{
+public:
+    using NativeOperator = Dune::LinearOperator<NativeVector, NativeVector>;
+    using field_type = typename OverlappingVector::field_type;
+
+    OverlappingMatrixFreeOperator(const NativeOperator& op, const Overlap& overlap)
+        : op_(op), overlap_(overlap)
+    {}
+
+    //! the kind of computations supported by the operator. Either overlapping or non-overlapping
+    Dune::SolverCategory::Category category() const override
+    { return Dune::SolverCategory::overlapping; }
+
+    //! apply operator to x:  \f$ y = A(x) \f$
+    void apply(const OverlappingVector& x, OverlappingVector& y) const override
+    {
+        y = 0.0;
+        applyscaleadd(1.0, x, y);
+    }
+
+    //! apply operator to x, scale and add:  \f$ y = y + \alpha A(x) \f$
+    void applyscaleadd(field_type alpha, const OverlappingVector& x,
+                       OverlappingVector& y) const override
+    {
+        const std::size_t numNative = overlap_.numNative();
+        nativeX_.resize(numNative);
+        nativeY_.resize(numNative);
+        for (unsigned nativeIdx = 0; nativeIdx < numNative; ++nativeIdx) {
+            const int domIdx = overlap_.nativeToDomestic(static_cast<int>(nativeIdx));
+            for (unsigned i = 0; i < nativeX_[nativeIdx].size(); ++i)
+                nativeX_[nativeIdx][i] = (domIdx < 0) ? 0.0 : x[static_cast<unsigned>(domIdx)][i];
+        }
+
+        op_.apply(nativeX_, nativeY_);
+
+        for (unsigned nativeIdx = 0; nativeIdx < numNative; ++nativeIdx) {
+            const int domIdx = overlap_.nativeToDomestic(static_cast<int>(nativeIdx));
+            if (domIdx < 0)
+                continue;
+            for (unsigned i = 0; i < nativeY_[nativeIdx].size(); ++i)
+                y[static_cast<unsigned>(domIdx)][i] += alpha*nativeY_[nativeIdx][i];
+        }
+    }
+
+private:
+    const NativeOperator& op_;
+    const Overlap& overlap_;
+
+    mutable NativeVector nativeX_;
+    mutable NativeVector nativeY_;
+};
+
 /*!
  * \brief An overlap aware linear operator usable by ISTL.
+ *
+ * If a matrix-free operator is specified, it is applied instead of the matrix, which
+ * is then only used to construct the preconditioner.
  */
 template <class OverlappingMatrix, class DomainVector, class RangeVector>
 class OverlappingOperator
@@ -47,7 +115,9 @@ public:
     using domain_type = DomainVector;
     using field_type = typename domain_type::field_type;
 
-    OverlappingOperator(const OverlappingMatrix& A) : A_(A)
+    OverlappingOperator(const OverlappingMatrix& A,
+                        const Dune::LinearOperator<DomainVector, RangeVector>* matrixFreeOp = nullptr)
+        : A_(A), matrixFreeOp_(matrixFreeOp)
     {}
 
     //! the kind of computations supported by the operator. Either overlapping or non-overlapping
@@ -57,7 +127,10 @@ public:
     //! apply operator to x:  \f$ y = A(x) \f$
     virtual void apply(const DomainVector& x, RangeVector& y) const override
     {
-        A_.mv(x, y);
+        if (matrixFreeOp_)
+            matrixFreeOp_->apply(x, y);
+        else
+            A_.mv(x, y);
         y.sync();
     }
 
@@ -65,7 +138,10 @@ public:
     virtual void applyscaleadd(field_type alpha, const DomainVector& x,
                                RangeVector& y) const override
     {
-        A_.usmv(alpha, x, y);
+        if (matrixFreeOp_)
+            matrixFreeOp_->applyscaleadd(alpha, x, y);
+        else
+            A_.usmv(alpha, x, y);
         y.sync();
     }
 
@@ -78,6 +154,7 @@ public:
 
 private:
     const OverlappingMatrix& A_;
+    const Dune::LinearOperator<DomainVector, RangeVector>* matrixFreeOp_;
 };
 
 } // namespace Linear
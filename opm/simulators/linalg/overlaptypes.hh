@@ -29,10 +29,11 @@
 #ifndef EWOMS_OVERLAP_TYPES_HH
 #define EWOMS_OVERLAP_TYPES_HH
 
+#include <algorithm>
 #include <cstddef>
 #include <list>
-#include <map>
-#include <set>
+#include <stdexcept>
+#include <utility>
 #include <vector>
 
 namespace Opm {
@@ -53,6 +54,92 @@ using ProcessRank = unsigned;
  */
 using BorderDistance = unsigned;
 
+/*!
+ * \brief An associative container which stores its (key, value) pairs in a
+ *        contiguous array sorted by key.
+ *
+ * The overlap data structures map process ranks to values. Since the number
+ * of peer processes of a rank is small, a sorted array is much more compact
+ * and cache friendly than a node based std::map while it provides the subset
+ * of the std::map interface which is used by the overlap code.
+ */
+template <class Key, class Value>
+class FlatMap
+{
+    using Storage = std::vector<std::pair<Key, Value> >;
+
+public:
+    using key_type = Key;
+    using mapped_type = Value;
+    using value_type = typename Storage::value_type;
+    using iterator = typename Storage::iterator;
+    using const_iterator = typename Storage::const_iterator;
+
+    iterator begin()
+    { return data_.begin(); }
+    iterator end()
+    { return data_.end(); }
+    const_iterator begin() const
+    { return data_.begin(); }
+    const_iterator end() const
+    { return data_.end(); }
+
+    size_t size() const
+    { return data_.size(); }
+    bool empty() const
+    { return data_.empty(); }
+    void clear()
+    { data_.clear(); }
+
+    iterator find(const Key& key)
+    {
+        auto it = lowerBound_(key);
+        return (it != data_.end() && it->first == key) ? it : data_.end();
+    }
+
+    const_iterator find(const Key& key) const
+    {
+        auto it = lowerBound_(key);
+        return (it != data_.end() && it->first == key) ? it : data_.end();
+    }
+
+    size_t count(const Key& key) const
+    { return find(key) != end() ? 1 : 0; }
+
+    Value& operator[](const Key& key)
+    {
+        auto it = lowerBound_(key);
+        if (it == data_.end() || it->first != key)
+            it = data_.insert(it, value_type(key, Value()));
+        return it->second;
+    }
+
+    const Value& at(const Key& key) const
+    {
+        auto it = find(key);
+        if (it == data_.end())
+            throw std::out_of_range("FlatMap::at(): key not found");
+        return it->second;
+    }
+
+private:
+    iterator lowerBound_(const Key& key)
+    {
+        return std::lower_bound(data_.begin(), data_.end(), key,
+                                [](const value_type& a, const Key& b)
+                                { return a.first < b; });
+    }
+
+    const_iterator lowerBound_(const Key& key) const
+    {
+        return std::lower_bound(data_.begin(), data_.end(), key,
+                                [](const value_type& a, const Key& b)
+                                { return a.first < b; });
+    }
+
+    Storage data_;
+};
+
 /*!
  * \brief This structure stores an index and a process rank
  */
@@ -122,12 +209,13 @@ using BorderList = std::list<BorderIndex>;
 /*!
  * \brief The list of indices which are on the process boundary.
  */
-class SeedList : public std::list<IndexRankDist>
+class SeedList : public std::vector<IndexRankDist>
 {
 public:
     void update(const BorderList& borderList)
     {
         this->clear();
+        this->reserve(borderList.size());
 
         auto it = borderList.begin();
         const auto& endIt = borderList.end();
@@ -140,23 +228,79 @@ public:
             this->push_back(ird);
         }
     }
+
+    /*!
+     * \brief Remove all entries with an (index, rank) pair which already occurred
+     *        earlier in the list.
+     *
+     * The remaining entries are sorted by rank and index.
+     */
+    void removeDuplicates()
+    {
+        const auto less = [](const IndexRankDist& a, const IndexRankDist& b)
+        { return a.peerRank < b.peerRank || (a.peerRank == b.peerRank && a.index < b.index); };
+        const auto equal = [](const IndexRankDist& a, const IndexRankDist& b)
+        { return a.peerRank == b.peerRank && a.index == b.index; };
+
+        std::stable_sort(this->begin(), this->end(), less);
+        this->erase(std::unique(this->begin(), this->end(), equal), this->end());
+    }
 };
 
 /*!
  * \brief A set of process ranks
+ *
+ * The ranks are stored as a sorted array without duplicates.
  */
-class PeerSet : public std::set<ProcessRank>
+class PeerSet
 {
+    using Storage = std::vector<ProcessRank>;
+
 public:
+    using value_type = ProcessRank;
+    using iterator = Storage::const_iterator;
+    using const_iterator = Storage::const_iterator;
+
+    const_iterator begin() const
+    { return ranks_.begin(); }
+    const_iterator end() const
+    { return ranks_.end(); }
+
+    size_t size() const
+    { return ranks_.size(); }
+    bool empty() const
+    { return ranks_.empty(); }
+    void clear()
+    { ranks_.clear(); }
+
+    void insert(ProcessRank rank)
+    {
+        auto it = std::lower_bound(ranks_.begin(), ranks_.end(), rank);
+        if (it == ranks_.end() || *it != rank)
+            ranks_.insert(it, rank);
+    }
+
+    const_iterator find(ProcessRank rank) const
+    {
+        auto it = std::lower_bound(ranks_.begin(), ranks_.end(), rank);
+        return (it != ranks_.end() && *it == rank) ? it : ranks_.end();
+    }
+
+    size_t count(ProcessRank rank) const
+    { return find(rank) != end() ? 1 : 0; }
+
     void update(const BorderList& borderList)
     {
-        this->clear();
+        ranks_.clear();
+        for (const auto& borderIdx : borderList)
+            ranks_.push_back(borderIdx.peerRank);
 
-        auto it = borderList.begin();
-        const auto& endIt = borderList.end();
-        for (; it != endIt; ++it)
-            this->insert(it->peerRank);
+        std::sort(ranks_.begin(), ranks_.end());
+        ranks_.erase(std::unique(ranks_.begin(), ranks_.end()), ranks_.end());
     }
+
+private:
+    Storage ranks_;
 };
 
 /*!
@@ -168,12 +312,18 @@ using OverlapWithPeer = std::vector<IndexDistanceNpeers>;
  * \brief A type mapping the process rank to the list of indices
  *        shared with this peer.
  */
-using OverlapByRank = std::map<ProcessRank, OverlapWithPeer>;
+using OverlapByRank = FlatMap<ProcessRank, OverlapWithPeer>;
+
+/*!
+ * \brief The processes which see an index and the distance of the index to
+ *        their borders.
+ */
+using OverlapWithIndex = FlatMap<ProcessRank, BorderDistance>;
 
 /*!
  * \brief Maps each index to a list of processes .
  */
-using OverlapByIndex = std::vector<std::map<ProcessRank, BorderDistance> >;
+using OverlapByIndex = std::vector<OverlapWithIndex>;
 
 /*!
  * \brief The list of domestic indices are owned by peer rank.
@@ -184,7 +334,7 @@ using DomesticOverlapWithPeer = std::vector<Index>;
  * \brief A type mapping the process rank to the list of domestic indices
  *        which are owned by the peer.
  */
-using DomesticOverlapByRank = std::map<ProcessRank, DomesticOverlapWithPeer>;
+using DomesticOverlapByRank = FlatMap<ProcessRank, DomesticOverlapWithPeer>;
 
 } // namespace Linear
 } // namespace Opm
@@ -33,11 +33,14 @@
 #include "combinedcriterion.hh"
 #include "istlsparsematrixadapter.hh"
 
+#include <opm/models/utils/timer.hh>
+
 #include <dune/istl/bcrsmatrix.hh>
 #include <dune/istl/paamg/amg.hh>
 #include <dune/istl/paamg/pinfo.hh>
 #include <dune/istl/owneroverlapcopy.hh>
 
+#include <iostream>
 #include <memory>
 #include <tuple>
 #include <utility>
@@ -144,6 +147,7 @@ class ParallelAmgBackend : public ParallelBaseBackend<TypeTag>
 public:
     ParallelAmgBackend(const Simulator& simulator)
         : ParentType(simulator)
+        , indexSetTimingSequenceNumber_(-1)
     { }
 
     static void registerParameters()
@@ -163,12 +167,30 @@ protected:
 
     std::shared_ptr<AMG> preparePreconditioner_()
     {
+        if (this->reusePreconditioner_ && amg_)
+            return amg_;
+
 #if HAVE_MPI
         // create and initialize DUNE's OwnerOverlapCopyCommunication
         // using the domestic overlap
+        Timer indexSetTimer;
+        indexSetTimer.start();
         istlComm_ = std::make_shared<OwnerOverlapCopyCommunication>(MPI_COMM_WORLD);
         setupAmgIndexSet_(this->overlappingMatrix_->overlap(), istlComm_->indexSet());
         istlComm_->remoteIndices().template rebuild<false>();
+        indexSetTimer.stop();
+
+        // the index set is set up for each new preconditioner, but its timing is only
+        // reported once for each grid
+        if (indexSetTimingSequenceNumber_ != this->gridSequenceNumber_) {
+            indexSetTimingSequenceNumber_ = this->gridSequenceNumber_;
+            if (this->simulator_.gridView().comm().rank() == 0
+                && Parameters::get<TypeTag, Properties::LinearSolverVerbosity>() > 0)
+            {
+                std::cout << "Setting up the AMG index set took "
+                          << indexSetTimer.realTimeElapsed() << " seconds\n" << std::flush;
+            }
+        }
 #endif
 
         // create the parallel scalar product and the parallel operator
@@ -321,6 +343,9 @@ protected:
 #if HAVE_MPI
     std::shared_ptr<OwnerOverlapCopyCommunication> istlComm_;
 #endif
+
+    // the grid for which the setup time of the index set has been reported
+    int indexSetTimingSequenceNumber_;
 };
 
 } // namespace Linear
@@ -41,6 +41,7 @@
 #include <opm/models/utils/genericguard.hh>
 #include <opm/models/utils/propertysystem.hh>
 #include <opm/models/utils/parametersystem.hh>
+#include <opm/models/utils/timer.hh>
 #include <opm/simulators/linalg/matrixblock.hh>
 #include <opm/simulators/linalg/linalgproperties.hh>
 
@@ -49,9 +50,12 @@
 #include <dune/common/fvector.hh>
 #include <dune/common/version.hh>
 
+#include <cmath>
 #include <sstream>
 #include <memory>
 #include <iostream>
+#include <type_traits>
+#include <utility>
 
 namespace Opm::Properties {
 
@@ -77,6 +81,17 @@ public:
 
 namespace Opm {
 namespace Linear {
+namespace detail {
+// detects linearizers which can provide a matrix-free Jacobian operator
+template <class Linearizer, class = void>
+struct HasMatrixFreeOperator : public std::false_type {};
+
+template <class Linearizer>
+struct HasMatrixFreeOperator<Linearizer,
+                             std::void_t<decltype(std::declval<const Linearizer&>().matrixFreeOperator())>>
+    : public std::true_type {};
+} // namespace detail
+
 /*!
  * \ingroup Linear
  *
@@ -103,6 +118,20 @@ namespace Linear {
  *            that it is computationally cheaper because it does not
  *            need to consider things which are only required for
  *            higher orders
+ *
+ * If the LinearSolverScalar property is set to a floating point type of lower
+ * precision than Scalar (e.g., float), the copy of the Jacobian matrix, the
+ * preconditioner and the Krylov iterations use the lower precision, which roughly
+ * halves the memory traffic of the linear solver. The accuracy of the solution is then
+ * recovered by iterative refinement: the residual of the approximate solution is
+ * evaluated using the Jacobian matrix in full precision and the correction is again
+ * computed using the low precision solver. The maximum number of these refinement
+ * steps is specified by the LinearSolverMaxRefinementSteps parameter.
+ *
+ * If the linearizer stores the Jacobian in a matrix-free operator (see the
+ * LinearizeMatrixFree parameter of TpfaLinearizer), the Krylov iterations and the
+ * residuals of the iterative refinement use this operator, while the preconditioner is
+ * constructed from the Jacobian matrix, which then only contains the diagonal blocks.
  */
 template <class TypeTag>
 class ParallelBaseBackend
@@ -130,6 +159,9 @@ protected:
     using ParallelOperator = Opm::Linear::OverlappingOperator<OverlappingMatrix,
                                                               OverlappingVector,
                                                               OverlappingVector>;
+    using FullPrecisionVector = Opm::Linear::OverlappingBlockVector<typename Vector::block_type, Overlap>;
+    using NativeOperator = Dune::LinearOperator<Vector, Vector>;
+    using MatrixFreeOperator = Opm::Linear::OverlappingMatrixFreeOperator<Vector, OverlappingVector, Overlap>;
 
     enum { dimWorld = GridView::dimensionworld };
 
@@ -142,6 +174,7 @@ public:
         overlappingMatrix_ = nullptr;
         overlappingb_ = nullptr;
         overlappingx_ = nullptr;
+        nativeMatrix_ = nullptr;
     }
 
     ~ParallelBaseBackend()
@@ -162,6 +195,9 @@ public:
             ("The maximum number of iterations of the linear solver");
         Parameters::registerParam<TypeTag, Properties::LinearSolverVerbosity>
             ("The verbosity level of the linear solver");
+        Parameters::registerParam<TypeTag, Properties::LinearSolverMaxRefinementSteps>
+            ("The maximum number of iterative refinement steps if the linear solver "
+             "uses a lower floating point precision than the linearization");
 
         PreconditionerWrapper::registerParameters();
     }
@@ -195,16 +231,32 @@ public:
                                             simulator_.model().dofMapper());
 
         // create the overlapping Jacobian matrix
+        Timer overlapTimer;
+        overlapTimer.start();
         unsigned overlapSize = Parameters::get<TypeTag, Properties::LinearSolverOverlapSize>();
         overlappingMatrix_ = new OverlappingMatrix(M.istlMatrix(),
                                                    borderListCreator.borderList(),
                                                    borderListCreator.blackList(),
                                                    overlapSize);
+        overlapTimer.stop();
+
+        // this is only done once for each grid, so the timing does not clutter the
+        // output
+        if (simulator_.gridView().comm().rank() == 0
+            && Parameters::get<TypeTag, Properties::LinearSolverVerbosity>() > 0)
+        {
+            std::cout << "Constructing the algebraic overlap of "
+                      << overlappingMatrix_->overlap().numDomestic()
+                      << " domestic rows took " << overlapTimer.realTimeElapsed()
+                      << " seconds\n" << std::flush;
+        }
 
         // create the overlapping vectors for the residual and the
         // solution
         overlappingb_ = new OverlappingVector(overlappingMatrix_->overlap());
         overlappingx_ = new OverlappingVector(*overlappingb_);
+        if constexpr (mixedPrecision_())
+            fullPrecisionVector_ = std::make_unique<FullPrecisionVector>(overlappingMatrix_->overlap());
 
         // writeOverlapToVTK_();
     }
@@ -216,6 +268,11 @@ public:
      */
     void setResidual(const Vector& b)
     {
+        // the residual in full precision is required to compute the residual of
+        // iterative refinement steps
+        if constexpr (mixedPrecision_())
+            nativeResidual_ = b;
+
         // copy the interior values of the non-overlapping residual vector to the
         // overlapping one
         overlappingb_->assignAddBorder(b);
@@ -240,8 +297,29 @@ public:
      */
     void setMatrix(const SparseMatrixAdapter& M)
     {
+        nativeMatrix_ = &M.istlMatrix();
+        nativeOperator_ = linearizerOperator_();
         overlappingMatrix_->assignFromNative(M.istlMatrix());
         overlappingMatrix_->syncAdd();
+        preconditionerIsValid_ = false;
+        reusePreconditioner_ = false;
+    }
+
+    /*!
+     * \brief Solve the next linear system using the matrix and the preconditioner of
+     *        the previous solve instead of calling setMatrix().
+     *
+     * \return false if there is no such matrix, e.g., because the structure of the
+     *         linear system has been discarded since then. In this case,
+     *         setMatrix() must be called.
+     */
+    bool reuseMatrix()
+    {
+        if (!preconditionerIsValid_)
+            return false;
+
+        reusePreconditioner_ = true;
+        return true;
     }
 
     /*!
@@ -253,13 +331,18 @@ public:
     {
         (*overlappingx_) = 0.0;
 
+        // the preconditioner is kept until the matrix changes, so it can be reused
+        // if the matrix of the previous solve is reused
         auto parPreCond = asImp_().preparePreconditioner_();
-        auto precondCleanupFn = [this]() -> void
-                                { this->asImp_().cleanupPreconditioner_(); };
-        auto precondCleanupGuard = Opm::make_guard(precondCleanupFn);
+        preconditionerIsValid_ = true;
+
         // create the parallel scalar product and the parallel operator
         ParallelScalarProduct parScalarProduct(overlappingMatrix_->overlap());
-        ParallelOperator parOperator(*overlappingMatrix_);
+        std::unique_ptr<MatrixFreeOperator> matrixFreeOperator;
+        if (nativeOperator_)
+            matrixFreeOperator = std::make_unique<MatrixFreeOperator>(*nativeOperator_,
+                                                                      overlappingMatrix_->overlap());
+        ParallelOperator parOperator(*overlappingMatrix_, matrixFreeOperator.get());
 
         // retrieve the linear solver
         auto solver = asImp_().prepareSolver_(parOperator,
@@ -271,16 +354,20 @@ public:
             { this->asImp_().cleanupSolver_(); };
         GenericGuard<decltype(cleanupSolverFn)> solverGuard(cleanupSolverFn);
 
-        // run the linear solver and have some fun
-        auto result = asImp_().runSolver_(solver);
-        // store number of iterations used
-        lastIterations_ = result.second;
+        if constexpr (mixedPrecision_())
+            return refineSolution_(x, solver);
+        else {
+            // run the linear solver and have some fun
+            auto result = asImp_().runSolver_(solver);
+            // store number of iterations used
+            lastIterations_ = result.second;
 
-        // copy the result back to the non-overlapping vector
-        overlappingx_->assignTo(x);
+            // copy the result back to the non-overlapping vector
+            overlappingx_->assignTo(x);
 
-        // return the result of the solver
-        return result.first;
+            // return the result of the solver
+            return result.first;
+        }
     }
 
     /*!
@@ -296,8 +383,93 @@ protected:
     const Implementation& asImp_() const
     { return *static_cast<const Implementation *>(this); }
 
+    static constexpr bool mixedPrecision_()
+    { return !std::is_same_v<LinearSolverScalar, Scalar>; }
+
+    /*!
+     * \brief Solve the linear system using the low precision solver and improve the
+     *        solution by iterative refinement in full precision.
+     */
+    template <class SolverPtr>
+    bool refineSolution_(Vector& x, SolverPtr& solver)
+    {
+        const int maxRefinementSteps = Parameters::get<TypeTag, Properties::LinearSolverMaxRefinementSteps>();
+        const Scalar tolerance = Parameters::get<TypeTag, Properties::LinearSolverTolerance>();
+
+        // whether the linear system is solved is decided using the residual of the full
+        // precision system: the low precision solver may report convergence for a
+        // correction which does not achieve the requested residual reduction and vice
+        // versa.
+        const Scalar initialResidNorm = fullPrecisionNorm_(nativeResidual_);
+
+        Vector dx(x.size());
+        Vector resid(x.size());
+        x = 0.0;
+        lastIterations_ = 0;
+        bool converged = false;
+        for (int stepIdx = 0; ; ++stepIdx) {
+            (*overlappingx_) = 0.0;
+            auto result = asImp_().runSolver_(solver);
+            lastIterations_ += result.second;
+
+            overlappingx_->assignTo(dx);
+            x += dx;
+
+            // compute the residual of the current solution using the full precision
+            // Jacobian matrix
+            resid = nativeResidual_;
+            if (nativeOperator_)
+                nativeOperator_->applyscaleadd(-1.0, x, resid);
+            else
+                nativeMatrix_->mmv(x, resid);
+
+            converged = fullPrecisionNorm_(resid) <= tolerance*initialResidNorm;
+            if (converged || stepIdx >= maxRefinementSteps)
+                break;
+
+            // the residual is the right hand side of the next correction
+            overlappingb_->assignAddBorder(resid);
+        }
+
+        return converged;
+    }
+
+    // the matrix-free Jacobian operator of the linearizer or nullptr if the Jacobian
+    // is assembled into the matrix
+    const NativeOperator* linearizerOperator_() const
+    {
+        using Linearizer = std::decay_t<decltype(simulator_.model().linearizer())>;
+        if constexpr (detail::HasMatrixFreeOperator<Linearizer>::value) {
+            const auto& linearizer = simulator_.model().linearizer();
+            if (linearizer.isMatrixFree())
+                return &linearizer.matrixFreeOperator();
+        }
+
+        return nullptr;
+    }
+
+    // the norm of a non-overlapping vector in the precision of the linearization
+    Scalar fullPrecisionNorm_(const Vector& v) const
+    {
+        fullPrecisionVector_->assignAddBorder(v);
+
+        const auto& overlap = overlappingMatrix_->overlap();
+        Scalar sum = 0.0;
+        for (unsigned localIdx = 0; localIdx < overlap.numLocal(); ++localIdx) {
+            if (overlap.iAmMasterOf(static_cast<int>(localIdx)))
+                sum += (*fullPrecisionVector_)[localIdx]*(*fullPrecisionVector_)[localIdx];
+        }
+
+        return std::sqrt(simulator_.gridView().comm().sum(sum));
+    }
+
     void cleanup_()
     {
+        // the preconditioner refers to the overlapping matrix
+        cleanupPreconditioner_();
+        preconditionerIsValid_ = false;
+        reusePreconditioner_ = false;
+
         // create the overlapping Jacobian matrix and vectors
         delete overlappingMatrix_;
         delete overlappingb_;
@@ -306,14 +478,21 @@ protected:
         overlappingMatrix_ = 0;
         overlappingb_ = 0;
         overlappingx_ = 0;
+        fullPrecisionVector_.reset();
     }
 
     std::shared_ptr<ParallelPreconditioner> preparePreconditioner_()
     {
+        if (reusePreconditioner_ && seqPreconditionerPrepared_)
+            return std::make_shared<ParallelPreconditioner>(precWrapper_.get(), overlappingMatrix_->overlap());
+
+        cleanupPreconditioner_();
+
         int preconditionerIsReady = 1;
         try {
             // update sequential preconditioner
             precWrapper_.prepare(*overlappingMatrix_);
+            seqPreconditionerPrepared_ = true;
         }
         catch (const Dune::Exception& e) {
             std::cout << "Preconditioner threw exception \"" << e.what()
@@ -334,7 +513,9 @@ protected:
 
     void cleanupPreconditioner_()
     {
-        precWrapper_.cleanup();
+        if (seqPreconditionerPrepared_)
+            precWrapper_.cleanup();
+        seqPreconditionerPrepared_ = false;
     }
 
     void writeOverlapToVTK_()
@@ -382,7 +563,19 @@ protected:
     OverlappingVector *overlappingb_;
     OverlappingVector *overlappingx_;
 
+    // the full precision linear system which is used for iterative refinement
+    const typename SparseMatrixAdapter::IstlMatrix *nativeMatrix_;
+    const NativeOperator *nativeOperator_ = nullptr;
+    Vector nativeResidual_;
+    std::unique_ptr<FullPrecisionVector> fullPrecisionVector_;
+
     PreconditionerWrapper precWrapper_;
+    bool seqPreconditionerPrepared_ = false;
+
+    // true if a preconditioner for the current matrix has been set up
+    bool preconditionerIsValid_ = false;
+    // true if the preconditioner of the previous solve is to be used again
+    bool reusePreconditioner_ = false;
 };
 }} // namespace Linear, Opm
 
@@ -404,6 +597,19 @@ struct PreconditionerRelaxation<TypeTag, TTag::ParallelBaseLinearSolver>
 template<class TypeTag>
 struct PreconditionerOrder<TypeTag, TTag::ParallelBaseLinearSolver> { static constexpr int value = 0; };
 
+//! use ILU if the preconditioner is selected at run time
+template<class TypeTag>
+struct PreconditionerType<TypeTag, TTag::ParallelBaseLinearSolver> { static constexpr auto value = "ilu"; };
+
+//! the coarsening target of the AMG used for the pressure system of the CPR
+//! preconditioner
+template<class TypeTag>
+struct AmgCoarsenTarget<TypeTag, TTag::ParallelBaseLinearSolver> { static constexpr int value = 5000; };
+
+//! use quasi-IMPES weights for the pressure equation of the CPR preconditioner
+template<class TypeTag>
+struct CprWeights<TypeTag, TTag::ParallelBaseLinearSolver> { static constexpr auto value = "quasiimpes"; };
+
 //! by default use the same kind of floating point values for the linearization and for
 //! the linear solve
 template<class TypeTag>
@@ -458,6 +664,10 @@ template<class TypeTag>
 struct PreconditionerWrapper<TypeTag, TTag::ParallelBaseLinearSolver>
 { using type = Opm::Linear::PreconditionerWrapperILU<TypeTag>; };
 
+//! do at most three refinement steps if the linear solver uses a reduced precision
+template<class TypeTag>
+struct LinearSolverMaxRefinementSteps<TypeTag, TTag::ParallelBaseLinearSolver> { static constexpr int value = 3; };
+
 //! set the default overlap size to 2
 template<class TypeTag>
 struct LinearSolverOverlapSize<TypeTag, TTag::ParallelBaseLinearSolver> { static constexpr unsigned value = 2; };
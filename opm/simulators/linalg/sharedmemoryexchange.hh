@@ -0,0 +1,316 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::Linear::SharedMemoryExchange
+ */
+#ifndef EWOMS_SHARED_MEMORY_EXCHANGE_HH
+#define EWOMS_SHARED_MEMORY_EXCHANGE_HH
+
+#include "overlaptypes.hh"
+
+#if HAVE_MPI
+#include <mpi.h>
+#endif
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace Opm {
+namespace Linear {
+
+/*!
+ * \brief Exchanges arrays of trivially copyable objects with the peer processes
+ *        which run on the same compute node using an MPI-3 shared memory window.
+ *
+ * Each process exposes a segment of a shared memory window which contains the
+ * values it sends to its node-local peers. The peers directly read the values
+ * from there instead of receiving a copy via MPI messages. The processes only
+ * synchronize with their node-local peers, not with all processes of the node:
+ * Each process publishes the number of completed exchanges and each of its
+ * peers acknowledges having read the values of an exchange. Since the send
+ * values are double buffered, a process only needs to wait for the
+ * acknowledgment of the exchange before the previous one before it may
+ * overwrite its send values.
+ *
+ * The peers which are not on the same node are not handled by this class. If
+ * MPI-3 is not available, the set of node-local peers is always empty.
+ *
+ * The constructor is collective on MPI_COMM_WORLD.
+ */
+template <class Value>
+class SharedMemoryExchange
+{
+    static_assert(std::is_trivially_copyable<Value>::value,
+                  "Only trivially copyable objects can be exchanged");
+
+    using Counter = std::atomic<std::uint64_t>;
+
+    // The layout of the segment of each process: the number of completed
+    // exchanges, for each process on the node the last exchange it has
+    // acknowledged as well as the offset and number of the values sent to it,
+    // followed by the two buffers for the values.
+    struct Header
+    {
+        Counter seq;
+    };
+
+public:
+    /*!
+     * \brief Set up the shared memory window.
+     *
+     * \param peerSet The peer processes of the calling process
+     * \param numSendEntries A functor which returns the number of values which
+     *                       are sent to a given peer process
+     */
+    template <class NumSendEntries>
+    SharedMemoryExchange(const PeerSet& peerSet, NumSendEntries numSendEntries)
+    {
+#if HAVE_MPI && MPI_VERSION >= 3
+        MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, /*key=*/0,
+                            MPI_INFO_NULL, &nodeComm_);
+        MPI_Comm_rank(nodeComm_, &nodeRank_);
+        MPI_Comm_size(nodeComm_, &nodeSize_);
+
+        // find the peers which are on the same node
+        std::vector<int> peerRanks(peerSet.begin(), peerSet.end());
+        std::vector<int> peerNodeRanks(peerRanks.size());
+        MPI_Group worldGroup, nodeGroup;
+        MPI_Comm_group(MPI_COMM_WORLD, &worldGroup);
+        MPI_Comm_group(nodeComm_, &nodeGroup);
+        MPI_Group_translate_ranks(worldGroup, static_cast<int>(peerRanks.size()), peerRanks.data(),
+                                  nodeGroup, peerNodeRanks.data());
+        MPI_Group_free(&worldGroup);
+        MPI_Group_free(&nodeGroup);
+
+        isNodeLocal_.assign(peerRanks.size(), false);
+        std::uint64_t numValues = 0;
+        for (size_t i = 0; i < peerRanks.size(); ++i) {
+            if (peerNodeRanks[i] == MPI_UNDEFINED)
+                continue;
+
+            isNodeLocal_[i] = true;
+            Peer peer;
+            peer.rank = static_cast<ProcessRank>(peerRanks[i]);
+            peer.nodeRank = peerNodeRanks[i];
+            peer.sendOffset = numValues;
+            peer.numSend = static_cast<std::uint64_t>(numSendEntries(peer.rank));
+            numValues += peer.numSend;
+            localPeers_.push_back(peer);
+        }
+        peerRanks_.assign(peerSet.begin(), peerSet.end());
+        numSendValues_ = numValues;
+
+        // allocate the window. the header and the size of each segment are padded
+        // to full cache lines, so the segments of all processes stay aligned
+        const MPI_Aint segmentSize =
+            static_cast<MPI_Aint>(roundUp_(headerBytes_() + 2*numValues*sizeof(Value)));
+        void* base = nullptr;
+        MPI_Win_allocate_shared(segmentSize, /*dispUnit=*/1, MPI_INFO_NULL, nodeComm_, &base, &win_);
+        MPI_Win_lock_all(MPI_MODE_NOCHECK, win_);
+
+        ownSegment_ = static_cast<char*>(base);
+        new (&header_(ownSegment_)) Header;
+        header_(ownSegment_).seq.store(0);
+        for (int r = 0; r < nodeSize_; ++r) {
+            new (&ack_(ownSegment_, r)) Counter(0);
+            offset_(ownSegment_, r) = 0;
+            count_(ownSegment_, r) = 0;
+        }
+        for (const auto& peer : localPeers_) {
+            offset_(ownSegment_, peer.nodeRank) = peer.sendOffset;
+            count_(ownSegment_, peer.nodeRank) = peer.numSend;
+        }
+
+        MPI_Win_sync(win_);
+        MPI_Barrier(nodeComm_);
+        MPI_Win_sync(win_);
+
+        // get the addresses of the segments of the node-local peers and where our
+        // values are located within them
+        for (auto& peer : localPeers_) {
+            MPI_Aint size;
+            int dispUnit;
+            void* peerBase;
+            MPI_Win_shared_query(win_, peer.nodeRank, &size, &dispUnit, &peerBase);
+            peer.segment = static_cast<char*>(peerBase);
+            peer.recvOffset = offset_(peer.segment, nodeRank_);
+            peer.numRecv = count_(peer.segment, nodeRank_);
+            peer.numPeerValues = 0;
+            for (int r = 0; r < nodeSize_; ++r)
+                peer.numPeerValues += count_(peer.segment, r);
+        }
+#else
+        isNodeLocal_.assign(peerSet.size(), false);
+        peerRanks_.assign(peerSet.begin(), peerSet.end());
+        (void) numSendEntries;
+#endif
+    }
+
+    SharedMemoryExchange(const SharedMemoryExchange&) = delete;
+    SharedMemoryExchange& operator=(const SharedMemoryExchange&) = delete;
+
+    ~SharedMemoryExchange()
+    {
+#if HAVE_MPI && MPI_VERSION >= 3
+        MPI_Win_unlock_all(win_);
+        MPI_Win_free(&win_);
+        MPI_Comm_free(&nodeComm_);
+#endif
+    }
+
+    /*!
+     * \brief Returns true if a peer process runs on the same node as the calling
+     *        process.
+     */
+    bool isNodeLocal(ProcessRank peerRank) const
+    {
+        for (size_t i = 0; i < peerRanks_.size(); ++i)
+            if (peerRanks_[i] == peerRank)
+                return isNodeLocal_[i];
+        return false;
+    }
+
+    /*!
+     * \brief Returns the number of peer processes which run on the same node.
+     */
+    size_t numNodeLocalPeers() const
+    { return localPeers_.size(); }
+
+    /*!
+     * \brief Exchange values with all node-local peer processes.
+     *
+     * pack(peerRank, Value* dest) must write the values which are sent to a peer
+     * to dest, unpack(peerRank, const Value* src, size_t n) is called with the n
+     * values which have been received from a peer.
+     */
+    template <class Pack, class Unpack>
+    void exchange([[maybe_unused]] Pack pack, [[maybe_unused]] Unpack unpack)
+    {
+#if HAVE_MPI && MPI_VERSION >= 3
+        if (localPeers_.empty())
+            return;
+
+        const std::uint64_t k = ++numExchanges_;
+
+        // wait until all peers have read the values of the exchange which used the
+        // same buffer
+        if (k > 2) {
+            for (const auto& peer : localPeers_)
+                waitFor_(ack_(ownSegment_, peer.nodeRank), k - 2);
+        }
+
+        // write the values for the peers to the buffer of the current exchange and
+        // publish them
+        Value* sendBuf = values_(ownSegment_, k % 2, numSendValues_);
+        for (const auto& peer : localPeers_)
+            pack(peer.rank, sendBuf + peer.sendOffset);
+        header_(ownSegment_).seq.store(k, std::memory_order_release);
+
+        // read the values of the peers and acknowledge their reception
+        for (const auto& peer : localPeers_) {
+            waitFor_(header_(peer.segment).seq, k);
+            unpack(peer.rank, values_(peer.segment, k % 2, peer.numPeerValues) + peer.recvOffset, peer.numRecv);
+            ack_(peer.segment, nodeRank_).store(k, std::memory_order_release);
+        }
+#endif
+    }
+
+private:
+#if HAVE_MPI && MPI_VERSION >= 3
+    struct Peer
+    {
+        ProcessRank rank;
+        int nodeRank;
+        char* segment;
+        std::uint64_t sendOffset;
+        std::uint64_t numSend;
+        std::uint64_t recvOffset;
+        std::uint64_t numRecv;
+        std::uint64_t numPeerValues;
+    };
+
+    static void waitFor_(const Counter& counter, std::uint64_t value)
+    {
+        // the point-to-point messages to the peers on other nodes have already
+        // been posted when the shared memory exchange starts. make sure that they
+        // make progress while we are waiting.
+        unsigned numSpins = 0;
+        while (counter.load(std::memory_order_acquire) < value) {
+            if (++numSpins % 1024 == 0) {
+                int flag;
+                MPI_Iprobe(MPI_ANY_SOURCE, MPI_ANY_TAG, MPI_COMM_WORLD, &flag, MPI_STATUS_IGNORE);
+            }
+            std::this_thread::yield();
+        }
+    }
+
+    static size_t roundUp_(size_t n)
+    {
+        constexpr size_t align = alignof(Value) > 64 ? alignof(Value) : 64;
+        return (n + align - 1)/align*align;
+    }
+
+    size_t headerBytes_() const
+    { return roundUp_(sizeof(Header) + static_cast<size_t>(nodeSize_)*3*sizeof(std::uint64_t)); }
+
+    Header& header_(char* segment) const
+    { return *reinterpret_cast<Header*>(segment); }
+
+    Counter& ack_(char* segment, int nodeRank) const
+    { return reinterpret_cast<Counter*>(segment + sizeof(Header))[nodeRank]; }
+
+    std::uint64_t& offset_(char* segment, int nodeRank) const
+    { return reinterpret_cast<std::uint64_t*>(segment + sizeof(Header))[nodeSize_ + nodeRank]; }
+
+    std::uint64_t& count_(char* segment, int nodeRank) const
+    { return reinterpret_cast<std::uint64_t*>(segment + sizeof(Header))[2*nodeSize_ + nodeRank]; }
+
+    Value* values_(char* segment, std::uint64_t bufferIdx, std::uint64_t numValues) const
+    { return reinterpret_cast<Value*>(segment + headerBytes_()) + bufferIdx*numValues; }
+
+    MPI_Comm nodeComm_;
+    MPI_Win win_;
+    int nodeRank_ = 0;
+    int nodeSize_ = 1;
+    char* ownSegment_ = nullptr;
+    std::uint64_t numSendValues_ = 0;
+    std::uint64_t numExchanges_ = 0;
+    std::vector<Peer> localPeers_;
+#else
+    struct Peer {};
+    std::vector<Peer> localPeers_;
+#endif
+    std::vector<ProcessRank> peerRanks_;
+    std::vector<bool> isNodeLocal_;
+};
+
+} // namespace Linear
+} // namespace Opm
+
+#endif
@@ -0,0 +1,233 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::Linear::SparsityPattern
+ */
+#ifndef EWOMS_SPARSITY_PATTERN_HH
+#define EWOMS_SPARSITY_PATTERN_HH
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+namespace Opm {
+namespace Linear {
+
+/*!
+ * \ingroup Linear
+ * \brief The sparsity pattern of a matrix in compressed row storage format.
+ *
+ * The pattern is built in two passes: First, an upper bound for the number of
+ * column indices of each row is announced using addRowSize(). After calling
+ * endRowSizes(), the column indices are added using addIndex(). Duplicate
+ * indices are allowed and are removed by endIndices(), which also sorts the
+ * indices of each row. Compared to a std::set per row, this avoids one heap
+ * allocation per matrix entry.
+ */
+class SparsityPattern
+{
+public:
+    using Index = unsigned;
+    using const_iterator = std::vector<Index>::const_iterator;
+
+    explicit SparsityPattern(size_t numRows = 0)
+    { clear(numRows); }
+
+    /*!
+     * \brief Remove all entries and set the number of rows.
+     */
+    void clear(size_t numRows)
+    {
+        rowOffsets_.assign(numRows + 1, 0);
+        cursor_.clear();
+        columns_.clear();
+        columns_.shrink_to_fit();
+    }
+
+    /*!
+     * \brief Returns the number of rows of the pattern.
+     */
+    size_t numRows() const
+    { return rowOffsets_.size() - 1; }
+
+    /*!
+     * \brief Returns the total number of column indices of the pattern.
+     */
+    size_t numNonZeros() const
+    { return rowOffsets_.back(); }
+
+    /*!
+     * \brief Reserve space for n more column indices of a row.
+     *
+     * May only be called before endRowSizes().
+     */
+    void addRowSize(size_t rowIdx, size_t n)
+    {
+        assert(cursor_.empty());
+        rowOffsets_[rowIdx + 1] += n;
+    }
+
+    /*!
+     * \brief Allocate the storage for the column indices.
+     */
+    void endRowSizes()
+    {
+        const size_t n = numRows();
+        for (size_t rowIdx = 0; rowIdx < n; ++rowIdx)
+            rowOffsets_[rowIdx + 1] += rowOffsets_[rowIdx];
+
+        columns_.resize(rowOffsets_.back());
+        cursor_.assign(rowOffsets_.begin(), rowOffsets_.end() - 1);
+    }
+
+    /*!
+     * \brief Add a column index to a row.
+     *
+     * May only be called between endRowSizes() and endIndices() and at most as
+     * often for a given row as announced via addRowSize().
+     */
+    void addIndex(size_t rowIdx, Index colIdx)
+    {
+        assert(cursor_[rowIdx] < rowOffsets_[rowIdx + 1]);
+        columns_[cursor_[rowIdx]++] = colIdx;
+    }
+
+    /*!
+     * \brief Add a range of column indices to a row.
+     */
+    template <class It>
+    void addIndices(size_t rowIdx, It begin, It end)
+    {
+        for (; begin != end; ++begin)
+            addIndex(rowIdx, static_cast<Index>(*begin));
+    }
+
+    /*!
+     * \brief Sort the column indices of each row, remove duplicates and
+     *        compress the storage.
+     *
+     * Reserved entries which have not been filled are discarded.
+     */
+    void endIndices()
+    {
+        const long n = static_cast<long>(numRows());
+        std::vector<size_t> rowSize(numRows());
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+        for (long rowIdx = 0; rowIdx < n; ++rowIdx) {
+            auto rowBegin = columns_.begin() + rowOffsets_[rowIdx];
+            auto rowEnd = columns_.begin() + cursor_[rowIdx];
+            std::sort(rowBegin, rowEnd);
+            rowSize[rowIdx] = std::unique(rowBegin, rowEnd) - rowBegin;
+        }
+
+        // compact the storage in place. since no row is moved towards the back,
+        // moving the rows front to back never overwrites data which is still
+        // needed.
+        size_t pos = 0;
+        for (long rowIdx = 0; rowIdx < n; ++rowIdx) {
+            const size_t oldBegin = rowOffsets_[rowIdx];
+            rowOffsets_[rowIdx] = pos;
+            if (oldBegin != pos)
+                std::copy(columns_.begin() + oldBegin,
+                          columns_.begin() + oldBegin + rowSize[rowIdx],
+                          columns_.begin() + pos);
+            pos += rowSize[rowIdx];
+        }
+        rowOffsets_[n] = pos;
+        columns_.resize(pos);
+        columns_.shrink_to_fit();
+
+        cursor_.clear();
+        cursor_.shrink_to_fit();
+    }
+
+    /*!
+     * \brief Merge an additional per-row set of column indices into a finished
+     *        pattern.
+     *
+     * This is intended for the neighbors which are added by the auxiliary
+     * modules, which only affect a small number of rows.
+     */
+    template <class Set>
+    void merge(const std::vector<Set>& extraIndices)
+    {
+        assert(extraIndices.size() == numRows());
+
+        bool hasExtra = false;
+        for (const auto& s : extraIndices)
+            hasExtra = hasExtra || !s.empty();
+        if (!hasExtra)
+            return;
+
+        std::vector<size_t> oldOffsets;
+        std::vector<Index> oldColumns;
+        oldOffsets.swap(rowOffsets_);
+        oldColumns.swap(columns_);
+
+        clear(oldOffsets.size() - 1);
+        const size_t n = numRows();
+        for (size_t rowIdx = 0; rowIdx < n; ++rowIdx)
+            addRowSize(rowIdx, (oldOffsets[rowIdx + 1] - oldOffsets[rowIdx]) + extraIndices[rowIdx].size());
+        endRowSizes();
+        for (size_t rowIdx = 0; rowIdx < n; ++rowIdx) {
+            addIndices(rowIdx,
+                       oldColumns.begin() + oldOffsets[rowIdx],
+                       oldColumns.begin() + oldOffsets[rowIdx + 1]);
+            addIndices(rowIdx, extraIndices[rowIdx].begin(), extraIndices[rowIdx].end());
+        }
+        endIndices();
+    }
+
+    /*!
+     * \brief Returns the number of column indices of a row.
+     */
+    size_t rowSize(size_t rowIdx) const
+    { return rowOffsets_[rowIdx + 1] - rowOffsets_[rowIdx]; }
+
+    /*!
+     * \brief Returns an iterator to the first column index of a row.
+     */
+    const_iterator rowBegin(size_t rowIdx) const
+    { return columns_.begin() + rowOffsets_[rowIdx]; }
+
+    /*!
+     * \brief Returns an iterator past the last column index of a row.
+     */
+    const_iterator rowEnd(size_t rowIdx) const
+    { return columns_.begin() + rowOffsets_[rowIdx + 1]; }
+
+private:
+    std::vector<size_t> rowOffsets_;
+    std::vector<size_t> cursor_;
+    std::vector<Index> columns_;
+};
+
+} // namespace Linear
+} // namespace Opm
+
+#endif
@@ -94,6 +94,13 @@ public:
     void setMatrix(const SparseMatrixAdapter& M)
     { M_ = &M; }
 
+    /*!
+     * \brief Reusing the matrix of the previous solve is not supported because the
+     *        SuperLU backend does not store a copy of the matrix.
+     */
+    bool reuseMatrix()
+    { return false; }
+
     bool solve(Vector& x)
     { return SuperLUSolve_<Scalar, TypeTag, Matrix, Vector>::solve_(*M_, x, *b_); }
 
@@ -0,0 +1,106 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \brief Measures how the application of the block ILU(0) and DILU preconditioners
+ *        scales with the number of threads.
+ *
+ * This program is only compiled, but it is not run by the test suite. The size of the
+ * grid of the test matrix can be specified on the command line, e.g.
+ * \code
+ * OMP_NUM_THREADS=16 ./bin/benchmark_blockilu0 1000 1000
+ * \endcode
+ */
+#include "config.h"
+
+#include "structuredtpfamatrix.hh"
+
+#include <opm/simulators/linalg/blockilu0.hh>
+#include <opm/simulators/linalg/matrixblock.hh>
+
+#include <dune/common/fvector.hh>
+#include <dune/common/parallel/mpihelper.hh>
+#include <dune/istl/bcrsmatrix.hh>
+#include <dune/istl/bvector.hh>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+constexpr int numEq = 3;
+using Scalar = double;
+using Block = Opm::MatrixBlock<Scalar, numEq, numEq>;
+using Matrix = Dune::BCRSMatrix<Block>;
+using Vector = Dune::BlockVector<Dune::FieldVector<Scalar, numEq>>;
+
+void benchmarkThreadScaling(const Matrix& A, bool diagonalOnly)
+{
+    Vector d(A.N());
+    Vector v(A.N());
+    d = 1.0;
+
+    int maxThreads = 1;
+#ifdef _OPENMP
+    maxThreads = omp_get_max_threads();
+#endif
+
+    for (int numThreads = 1; numThreads <= maxThreads; numThreads *= 2) {
+#ifdef _OPENMP
+        omp_set_num_threads(numThreads);
+#endif
+        Opm::Linear::BlockIlu0<Matrix, Vector, Vector> prec(A, /*relaxation=*/1.0, diagonalOnly);
+
+        const int numApplications = 20;
+        const auto startTime = std::chrono::steady_clock::now();
+        for (int i = 0; i < numApplications; ++i)
+            prec.apply(v, d);
+        const std::chrono::duration<double> duration = std::chrono::steady_clock::now() - startTime;
+
+        std::cout << (diagonalOnly ? "DILU" : "block ILU(0)")
+                  << ", " << numThreads << " thread(s): "
+                  << duration.count()/numApplications*1e3 << " ms per application ("
+                  << prec.numLevels().first << " levels)\n";
+    }
+#ifdef _OPENMP
+    omp_set_num_threads(maxThreads);
+#endif
+}
+
+int main(int argc, char **argv)
+{
+    // initialize MPI, finalize is done automatically on exit
+    Dune::MPIHelper::instance(argc, argv);
+
+    const unsigned nx = (argc > 1) ? std::atoi(argv[1]) : 500;
+    const unsigned ny = (argc > 2) ? std::atoi(argv[2]) : nx;
+
+    const Matrix A = createStructuredTpfaMatrix<Matrix>(nx, ny, /*diagonalShift=*/8.0);
+    benchmarkThreadScaling(A, /*diagonalOnly=*/false);
+    benchmarkThreadScaling(A, /*diagonalOnly=*/true);
+
+    return 0;
+}
@@ -0,0 +1,87 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \brief Compares the memory bandwidth of arrays which were initialized by a single
+ *        thread with the one of arrays which were allocated by the FirstTouchAllocator.
+ *
+ * This program is only compiled, but it is not run by the test suite. It runs a
+ * STREAM-like triad on both kinds of arrays. On machines with more than one NUMA
+ * domain, the arrays of the FirstTouchAllocator should exhibit a considerably higher
+ * bandwidth if the threads are pinned, e.g.
+ * \code
+ * OMP_PROC_BIND=true ./bin/benchmark_firsttouchallocator 23
+ * \endcode
+ * where the optional argument is the binary logarithm of the size of the arrays.
+ */
+#include "config.h"
+
+#include <opm/models/utils/firsttouchallocator.hh>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+// return the best bandwidth of a number of STREAM triads a = b + s*c in GB/s
+template <class Vector>
+double triadBandwidth(Vector& a, const Vector& b, const Vector& c)
+{
+    const long n = static_cast<long>(a.size());
+    const double scalar = 3.0;
+    const int numRepetitions = 10;
+
+    double bestTime = 1e100;
+    for (int rep = 0; rep < numRepetitions; ++rep) {
+        const auto start = std::chrono::steady_clock::now();
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+        for (long i = 0; i < n; ++i)
+            a[i] = b[i] + scalar*c[i];
+        const std::chrono::duration<double> dt = std::chrono::steady_clock::now() - start;
+        bestTime = std::min(bestTime, dt.count());
+    }
+
+    return 3.0*sizeof(double)*n/bestTime/1e9;
+}
+
+int main(int argc, char **argv)
+{
+    const int log2Size = (argc > 1) ? std::atoi(argv[1]) : 23;
+    const std::size_t n = std::size_t(1) << log2Size;
+
+    // the arrays of the serial variant are placed by the thread which fills them
+    std::vector<double> aSerial(n, 0.0), bSerial(n, 1.0), cSerial(n, 2.0);
+    std::vector<double, Opm::FirstTouchAllocator<double>> a(n, 0.0), b(n, 1.0), c(n, 2.0);
+
+    std::cout << "3 arrays of " << n << " doubles\n"
+              << "triad bandwidth, serial first touch: "
+              << triadBandwidth(aSerial, bSerial, cSerial) << " GB/s\n"
+              << "triad bandwidth, parallel first touch: "
+              << triadBandwidth(a, b, c) << " GB/s\n";
+
+    return 0;
+}
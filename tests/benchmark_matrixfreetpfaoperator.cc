@@ -0,0 +1,120 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \brief Compares the throughput of the matrix-free TPFA operator with the one of
+ *        the sparse matrix-vector product of the equivalent BCRS matrix.
+ *
+ * This program is only compiled, but it is not run by the test suite. The size of the
+ * grid of the test matrix can be specified on the command line, e.g.
+ * \code
+ * OMP_NUM_THREADS=1 ./bin/benchmark_matrixfreetpfaoperator 1000 1000
+ * \endcode
+ * The reported bandwidth only accounts for the blocks and the column indices of the
+ * matrix and for the vectors, i.e., it is a lower bound of the actual memory traffic.
+ */
+#include "config.h"
+
+#include "structuredtpfamatrix.hh"
+
+#include <opm/simulators/linalg/matrixblock.hh>
+#include <opm/simulators/linalg/matrixfreetpfaoperator.hh>
+
+#include <dune/common/fvector.hh>
+#include <dune/common/parallel/mpihelper.hh>
+#include <dune/istl/bcrsmatrix.hh>
+#include <dune/istl/bvector.hh>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+
+constexpr int numEq = 3;
+using Scalar = double;
+using Block = Opm::MatrixBlock<Scalar, numEq, numEq>;
+using Matrix = Dune::BCRSMatrix<Block>;
+using Vector = Dune::BlockVector<Dune::FieldVector<Scalar, numEq>>;
+using Operator = Opm::Linear::MatrixFreeTpfaOperator<Block, Vector>;
+
+// apply a matrix-vector product repeatedly and report the time per application and
+// the bandwidth which corresponds to the given number of bytes per application
+template <class ApplyFn>
+double benchmark(const char* name, std::size_t numBytes, ApplyFn&& applyFn)
+{
+    // warm up the caches and the page tables
+    applyFn();
+
+    const int numApplications = 20;
+    const auto startTime = std::chrono::steady_clock::now();
+    for (int i = 0; i < numApplications; ++i)
+        applyFn();
+    const std::chrono::duration<double> duration = std::chrono::steady_clock::now() - startTime;
+
+    const double secondsPerApplication = duration.count()/numApplications;
+    std::cout << name << ": " << secondsPerApplication*1e3 << " ms per application ("
+              << numBytes/secondsPerApplication/1e9 << " GB/s)\n";
+    return secondsPerApplication;
+}
+
+int main(int argc, char **argv)
+{
+    // initialize MPI, finalize is done automatically on exit
+    Dune::MPIHelper::instance(argc, argv);
+
+    const unsigned nx = (argc > 1) ? std::atoi(argv[1]) : 1000;
+    const unsigned ny = (argc > 2) ? std::atoi(argv[2]) : nx;
+
+    const Matrix A = createStructuredTpfaMatrix<Matrix>(nx, ny, /*diagonalShift=*/6.0);
+    const Operator op = createTpfaOperator<Operator>(A);
+
+    Vector x(A.N());
+    for (unsigned i = 0; i < x.size(); ++i)
+        for (int a = 0; a < numEq; ++a)
+            x[i][a] = 1.0 + 0.1*a;
+    Vector yMatrix(A.N());
+    Vector yOperator(A.N());
+
+    const std::size_t vectorBytes = 2*A.N()*sizeof(Vector::block_type);
+    const std::size_t matrixBytes =
+        A.nonzeroes()*(sizeof(Block) + sizeof(std::size_t)) + A.N()*sizeof(std::size_t);
+    const std::size_t operatorBytes =
+        (op.numRows() + op.numFaces())*sizeof(Block)
+        + op.numFaces()*sizeof(unsigned) + op.numRows()*sizeof(unsigned);
+
+    std::cout << A.N() << " rows, " << op.numFaces() << " faces, "
+              << numEq << "x" << numEq << " blocks\n";
+    const double matrixTime = benchmark("BCRS matrix", matrixBytes + vectorBytes,
+                                        [&]() { A.mv(x, yMatrix); });
+    const double operatorTime = benchmark("matrix-free operator", operatorBytes + vectorBytes,
+                                          [&]() { op.apply(x, yOperator); });
+    std::cout << "speedup of the matrix-free operator: " << matrixTime/operatorTime << "\n";
+
+    yOperator -= yMatrix;
+    if (yOperator.two_norm() > 1e-12*yMatrix.two_norm()) {
+        std::cerr << "The results of the matrix-free operator and the BCRS matrix differ\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,51 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Test for the reservoir problem using the black-oil model, the ECFV discretization
+ *        and the Newton method which is preconditioned by a non-linear domain
+ *        decomposition.
+ */
+#include "config.h"
+
+#include "reservoir_blackoil_ecfv.hh"
+
+#include <opm/models/utils/start.hh>
+#include <opm/models/nonlinear/nlddnewtonmethod.hh>
+
+namespace Opm::Properties {
+
+// Solve the subdomains of each process individually before each global Newton
+// iteration
+template<class TypeTag>
+struct NewtonMethod<TypeTag, TTag::ReservoirBlackOilEcfvProblem>
+{ using type = Opm::NlddNewtonMethod<TypeTag, Opm::BlackOilNewtonMethod<TypeTag>>; };
+
+} // namespace Opm::Properties
+
+int main(int argc, char **argv)
+{
+    using ProblemTypeTag = Opm::Properties::TTag::ReservoirBlackOilEcfvProblem;
+    return Opm::start<ProblemTypeTag>(argc, argv);
+}
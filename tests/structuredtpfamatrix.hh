@@ -0,0 +1,112 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \brief Creates the block matrices and operators which are used by the tests of
+ *        the linear solver components.
+ */
+#ifndef EWOMS_STRUCTURED_TPFA_MATRIX_HH
+#define EWOMS_STRUCTURED_TPFA_MATRIX_HH
+
+#include <cmath>
+#include <vector>
+
+/*!
+ * \brief Assemble a non-symmetric matrix with the sparsity pattern of a two-point
+ *        flux discretization on a structured 2D grid.
+ *
+ * The diagonal entries of the diagonal blocks are diagonalShift plus the index of the
+ * equation, the off-diagonal blocks are dominated by their diagonal entries of about
+ * -1. The larger diagonalShift, the more diagonally dominant the matrix.
+ */
+template <class Matrix>
+Matrix createStructuredTpfaMatrix(unsigned nx,
+                                  unsigned ny,
+                                  typename Matrix::field_type diagonalShift)
+{
+    constexpr int numEq = Matrix::block_type::rows;
+
+    const unsigned n = nx*ny;
+    Matrix A(n, n, 5*n, Matrix::row_wise);
+    for (auto rowIt = A.createbegin(); rowIt != A.createend(); ++rowIt) {
+        const unsigned i = rowIt.index() % nx;
+        const unsigned j = rowIt.index() / nx;
+        if (j > 0)
+            rowIt.insert(rowIt.index() - nx);
+        if (i > 0)
+            rowIt.insert(rowIt.index() - 1);
+        rowIt.insert(rowIt.index());
+        if (i + 1 < nx)
+            rowIt.insert(rowIt.index() + 1);
+        if (j + 1 < ny)
+            rowIt.insert(rowIt.index() + nx);
+    }
+
+    for (unsigned rowIdx = 0; rowIdx < n; ++rowIdx) {
+        for (auto colIt = A[rowIdx].begin(); colIt != A[rowIdx].end(); ++colIt) {
+            for (int a = 0; a < numEq; ++a) {
+                for (int b = 0; b < numEq; ++b) {
+                    if (colIt.index() == rowIdx)
+                        (*colIt)[a][b] = (a == b) ? diagonalShift + a : 0.5*std::sin(rowIdx + a - b);
+                    else
+                        (*colIt)[a][b] = (a == b) ? -1.0 - 0.1*(colIt.index() > rowIdx) : 0.1*std::cos(rowIdx + a*b);
+                }
+            }
+        }
+    }
+
+    return A;
+}
+
+/*!
+ * \brief Store the blocks of a matrix in a matrix-free TPFA operator.
+ *
+ * The faces of a row are the off-diagonal blocks of the row.
+ */
+template <class Operator, class Matrix>
+Operator createTpfaOperator(const Matrix& A)
+{
+    std::vector<unsigned> rowSizes(A.N());
+    for (unsigned rowIdx = 0; rowIdx < A.N(); ++rowIdx)
+        rowSizes[rowIdx] = A[rowIdx].size() - 1;
+
+    Operator op;
+    op.reserve(rowSizes.begin(), rowSizes.end());
+    for (unsigned rowIdx = 0; rowIdx < A.N(); ++rowIdx) {
+        unsigned faceIdx = op.rowBegin(rowIdx);
+        for (auto colIt = A[rowIdx].begin(); colIt != A[rowIdx].end(); ++colIt) {
+            if (colIt.index() == rowIdx) {
+                op.diagonal(rowIdx) = *colIt;
+                continue;
+            }
+
+            op.setNeighbor(faceIdx, colIt.index());
+            op.offDiagonal(faceIdx) = *colIt;
+            ++faceIdx;
+        }
+    }
+
+    return op;
+}
+
+#endif // EWOMS_STRUCTURED_TPFA_MATRIX_HH
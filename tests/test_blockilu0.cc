@@ -0,0 +1,186 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \brief A test for the block ILU(0) and DILU preconditioners.
+ *
+ * This checks that the level-scheduled preconditioners produce the same result as
+ * their sequential counterparts.
+ */
+#include "config.h"
+
+#include "structuredtpfamatrix.hh"
+
+#include <opm/simulators/linalg/blockilu0.hh>
+#include <opm/simulators/linalg/matrixblock.hh>
+#include <opm/simulators/linalg/ilufirstelement.hh> //definitions needed in next header
+
+#include <dune/common/fvector.hh>
+#include <dune/common/parallel/mpihelper.hh>
+#include <dune/istl/bcrsmatrix.hh>
+#include <dune/istl/bvector.hh>
+#include <dune/istl/operators.hh>
+#include <dune/istl/preconditioners.hh>
+#include <dune/istl/solvers.hh>
+
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+constexpr int numEq = 3;
+using Scalar = double;
+using Block = Opm::MatrixBlock<Scalar, numEq, numEq>;
+using Matrix = Dune::BCRSMatrix<Block>;
+using Vector = Dune::BlockVector<Dune::FieldVector<Scalar, numEq>>;
+
+void testBlockInversion()
+{
+    Opm::MatrixBlock<Scalar, 2, 2> A2;
+    A2[0][0] = 4.0; A2[0][1] = 1.0;
+    A2[1][0] = 2.0; A2[1][1] = 3.0;
+
+    Opm::MatrixBlock<Scalar, 3, 3> A3;
+    for (int a = 0; a < 3; ++a)
+        for (int b = 0; b < 3; ++b)
+            A3[a][b] = (a == b) ? 5.0 : 1.0 + a - 0.5*b;
+
+    auto checkInverse = [](const auto& A) {
+        auto Ainv = A;
+        Ainv.invert();
+        auto product = A;
+        product.rightmultiply(Ainv);
+        for (unsigned a = 0; a < A.rows(); ++a)
+            for (unsigned b = 0; b < A.cols(); ++b)
+                if (std::abs(product[a][b] - (a == b ? 1.0 : 0.0)) > 1e-12)
+                    throw std::logic_error("Inverse of a matrix block is incorrect");
+    };
+
+    checkInverse(A2);
+    checkInverse(A3);
+}
+
+void testIlu0(const Matrix& A)
+{
+    Vector d(A.N());
+    for (unsigned i = 0; i < d.size(); ++i)
+        for (int a = 0; a < numEq; ++a)
+            d[i][a] = std::sin(0.1*i + a);
+
+    Vector v1(A.N());
+    Vector v2(A.N());
+
+    Dune::SeqILU<Matrix, Vector, Vector> istlIlu(A, /*relaxation=*/1.0);
+    istlIlu.apply(v1, d);
+
+    Opm::Linear::BlockIlu0<Matrix, Vector, Vector> blockIlu(A, /*relaxation=*/1.0);
+    blockIlu.apply(v2, d);
+
+    v2 -= v1;
+    if (v2.two_norm() > 1e-10*v1.two_norm())
+        throw std::logic_error("The block ILU(0) preconditioner differs from Dune::SeqILU");
+}
+
+// compare the DILU preconditioner with a straightforward sequential implementation
+void testDilu(const Matrix& A)
+{
+    Vector d(A.N());
+    for (unsigned i = 0; i < d.size(); ++i)
+        for (int a = 0; a < numEq; ++a)
+            d[i][a] = std::cos(0.2*i - a);
+
+    // D_ii = A_ii - sum_{k < i} A_ik D_kk^-1 A_ki
+    std::vector<Block> diagInv(A.N());
+    for (unsigned i = 0; i < A.N(); ++i) {
+        Block diag(A[i][i]);
+        for (auto colIt = A[i].begin(); colIt.index() < i; ++colIt) {
+            const unsigned k = colIt.index();
+            if (!A.exists(k, i))
+                continue;
+            Block tmp(*colIt);
+            tmp.rightmultiply(diagInv[k]);
+            tmp.rightmultiply(A[k][i]);
+            diag -= tmp;
+        }
+        diag.invert();
+        diagInv[i] = diag;
+    }
+
+    // solve (L + D) D^-1 (D + U) v1 = d
+    Vector v1(A.N());
+    for (unsigned i = 0; i < A.N(); ++i) {
+        auto rhs = d[i];
+        for (auto colIt = A[i].begin(); colIt.index() < i; ++colIt)
+            colIt->mmv(v1[colIt.index()], rhs);
+        diagInv[i].mv(rhs, v1[i]);
+    }
+    for (unsigned i = A.N(); i-- > 0;) {
+        Vector::block_type upperSum(0.0);
+        for (auto colIt = A[i].begin(); colIt != A[i].end(); ++colIt)
+            if (colIt.index() > i)
+                colIt->umv(v1[colIt.index()], upperSum);
+        diagInv[i].mmv(upperSum, v1[i]);
+    }
+
+    Vector v2(A.N());
+    Opm::Linear::BlockIlu0<Matrix, Vector, Vector> dilu(A, /*relaxation=*/1.0, /*diagonalOnly=*/true);
+    dilu.apply(v2, d);
+
+    v2 -= v1;
+    if (v2.two_norm() > 1e-10*v1.two_norm())
+        throw std::logic_error("The DILU preconditioner differs from the sequential reference");
+}
+
+void testSolve(const Matrix& A, bool diagonalOnly)
+{
+    Vector x(A.N());
+    Vector b(A.N());
+    b = 1.0;
+    x = 0.0;
+
+    Dune::MatrixAdapter<Matrix, Vector, Vector> op(A);
+    Opm::Linear::BlockIlu0<Matrix, Vector, Vector> prec(A, /*relaxation=*/1.0, diagonalOnly);
+    Dune::BiCGSTABSolver<Vector> solver(op, prec, /*reduction=*/1e-10, /*maxIter=*/500, /*verbose=*/0);
+
+    Dune::InverseOperatorResult result;
+    solver.apply(x, b, result);
+    if (!result.converged)
+        throw std::logic_error(std::string("BiCGSTAB did not converge using the ")
+                               + (diagonalOnly ? "DILU" : "block ILU(0)") + " preconditioner");
+}
+
+int main(int argc, char **argv)
+{
+    // initialize MPI, finalize is done automatically on exit
+    Dune::MPIHelper::instance(argc, argv);
+
+    testBlockInversion();
+
+    const Matrix smallMatrix = createStructuredTpfaMatrix<Matrix>(20, 15, /*diagonalShift=*/8.0);
+    testIlu0(smallMatrix);
+    testDilu(smallMatrix);
+    testSolve(smallMatrix, /*diagonalOnly=*/false);
+    testSolve(smallMatrix, /*diagonalOnly=*/true);
+
+    return 0;
+}
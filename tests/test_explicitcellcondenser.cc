@@ -0,0 +1,183 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \brief A test for the condensation of the explicit cells of the adaptive implicit
+ *        mode.
+ *
+ * If the equations of the implicit cells do not depend on the condensed unknowns of
+ * the explicit cells, condensing the explicit cells must not change the solution of
+ * the linear system. Otherwise, these derivatives must be dropped.
+ */
+#include "config.h"
+
+#include "structuredtpfamatrix.hh"
+
+#include <opm/simulators/linalg/blockilu0.hh>
+#include <opm/simulators/linalg/explicitcellcondenser.hh>
+#include <opm/simulators/linalg/matrixblock.hh>
+#include <opm/simulators/linalg/ilufirstelement.hh> //definitions needed in next header
+
+#include <dune/common/fvector.hh>
+#include <dune/common/parallel/mpihelper.hh>
+#include <dune/istl/bcrsmatrix.hh>
+#include <dune/istl/bvector.hh>
+#include <dune/istl/operators.hh>
+#include <dune/istl/solvers.hh>
+
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+constexpr int numEq = 3;
+constexpr unsigned pressureIdx = 1;
+using Scalar = double;
+using Block = Opm::MatrixBlock<Scalar, numEq, numEq>;
+using Matrix = Dune::BCRSMatrix<Block>;
+using Vector = Dune::BlockVector<Dune::FieldVector<Scalar, numEq>>;
+using Condenser = Opm::Linear::ExplicitCellCondenser<Matrix, Vector>;
+
+std::vector<unsigned> explicitCells(const Matrix& A)
+{
+    std::vector<unsigned> cells;
+    for (unsigned rowIdx = 0; rowIdx < A.N(); rowIdx += 3)
+        cells.push_back(rowIdx);
+    return cells;
+}
+
+// remove the derivatives of the other cells' equations with regard to the condensed
+// unknowns of the explicit cells
+void dropExplicitDerivatives(Matrix& A, const std::vector<unsigned>& cells)
+{
+    for (unsigned rowIdx = 0; rowIdx < A.N(); ++rowIdx) {
+        for (auto colIt = A[rowIdx].begin(); colIt != A[rowIdx].end(); ++colIt) {
+            if (colIt.index() == rowIdx || colIt.index() % 3 != 0)
+                continue;
+            for (int a = 0; a < numEq; ++a)
+                for (int b = 0; b < numEq; ++b)
+                    if (b != static_cast<int>(pressureIdx))
+                        (*colIt)[a][b] = 0.0;
+        }
+    }
+}
+
+Vector solve(const Matrix& A, const Vector& b)
+{
+    Vector x(A.N());
+    x = 0.0;
+    Vector rhs(b);
+
+    Dune::MatrixAdapter<Matrix, Vector, Vector> op(A);
+    Opm::Linear::BlockIlu0<Matrix, Vector, Vector> prec(A, /*relaxation=*/1.0);
+    Dune::BiCGSTABSolver<Vector> solver(op, prec, /*reduction=*/1e-14, /*maxIter=*/1000, /*verbose=*/0);
+
+    Dune::InverseOperatorResult result;
+    solver.apply(x, rhs, result);
+    if (!result.converged)
+        throw std::logic_error("BiCGSTAB did not converge");
+
+    return x;
+}
+
+Vector createRhs(std::size_t n)
+{
+    Vector b(n);
+    for (unsigned i = 0; i < n; ++i)
+        for (int a = 0; a < numEq; ++a)
+            b[i][a] = std::cos(0.7*i + a);
+    return b;
+}
+
+void testSolution(const Matrix& A)
+{
+    const auto cells = explicitCells(A);
+    Matrix fullMatrix(A);
+    dropExplicitDerivatives(fullMatrix, cells);
+
+    const Vector b = createRhs(A.N());
+    const Vector reference = solve(fullMatrix, b);
+
+    Matrix condensedMatrix(fullMatrix);
+    Condenser condenser;
+    condenser.condense(condensedMatrix, cells, pressureIdx);
+    if (condenser.numExplicitCells() != cells.size())
+        throw std::logic_error("Wrong number of explicit cells");
+
+    // the condensed unknowns of an explicit cell only depend on the cell itself
+    for (unsigned globI : cells) {
+        for (auto colIt = condensedMatrix[globI].begin(); colIt != condensedMatrix[globI].end(); ++colIt) {
+            if (colIt.index() == globI)
+                continue;
+            Block invDiag(condensedMatrix[globI][globI]);
+            invDiag.invert();
+            Block scaled(invDiag);
+            scaled.rightmultiply(*colIt);
+            for (int a = 0; a < numEq; ++a)
+                for (int c = 0; c < numEq; ++c)
+                    if (a != static_cast<int>(pressureIdx) && std::abs(scaled[a][c]) > 1e-12)
+                        throw std::logic_error("The condensed unknowns are still coupled to the neighbors");
+        }
+    }
+
+    Vector x = solve(condensedMatrix, b);
+    condenser.expand(x);
+
+    x -= reference;
+    if (x.two_norm() > 1e-8*reference.two_norm())
+        throw std::logic_error("Condensing the explicit cells changed the solution");
+}
+
+void testDroppedDerivatives(const Matrix& A)
+{
+    const auto cells = explicitCells(A);
+    Matrix condensedMatrix(A);
+    Condenser condenser;
+    condenser.condense(condensedMatrix, cells, pressureIdx);
+
+    Matrix expected(A);
+    dropExplicitDerivatives(expected, cells);
+    for (unsigned rowIdx = 0; rowIdx < A.N(); ++rowIdx) {
+        if (rowIdx % 3 == 0)
+            continue;
+
+        for (auto colIt = condensedMatrix[rowIdx].begin(); colIt != condensedMatrix[rowIdx].end(); ++colIt) {
+            Block diff(*colIt);
+            diff -= expected[rowIdx][colIt.index()];
+            if (diff.frobenius_norm() > 0.0)
+                throw std::logic_error("The derivatives with regard to the condensed unknowns "
+                                       "have not been dropped");
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    // initialize MPI, finalize is done automatically on exit
+    Dune::MPIHelper::instance(argc, argv);
+
+    const Matrix A = createStructuredTpfaMatrix<Matrix>(20, 15, /*diagonalShift=*/8.0);
+    testSolution(A);
+    testDroppedDerivatives(A);
+
+    return 0;
+}
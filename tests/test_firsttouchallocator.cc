@@ -0,0 +1,110 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \brief Tests the allocator which places memory pages using parallel first touch.
+ */
+#include "config.h"
+
+#include <opm/models/utils/firsttouchallocator.hh>
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+struct alignas(64) CacheLine
+{
+    double value[8];
+};
+
+template <class T, std::size_t Alignment>
+using FirstTouchVector = std::vector<T, Opm::FirstTouchAllocator<T, Alignment>>;
+
+// check the blocks directly below and at the size above which the pages are
+// obtained from the operating system and touched in parallel
+template <class T, std::size_t Alignment = alignof(T)>
+std::vector<std::size_t> thresholdSizes()
+{
+    const std::size_t n = Opm::FirstTouchAllocator<T, Alignment>::minFirstTouchSize/sizeof(T);
+    return {1, n - 1, n, n + 1};
+}
+
+void testValueInitialization()
+{
+    for (std::size_t n : thresholdSizes<double>()) {
+        FirstTouchVector<double, alignof(double)> v(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            if (v[i] != 0.0)
+                throw std::logic_error("FirstTouchAllocator: vector not initialized");
+            v[i] = static_cast<double>(i);
+        }
+
+        auto w = v;
+        if (w != v)
+            throw std::logic_error("FirstTouchAllocator: copy differs from original");
+    }
+}
+
+void testFillValue()
+{
+    for (std::size_t n : thresholdSizes<double>()) {
+        FirstTouchVector<double, alignof(double)> v(n, 3.5);
+        for (std::size_t i = 0; i < n; ++i)
+            if (v[i] != 3.5)
+                throw std::logic_error("FirstTouchAllocator: wrong fill value");
+    }
+}
+
+template <class T, std::size_t Alignment>
+void testAlignment()
+{
+    for (std::size_t n : thresholdSizes<T, Alignment>()) {
+        FirstTouchVector<T, Alignment> v(n);
+        if (reinterpret_cast<std::uintptr_t>(v.data()) % Alignment != 0)
+            throw std::logic_error("FirstTouchAllocator: wrong alignment");
+    }
+}
+
+void testFirstTouch()
+{
+    // firstTouch() must only write zeros, also if the block does not end at a
+    // page boundary
+    std::vector<unsigned char> buf(3*4096 + 17, 0);
+    Opm::firstTouch(buf.data(), buf.size());
+    for (unsigned char c : buf)
+        if (c != 0)
+            throw std::logic_error("firstTouch() modified the contents of a zeroed block");
+}
+
+int main()
+{
+    testValueInitialization();
+    testFillValue();
+    testAlignment<double, alignof(double)>();
+    testAlignment<double, 64>();
+    testAlignment<CacheLine, alignof(CacheLine)>();
+    testFirstTouch();
+
+    return 0;
+}
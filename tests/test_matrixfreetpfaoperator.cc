@@ -0,0 +1,169 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \brief A test for the matrix-free Jacobian operator of the TPFA linearizer.
+ *
+ * This checks that the operator produces the same results as the equivalent BCRS
+ * matrix and that the overlapping linear solver converges if the Krylov iterations
+ * apply the operator while the preconditioner only uses the diagonal blocks.
+ */
+#include "config.h"
+
+#include "structuredtpfamatrix.hh"
+
+#include <opm/simulators/linalg/blockilu0.hh>
+#include <opm/simulators/linalg/matrixblock.hh>
+#include <opm/simulators/linalg/matrixfreetpfaoperator.hh>
+#include <opm/simulators/linalg/overlappingbcrsmatrix.hh>
+#include <opm/simulators/linalg/overlappingblockvector.hh>
+#include <opm/simulators/linalg/overlappingoperator.hh>
+#include <opm/simulators/linalg/overlappingpreconditioner.hh>
+#include <opm/simulators/linalg/overlappingscalarproduct.hh>
+
+#include <dune/common/fvector.hh>
+#include <dune/common/parallel/mpihelper.hh>
+#include <dune/istl/bcrsmatrix.hh>
+#include <dune/istl/bvector.hh>
+#include <dune/istl/solvers.hh>
+
+#include <cmath>
+#include <stdexcept>
+
+constexpr int numEq = 2;
+using Scalar = double;
+using Block = Opm::MatrixBlock<Scalar, numEq, numEq>;
+using Matrix = Dune::BCRSMatrix<Block>;
+using Vector = Dune::BlockVector<Dune::FieldVector<Scalar, numEq>>;
+using Operator = Opm::Linear::MatrixFreeTpfaOperator<Block, Vector>;
+
+using OverlappingMatrix = Opm::Linear::OverlappingBCRSMatrix<Matrix>;
+using Overlap = OverlappingMatrix::Overlap;
+using OverlappingVector = Opm::Linear::OverlappingBlockVector<Vector::block_type, Overlap>;
+
+Vector createVector(std::size_t n)
+{
+    Vector x(n);
+    for (unsigned i = 0; i < n; ++i)
+        for (int a = 0; a < numEq; ++a)
+            x[i][a] = std::sin(0.3*i + a);
+    return x;
+}
+
+void testApply(const Matrix& A, const Operator& op)
+{
+    const Vector x = createVector(A.N());
+
+    Vector y1(A.N());
+    Vector y2(A.N());
+    A.mv(x, y1);
+    op.apply(x, y2);
+    y2 -= y1;
+    if (y2.two_norm() > 1e-12*y1.two_norm())
+        throw std::logic_error("Applying the matrix-free operator differs from the matrix");
+
+    y1 = 1.0;
+    y2 = 1.0;
+    A.usmv(-0.5, x, y1);
+    op.applyscaleadd(-0.5, x, y2);
+    y2 -= y1;
+    if (y2.two_norm() > 1e-12*y1.two_norm())
+        throw std::logic_error("The scaled application of the matrix-free operator "
+                               "differs from the matrix");
+}
+
+// solve the system using the matrix-free operator for the Krylov iterations and a
+// preconditioner which only knows the diagonal blocks of the matrix, i.e., the way the
+// overlapping linear solver backends solve matrix-free linearizations
+void testOverlappingSolve(const Matrix& A, const Operator& op)
+{
+    Matrix diagonal(A.N(), A.N(), A.N(), Matrix::row_wise);
+    for (auto rowIt = diagonal.createbegin(); rowIt != diagonal.createend(); ++rowIt)
+        rowIt.insert(rowIt.index());
+    for (unsigned rowIdx = 0; rowIdx < A.N(); ++rowIdx)
+        diagonal[rowIdx][rowIdx] = A[rowIdx][rowIdx];
+
+    const OverlappingMatrix overlappingDiagonal(diagonal,
+                                                Opm::Linear::BorderList(),
+                                                Opm::Linear::BlackList(),
+                                                /*overlapSize=*/0);
+    const Overlap& overlap = overlappingDiagonal.overlap();
+
+    using MatrixFreeOperator = Opm::Linear::OverlappingMatrixFreeOperator<Vector, OverlappingVector, Overlap>;
+    using ParallelOperator = Opm::Linear::OverlappingOperator<OverlappingMatrix, OverlappingVector, OverlappingVector>;
+    MatrixFreeOperator matrixFreeOp(op, overlap);
+    ParallelOperator parOperator(overlappingDiagonal, &matrixFreeOp);
+
+    // the overlapping operator must apply the full operator, not the diagonal matrix
+    const Vector x = createVector(A.N());
+    OverlappingVector overlappingX(overlap);
+    OverlappingVector overlappingY(overlap);
+    overlappingX.assign(x);
+    parOperator.apply(overlappingX, overlappingY);
+    Vector y1(A.N());
+    Vector y2(A.N());
+    A.mv(x, y1);
+    overlappingY.assignTo(y2);
+    y2 -= y1;
+    if (y2.two_norm() > 1e-12*y1.two_norm())
+        throw std::logic_error("The overlapping operator does not apply the matrix-free operator");
+
+    using SeqPreconditioner = Opm::Linear::BlockIlu0<OverlappingMatrix, OverlappingVector, OverlappingVector>;
+    SeqPreconditioner seqPrec(overlappingDiagonal, /*relaxation=*/1.0, /*diagonalOnly=*/false);
+    Opm::Linear::OverlappingPreconditioner<SeqPreconditioner, Overlap> parPrec(seqPrec, overlap);
+    Opm::Linear::OverlappingScalarProduct<OverlappingVector, Overlap> parScalarProduct(overlap);
+    Dune::BiCGSTABSolver<OverlappingVector> solver(parOperator, parScalarProduct, parPrec,
+                                                   /*reduction=*/1e-10, /*maxIter=*/500,
+                                                   /*verbose=*/0);
+
+    Vector b(A.N());
+    b = 1.0;
+    OverlappingVector overlappingB(overlap);
+    overlappingB.assign(b);
+    overlappingX = 0.0;
+    Dune::InverseOperatorResult result;
+    solver.apply(overlappingX, overlappingB, result);
+    if (!result.converged)
+        throw std::logic_error("BiCGSTAB did not converge using the matrix-free operator");
+
+    // check the residual using the assembled matrix
+    Vector solution(A.N());
+    overlappingX.assignTo(solution);
+    Vector resid(b);
+    A.mmv(solution, resid);
+    if (resid.two_norm() > 1e-8*b.two_norm())
+        throw std::logic_error("The solution of the matrix-free linear solve is incorrect");
+}
+
+int main(int argc, char **argv)
+{
+    // initialize MPI, finalize is done automatically on exit
+    Dune::MPIHelper::instance(argc, argv);
+
+    const Matrix A = createStructuredTpfaMatrix<Matrix>(20, 15, /*diagonalShift=*/6.0);
+    const Operator op = createTpfaOperator<Operator>(A);
+    testApply(A, op);
+    testOverlappingSolve(A, op);
+
+    return 0;
+}
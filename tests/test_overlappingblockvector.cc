@@ -0,0 +1,219 @@
+/*
+  Copyright 2020 Equinor ASA.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <config.h>
+
+#include <opm/models/parallel/mpiutil.hh>
+/*!
+ * \file
+ * \brief A parallel test for the synchronization of overlapping block vectors.
+ *
+ * Each process owns a chain of rows whose first row is the same entity as the
+ * last row of the previous process. This checks that sync() assigns the values of
+ * the master process and that syncAdd() adds up the values of all processes,
+ * including repeated synchronizations of several vectors which share an overlap.
+ */
+#include "config.h"
+
+#include <opm/simulators/linalg/blacklist.hh>
+#include <opm/simulators/linalg/matrixblock.hh>
+#include <opm/simulators/linalg/overlappingbcrsmatrix.hh>
+#include <opm/simulators/linalg/overlappingblockvector.hh>
+#include <opm/simulators/linalg/overlaptypes.hh>
+
+#include <dune/common/fvector.hh>
+#include <dune/common/parallel/mpihelper.hh>
+#include <dune/istl/bcrsmatrix.hh>
+#include <dune/istl/bvector.hh>
+
+#include <cstdlib>
+#include <iostream>
+
+constexpr int numEq = 2;
+constexpr unsigned numRows = 6;
+constexpr unsigned overlapSize = 2;
+
+using Scalar = double;
+using Block = Opm::MatrixBlock<Scalar, numEq, numEq>;
+using Matrix = Dune::BCRSMatrix<Block>;
+using FieldVector = Dune::FieldVector<Scalar, numEq>;
+
+using OverlappingMatrix = Opm::Linear::OverlappingBCRSMatrix<Matrix>;
+using Overlap = OverlappingMatrix::Overlap;
+using OverlappingVector = Opm::Linear::OverlappingBlockVector<FieldVector, Overlap>;
+
+// the local rows of a process form a chain, i.e. the matrix is tridiagonal
+Matrix createMatrix()
+{
+    Matrix A(numRows, numRows, 3*numRows, Matrix::row_wise);
+    for (auto rowIt = A.createbegin(); rowIt != A.createend(); ++rowIt) {
+        if (rowIt.index() > 0)
+            rowIt.insert(rowIt.index() - 1);
+        rowIt.insert(rowIt.index());
+        if (rowIt.index() + 1 < numRows)
+            rowIt.insert(rowIt.index() + 1);
+    }
+    A = 1.0;
+
+    return A;
+}
+
+// the first row of a process is the last row of the previous one
+Opm::Linear::BorderList createBorderList(int size, int rank)
+{
+    Opm::Linear::BorderList borderList;
+    if (rank > 0)
+        borderList.push_back({/*localIdx=*/0, /*peerIdx=*/numRows - 1,
+                              /*peerRank=*/rank - 1, /*borderDistance=*/0});
+    if (rank + 1 < size)
+        borderList.push_back({/*localIdx=*/numRows - 1, /*peerIdx=*/0,
+                              /*peerRank=*/rank + 1, /*borderDistance=*/0});
+
+    return borderList;
+}
+
+FieldVector globalValue(const Overlap& overlap, unsigned domIdx, Scalar offset)
+{
+    FieldVector value;
+    const Scalar globalIdx = overlap.domesticToGlobal(static_cast<Opm::Linear::Index>(domIdx));
+    for (int eqIdx = 0; eqIdx < numEq; ++eqIdx)
+        value[eqIdx] = offset + 1.0 + globalIdx + 0.5*eqIdx;
+    return value;
+}
+
+// only the master processes know the values of the rows before the
+// synchronization
+bool testSync(const Overlap& overlap, OverlappingVector& x, Scalar offset)
+{
+    for (unsigned domIdx = 0; domIdx < x.size(); ++domIdx) {
+        if (overlap.iAmMasterOf(static_cast<Opm::Linear::Index>(domIdx)))
+            x[domIdx] = globalValue(overlap, domIdx, offset);
+        else
+            x[domIdx] = -1.0;
+    }
+
+    x.sync();
+
+    bool ok = true;
+    for (unsigned domIdx = 0; domIdx < x.size(); ++domIdx) {
+        const FieldVector expected = globalValue(overlap, domIdx, offset);
+        if (x[domIdx] != expected) {
+            std::cerr << "rank " << overlap.myRank() << ": sync() produced "
+                      << x[domIdx] << " instead of " << expected
+                      << " for domestic row " << domIdx << "\n";
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+// all processes which have a row in their local domain contribute one to it, so
+// after the synchronization each row contains the number of these processes
+bool testSyncAdd(const Overlap& overlap, OverlappingVector& x)
+{
+    for (unsigned domIdx = 0; domIdx < x.size(); ++domIdx)
+        x[domIdx] = overlap.isLocal(static_cast<Opm::Linear::Index>(domIdx)) ? 1.0 : 0.0;
+
+    x.syncAdd();
+
+    bool ok = true;
+    for (unsigned domIdx = 0; domIdx < x.size(); ++domIdx) {
+        const auto idx = static_cast<Opm::Linear::Index>(domIdx);
+        if (!overlap.isLocal(idx))
+            continue;
+
+        const Scalar expected = overlap.isBorder(idx) ? 2.0 : 1.0;
+        for (int eqIdx = 0; eqIdx < numEq; ++eqIdx) {
+            if (x[domIdx][eqIdx] != expected) {
+                std::cerr << "rank " << overlap.myRank() << ": syncAdd() produced "
+                          << x[domIdx][eqIdx] << " instead of " << expected
+                          << " for domestic row " << domIdx << "\n";
+                ok = false;
+            }
+        }
+    }
+
+    // the rows which are not local must have received the sums of the
+    // processes which have them in their local domain as well, i.e., the
+    // values must be the same as the ones of the master process
+    OverlappingVector y(x);
+    for (unsigned domIdx = 0; domIdx < y.size(); ++domIdx)
+        if (!overlap.iAmMasterOf(static_cast<Opm::Linear::Index>(domIdx)))
+            y[domIdx] = -1.0;
+    y.sync();
+    for (unsigned domIdx = 0; domIdx < x.size(); ++domIdx) {
+        if (x[domIdx] != y[domIdx] || x[domIdx][0] < 1.0) {
+            std::cerr << "rank " << overlap.myRank() << ": syncAdd() produced "
+                      << x[domIdx] << " for the overlap row " << domIdx
+                      << " but its master has " << y[domIdx] << "\n";
+            ok = false;
+        }
+    }
+
+    return ok;
+}
+
+int testMain(int size, int rank)
+{
+    const Matrix A = createMatrix();
+    const OverlappingMatrix overlapA(A,
+                                     createBorderList(size, rank),
+                                     Opm::Linear::BlackList(),
+                                     overlapSize);
+    const Overlap& overlap = overlapA.overlap();
+
+    bool ok = true;
+
+    // all vectors of the overlap share the exchange with the node-local peers
+    if (overlap.nodeExchange<FieldVector>() != overlap.nodeExchange<FieldVector>()) {
+        std::cerr << "rank " << overlap.myRank()
+                  << ": nodeExchange() did not reuse the existing exchange\n";
+        ok = false;
+    }
+
+    OverlappingVector x(overlap);
+    OverlappingVector z(overlap);
+
+    for (int i = 0; i < 3; ++i) {
+        ok = testSync(overlap, x, /*offset=*/i) && ok;
+        ok = testSync(overlap, z, /*offset=*/10.0 + i) && ok;
+        ok = testSyncAdd(overlap, z) && ok;
+        ok = testSyncAdd(overlap, x) && ok;
+    }
+
+    // a copy of a vector uses the same exchange and does not disturb the
+    // synchronization of the original vector
+    OverlappingVector w(x);
+    ok = testSync(overlap, w, /*offset=*/100.0) && ok;
+    ok = testSync(overlap, x, /*offset=*/200.0) && ok;
+    ok = testSyncAdd(overlap, w) && ok;
+
+    if (ok) {
+        return EXIT_SUCCESS;
+    } else {
+        return EXIT_FAILURE;
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    const auto& mpiHelper = Dune::MPIHelper::instance(argc, argv);
+    return testMain(mpiHelper.size(), mpiHelper.rank());
+}
@@ -0,0 +1,158 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \brief Tests the computation of the strongly connected components of a graph
+ *        and their ordering by dependencies.
+ */
+#include "config.h"
+
+#include <opm/models/utils/stronglyconnectedcomponents.hh>
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+using Edges = std::vector<std::pair<unsigned, unsigned>>;
+
+void createGraph(unsigned numVertices,
+                 const Edges& edges,
+                 std::vector<unsigned>& offsets,
+                 std::vector<unsigned>& targets)
+{
+    offsets.assign(numVertices + 1, 0);
+    for (const auto& [from, to] : edges)
+        ++offsets[from + 1];
+    for (unsigned v = 0; v < numVertices; ++v)
+        offsets[v + 1] += offsets[v];
+
+    targets.resize(edges.size());
+    std::vector<unsigned> pos(offsets.begin(), offsets.end() - 1);
+    for (const auto& [from, to] : edges)
+        targets[pos[from]++] = to;
+}
+
+// each component must come after the ones it depends on and must be on a higher
+// level than them
+void checkOrder(const Opm::StronglyConnectedComponents& scc,
+                const std::vector<unsigned>& offsets,
+                const std::vector<unsigned>& targets)
+{
+    const unsigned numVertices = static_cast<unsigned>(offsets.size() - 1);
+    for (unsigned v = 0; v < numVertices; ++v) {
+        const unsigned comp = scc.component(v);
+        for (unsigned edgeIdx = offsets[v]; edgeIdx < offsets[v + 1]; ++edgeIdx) {
+            const unsigned depComp = scc.component(targets[edgeIdx]);
+            if (depComp > comp)
+                throw std::logic_error("A component precedes one of its dependencies");
+            if (depComp != comp && scc.level(depComp) >= scc.level(comp))
+                throw std::logic_error("A component is not on a higher level than its dependencies");
+        }
+    }
+
+    std::vector<bool> seen(scc.numComponents(), false);
+    for (unsigned levelIdx = 0; levelIdx < scc.numLevels(); ++levelIdx) {
+        for (unsigned i = scc.levelBegin(levelIdx); i < scc.levelEnd(levelIdx); ++i) {
+            const unsigned comp = scc.componentsByLevel()[i];
+            if (scc.level(comp) != levelIdx || seen[comp])
+                throw std::logic_error("Wrong components of a level");
+            seen[comp] = true;
+        }
+    }
+    if (std::find(seen.begin(), seen.end(), false) != seen.end())
+        throw std::logic_error("A component is not on any level");
+}
+
+void testSmallGraph()
+{
+    // 1 depends on 0, 2 and 3 depend on each other and on 1, 4 depends on 3 and
+    // 5 does not have any dependencies
+    const Edges edges{{1, 0}, {2, 3}, {3, 2}, {2, 1}, {4, 3}};
+    std::vector<unsigned> offsets, targets;
+    createGraph(6, edges, offsets, targets);
+
+    Opm::StronglyConnectedComponents scc;
+    scc.compute(offsets, targets);
+    checkOrder(scc, offsets, targets);
+
+    if (scc.numComponents() != 5)
+        throw std::logic_error("Wrong number of components");
+    if (scc.component(2) != scc.component(3) || scc.componentSize(scc.component(2)) != 2)
+        throw std::logic_error("Vertices 2 and 3 must form a component");
+    if (scc.numLevels() != 4)
+        throw std::logic_error("Wrong number of levels");
+
+    const std::vector<unsigned> expectedLevels{0, 1, 2, 2, 3, 0};
+    for (unsigned v = 0; v < expectedLevels.size(); ++v)
+        if (scc.level(scc.component(v)) != expectedLevels[v])
+            throw std::logic_error("Wrong level of vertex " + std::to_string(v));
+}
+
+void testLargeGraph()
+{
+    // a long chain with a cycle in its middle and a periodic grid with
+    // one-sided dependencies. the former makes sure that the depth-first
+    // search does not use the call stack.
+    const unsigned n = 1000000;
+    Edges edges;
+    for (unsigned v = 1; v < n; ++v)
+        edges.emplace_back(v, v - 1);
+    edges.emplace_back(n/2, n/2 + 10);
+
+    std::vector<unsigned> offsets, targets;
+    createGraph(n, edges, offsets, targets);
+
+    Opm::StronglyConnectedComponents scc;
+    scc.compute(offsets, targets);
+    checkOrder(scc, offsets, targets);
+    if (scc.numComponents() != n - 10 || scc.componentSize(scc.component(n/2)) != 11)
+        throw std::logic_error("Wrong components of the chain");
+
+    const unsigned nx = 300;
+    edges.clear();
+    for (unsigned j = 0; j < nx; ++j) {
+        for (unsigned i = 0; i < nx; ++i) {
+            const unsigned v = j*nx + i;
+            edges.emplace_back(v, j*nx + (i + nx - 1) % nx);
+            if (j > 0)
+                edges.emplace_back(v, v - nx);
+        }
+    }
+    createGraph(nx*nx, edges, offsets, targets);
+    scc.compute(offsets, targets);
+    checkOrder(scc, offsets, targets);
+    if (scc.numComponents() != nx || scc.numLevels() != nx)
+        throw std::logic_error("Wrong components of the grid");
+}
+
+int main()
+{
+    testSmallGraph();
+    testLargeGraph();
+
+    std::cout << "Strongly connected components: all tests passed\n";
+    return 0;
+}